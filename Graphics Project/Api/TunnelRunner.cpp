@@ -0,0 +1,164 @@
+#include "TunnelRunner.h"
+
+// STL Includes
+#include <new>
+#include <vector>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/GameBatch.h"
+
+
+// The interface constants are part of the binary interface, so they must follow the game's ones
+static_assert(TR_LANES_X == LANES_X_COUNT && TR_LANES_Y == LANES_Y_COUNT && TR_LANES_Z == LANES_Z_COUNT, "Lanes mismatch");
+static_assert(TR_OBSERVATION_SIZE == OBSERVATION_SIZE, "Observation size mismatch");
+static_assert(TR_ITEM_BLOCK == BLOCK && TR_ITEM_COIN == COIN && TR_ITEM_GEM_REVERSED_MODE == GEM_REVERSED_MODE, "Items mismatch");
+static_assert(TR_ACTION_LEFT == INPUT_LEFT && TR_ACTION_RIGHT == INPUT_RIGHT && TR_ACTION_JUMP == INPUT_JUMP, "Actions mismatch");
+
+// Action bits a caller can press, the game's other input keys (pause, quit, replay) are never forwarded
+const unsigned int TR_ACTIONS_MASK = TR_ACTION_LEFT | TR_ACTION_RIGHT | TR_ACTION_JUMP;
+
+
+/*
+	Batch of games behind the interface handle
+*/
+struct tr_batch {
+	Level GameLevel;
+	GameBatch* Games;
+	vector<unsigned int> Actions;	// Masked actions of a batch step
+};
+
+
+/* Returns the version of the interface implemented by the library */
+int tr_get_version(void) {
+	return TR_VERSION;
+}
+
+/* Creates a batch of games playing the given level file, returns null on failure */
+tr_batch* tr_create(const char* level_path, int games_count, unsigned int seed, int threads_count) {
+	if (level_path == NULL || games_count <= 0)
+		return NULL;
+
+	tr_batch* batch = new (nothrow) tr_batch();
+	if (batch == NULL)
+		return NULL;
+
+	batch->Games = NULL;
+
+	// No exception may cross the C interface, a failed allocation fails the creation
+	try {
+		if (!batch->GameLevel.Load(level_path)) {
+			delete batch;
+			return NULL;
+		}
+
+		batch->Actions.resize(games_count);
+		batch->Games = new GameBatch(&batch->GameLevel, games_count, seed, threads_count);
+	}
+	catch (...) {
+		std::cout << "GAME::ERROR: Could not create a batch of " << games_count << " games" << std::endl;
+		delete batch->Games;
+		delete batch;
+		return NULL;
+	}
+
+	return batch;
+}
+
+/* Destroys a batch of games */
+void tr_destroy(tr_batch* batch) {
+	if (batch == NULL)
+		return;
+
+	delete batch->Games;
+	delete batch;
+}
+
+/* Returns the number of games of a batch */
+int tr_get_games_count(const tr_batch* batch) {
+	return batch->Games->GetGamesCount();
+}
+
+/* Writes the lanes counts of the level of a batch into the given pointers */
+void tr_get_lanes(const tr_batch* batch, int* lanes_x, int* lanes_y, int* lanes_z) {
+	const GridDims& dims = batch->Games->GetDims();
+	*lanes_x = dims.X;
+	*lanes_y = dims.Y;
+	*lanes_z = dims.Z;
+}
+
+/* Returns the number of bytes of an observation, the product of the lanes counts */
+int tr_get_observation_size(const tr_batch* batch) {
+	return batch->Games->GetObservationSize();
+}
+
+/* Restarts the random sequences, game i from seed + i, and resets all of the games */
+void tr_seed(tr_batch* batch, unsigned int seed) {
+	for (int i = 0; i < batch->Games->GetGamesCount(); ++i) {
+		tr_seed_game(batch, i, seed + i);
+	}
+}
+
+/* Restarts the random sequence of a game from the given seed and resets it */
+void tr_seed_game(tr_batch* batch, int game, unsigned int seed) {
+	batch->Games->Seed(game, seed);
+	batch->Games->ClearOutputs(game);
+}
+
+/* Resets all of the games */
+void tr_reset(tr_batch* batch) {
+	for (int i = 0; i < batch->Games->GetGamesCount(); ++i) {
+		tr_reset_game(batch, i);
+	}
+}
+
+/* Resets a game */
+void tr_reset_game(tr_batch* batch, int game) {
+	batch->Games->Reset(game);
+	batch->Games->ClearOutputs(game);
+}
+
+/* Makes the steps write into caller owned buffers, null buffers go back to the batch's own buffers */
+void tr_set_buffers(tr_batch* batch, unsigned char* observations, float* rewards, unsigned char* dones) {
+	batch->Games->SetBuffers(observations, rewards, dones);
+}
+
+/* Returns the observations buffer */
+const unsigned char* tr_get_observations(const tr_batch* batch) {
+	return batch->Games->GetObservations();
+}
+
+/* Returns the rewards buffer */
+const float* tr_get_rewards(const tr_batch* batch) {
+	return batch->Games->GetRewards();
+}
+
+/* Returns the dones buffer */
+const unsigned char* tr_get_dones(const tr_batch* batch) {
+	return batch->Games->GetDones();
+}
+
+/* Advances a single game by one tick with the given action bits */
+void tr_step(tr_batch* batch, int game, unsigned int action) {
+	batch->Games->Step(game, action & TR_ACTIONS_MASK, SIMULATION_TICK_TIME);
+}
+
+/* Advances all of the games by one tick, game i with the action bits actions[i] */
+void tr_step_batch(tr_batch* batch, const unsigned int* actions) {
+	for (int i = 0; i < batch->Games->GetGamesCount(); ++i) {
+		batch->Actions[i] = actions[i] & TR_ACTIONS_MASK;
+	}
+
+	batch->Games->Step(&batch->Actions[0], SIMULATION_TICK_TIME);
+}
+
+/* Returns the current score of a game */
+int tr_get_score(const tr_batch* batch, int game) {
+	return batch->Games->GetScore(game);
+}
+
+/* Returns a hash of the whole state of a game */
+unsigned long long tr_get_state_hash(const tr_batch* batch, int game) {
+	return batch->Games->GetStateHash(game);
+}
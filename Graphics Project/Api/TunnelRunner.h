@@ -0,0 +1,115 @@
+#pragma once
+
+/*
+	C interface of the game core, built as the tunnelrunner shared library.
+	It lets trainers and analysis tools written in any language step batches of games
+	without linking any C++ class. Only plain C types cross the library boundary,
+	and the interface version is bumped whenever a call changes.
+
+	A handle holds a batch of games playing one level. Every step writes, for each game,
+	the items of the lanes ahead of the player (tr_get_observation_size bytes ordered [z][y][x]),
+	the score gained during the step, and whether the game was lost. Lost games restart right away.
+	The outputs are written either into the handle's own buffers or into buffers owned by the caller,
+	and stepping never allocates memory.
+*/
+
+#if defined(_WIN32)
+#define TR_API __declspec(dllexport)
+#else
+#define TR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interface version
+#define TR_VERSION 2
+
+// Lanes of an observation of the default tunnel, the levels may declare other lanes counts
+#define TR_LANES_X 3
+#define TR_LANES_Y 4
+#define TR_LANES_Z 20
+#define TR_OBSERVATION_SIZE (TR_LANES_X * TR_LANES_Y * TR_LANES_Z)
+
+// Items of an observation
+#define TR_ITEM_EMPTY 0
+#define TR_ITEM_BLOCK 1
+#define TR_ITEM_COIN 2
+#define TR_ITEM_GEM_DOUBLE_SCORE 3
+#define TR_ITEM_GEM_SPEED 4
+#define TR_ITEM_GEM_EXTRA_SCORE 5
+#define TR_ITEM_GEM_REVERSED_MODE 6
+
+// Action bits, the other bits are ignored
+#define TR_ACTION_LEFT 1
+#define TR_ACTION_RIGHT 2
+#define TR_ACTION_JUMP 4
+
+/* Handle of a batch of games */
+typedef struct tr_batch tr_batch;
+
+/* Returns the version of the interface implemented by the library */
+TR_API int tr_get_version(void);
+
+/*
+	Creates a batch of games playing the given level file, game i is seeded with seed + i.
+	Stepped by the given number of threads, 0 uses all of the cores. Returns null on failure
+*/
+TR_API tr_batch* tr_create(const char* level_path, int games_count, unsigned int seed, int threads_count);
+
+/* Destroys a batch of games */
+TR_API void tr_destroy(tr_batch* batch);
+
+/* Returns the number of games of a batch */
+TR_API int tr_get_games_count(const tr_batch* batch);
+
+/* Writes the lanes counts of the level of a batch into the given pointers */
+TR_API void tr_get_lanes(const tr_batch* batch, int* lanes_x, int* lanes_y, int* lanes_z);
+
+/* Returns the number of bytes of an observation, the product of the lanes counts */
+TR_API int tr_get_observation_size(const tr_batch* batch);
+
+/* Restarts the random sequences, game i from seed + i, and resets all of the games */
+TR_API void tr_seed(tr_batch* batch, unsigned int seed);
+
+/* Restarts the random sequence of a game from the given seed and resets it */
+TR_API void tr_seed_game(tr_batch* batch, int game, unsigned int seed);
+
+/* Resets all of the games */
+TR_API void tr_reset(tr_batch* batch);
+
+/* Resets a game */
+TR_API void tr_reset_game(tr_batch* batch, int game);
+
+/*
+	Makes the steps write into caller owned buffers of games_count * tr_get_observation_size() observations,
+	games_count rewards and games_count dones. The buffers must stay valid until they are replaced or the batch is destroyed.
+	Null buffers go back to the batch's own buffers. The current observations are written into the new buffers
+*/
+TR_API void tr_set_buffers(tr_batch* batch, unsigned char* observations, float* rewards, unsigned char* dones);
+
+/* Returns the observations buffer */
+TR_API const unsigned char* tr_get_observations(const tr_batch* batch);
+
+/* Returns the rewards buffer */
+TR_API const float* tr_get_rewards(const tr_batch* batch);
+
+/* Returns the dones buffer */
+TR_API const unsigned char* tr_get_dones(const tr_batch* batch);
+
+/* Advances a single game by one tick with the given action bits */
+TR_API void tr_step(tr_batch* batch, int game, unsigned int action);
+
+/* Advances all of the games by one tick, game i with the action bits actions[i] */
+TR_API void tr_step_batch(tr_batch* batch, const unsigned int* actions);
+
+/* Returns the current score of a game */
+TR_API int tr_get_score(const tr_batch* batch, int game);
+
+/* Returns a hash of the whole state of a game */
+TR_API unsigned long long tr_get_state_hash(const tr_batch* batch, int game);
+
+#ifdef __cplusplus
+}
+#endif
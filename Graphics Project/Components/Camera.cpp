@@ -1,9 +1,8 @@
 #include "Camera.h"
 
 /* Constructs the camera and setup its vectors */
-Camera::Camera(glm::vec3 position, double aspect) {
+Camera::Camera(glm::vec3 position, double aspect) : mKinematics(position.x, position.y, position.z) {
 	// Camera Attributes
-	this->mPosition = position;
 	this->mFront = FRONT;
 	this->mWorldUp = WORLD_UP;
 
@@ -11,18 +10,6 @@ Camera::Camera(glm::vec3 position, double aspect) {
 	this->mHorAngle = YAW;
 	this->mVerAngle = PITCH;
 
-	// Animation variables
-	// Horizontal Move
-	this->mIsMovingHorizontalStep = false;
-	this->mIsMovingForwardStep = false;
-	this->mMoveSpeed = MOVE_SPEED_INIT;
-	this->mMoveAcceleration = MOVE_ACCELERATION_INIT;
-	// Jump
-	this->mIsJumping = false;
-	this->mJumpVelocity = JUMP_SPEED;
-	this->mJumpAcceleration = JUMP_ACCELERATION;
-	this->mGroundPosition = position.y;
-	this->mJumpStartHeight = position.y;
 	// Look around
 	this->mMouseSensitivity = MOUSE_SENSITIVTY;
 
@@ -48,12 +35,12 @@ Camera::~Camera() {
 
 /* Sets the position of the camera in world space */
 void Camera::SetPosition(glm::vec3 position) {
-	this->mPosition = position;
+	this->mKinematics.SetPosition(position.x, position.y, position.z);
 }
 
 /* Returns camera position in world's coordinates */
 glm::vec3 Camera::GetPosition() const {
-	return this->mPosition;
+	return glm::vec3(this->mKinematics.GetPositionX(), this->mKinematics.GetPositionY(), this->mKinematics.GetPositionZ());
 }
 
 /* Returns camera direction in world's coordinates */
@@ -63,63 +50,54 @@ glm::vec3 Camera::GetFront() const {
 
 /* Returns the camera movement speed */
 double Camera::GetCameraSpeed() {
-	return this->mMoveSpeed;
+	return this->mKinematics.GetMoveSpeed();
 }
 
 
 /* Sets the position of the ground/gravity, needed to apply falling effect */
 void Camera::SetGravityPosition(double ypos) {
-	if (this->mGroundPosition > ypos && !this->mIsJumping) {
-		this->mJumpVelocity = 0.0f;
-		this->mIsJumping = true;
-		this->mJumpStartHeight = this->mPosition.y;
-	}
-
-	this->mGroundPosition = ypos;
+	this->mKinematics.SetGravityPosition(ypos);
 }
 
 /* Sets the movement speed of the camera */
 void Camera::SetMoveSpeed(double speed) {
-	this->mMoveSpeed = speed;
+	this->mKinematics.SetMoveSpeed(speed);
 }
 
 /* Sets the Camera movement acceleration with a certain value */
 void Camera::SetMoveAcceleration(double acceleration) {
-	this->mMoveAcceleration = acceleration;
+	this->mKinematics.SetMoveAcceleration(acceleration);
 }
 
 /* Increases the camera speed by the given amount */
 void Camera::AccelerateSpeed() {
-	this->mMoveSpeed += this->mMoveAcceleration;
-
-	if (this->mMoveSpeed > MOVE_SPEED_MAX) {
-		this->mMoveSpeed = MOVE_SPEED_MAX;
-	}
+	this->mKinematics.AccelerateSpeed();
 }
 
 /* Returns whether the camera is moving left */
 bool Camera::IsMovingLeft() const {
-	return this->mIsMovingHorizontalStep && this->mMoveHorizontalDirection < 0.0f;
+	return this->mKinematics.IsMovingLeft();
 }
 
 /* Returns whether the camera is moving right */
 bool Camera::IsMovingRight() const {
-	return this->mIsMovingHorizontalStep && this->mMoveHorizontalDirection > 0.0f;
+	return this->mKinematics.IsMovingRight();
 }
 
 /* Returns whether the camera is jumping */
 bool Camera::IsJumping() const {
-	return this->mIsJumping && this->mJumpVelocity > 0.0f;
+	return this->mKinematics.IsJumping();
 }
 
 /* Returns height from gravity */
 double Camera::JumpingOffset() const {
-	return this->mPosition.y - this->mJumpStartHeight;
+	return this->mKinematics.JumpingOffset();
 }
 
 /* Returns the view matrix calculated using Eular Angles and the LookAt Matrix */
 glm::mat4 Camera::GetViewMatrix() const {
-	return glm::lookAt(this->mPosition, this->mPosition + this->mFront, this->mUp);
+	glm::vec3 position = this->GetPosition();
+	return glm::lookAt(position, position + this->mFront, this->mUp);
 }
 
 /* Returns the projection matrix */
@@ -127,117 +105,49 @@ glm::mat4 Camera::GetProjectionMatrix() const {
 	return glm::perspective(this->mFOV, this->mAspectRatio, this->mNearPlane, this->mFarPlane);
 }
 
+/* Sets the distance of the far clipping plane */
+void Camera::SetFarPlane(double farPlane) {
+	this->mFarPlane = farPlane;
+}
+
 /* Applies camera view by sending the related matrices to the shader */
 void Camera::ApplyEffects(const Shader& shader) {
+	glm::vec3 position = this->GetPosition();
 	glUniformMatrix4fv(shader.ViewMatrixLoc, 1, GL_FALSE, glm::value_ptr(this->GetViewMatrix()));
 	glUniformMatrix4fv(shader.ProjectionMatrixLoc, 1, GL_FALSE, glm::value_ptr(this->GetProjectionMatrix()));
-	glUniform3f(shader.CameraPositionLoc, this->mPosition.x, this->mPosition.y, this->mPosition.z);
+	glUniform3f(shader.CameraPositionLoc, position.x, position.y, position.z);
 }
 
 /* Moves the camera a step in a certain direction */
 void Camera::MoveStep(CameraDirection type, double offset) {
-	switch (type)
-	{
-	case FORWARD:
-		if (!this->mIsMovingForwardStep) {
-			this->mIsMovingForwardStep = true;
-			this->mMoveForwardDirection = -1.0;
-			this->mMoveForwardOffset = offset;
-			this->mMoveForwardDestination = this->mPosition.z - offset;
-		}
-		break;
-	case BACKWARD:
-		if (!this->mIsMovingForwardStep) {
-			this->mIsMovingForwardStep = true;
-			this->mMoveForwardDirection = 1.0;
-			this->mMoveForwardOffset = offset;
-			this->mMoveForwardDestination = this->mPosition.z + offset;
-		}
-		break;
-	case LEFT:
-		if (!this->mIsMovingHorizontalStep) {
-			this->mIsMovingHorizontalStep = true;
-			this->mMoveHorizontalDirection = -1.0;
-			this->mMoveHorizontalOffset = offset;
-			this->mMoveHorizontalDestination = this->mPosition.x - offset;
-		}
-		break;
-	case RIGHT:
-		if (!this->mIsMovingHorizontalStep) {
-			this->mIsMovingHorizontalStep = true;
-			this->mMoveHorizontalDirection = 1.0;
-			this->mMoveHorizontalOffset = offset;
-			this->mMoveHorizontalDestination = this->mPosition.x + offset;
-		}
-		break;
-	}
+	this->mKinematics.MoveStep(type, offset);
 }
 
 /* Starts jumping animation */
 void Camera::Jump(double offset) {
-	// TODO: Force the camera to jump with a certain offset
-	if (!this->mIsJumping) {
-		this->mIsJumping = true;
-		this->mJumpVelocity = std::sqrt(2 * JUMP_ACCELERATION * offset);
-		this->mJumpStartHeight = this->mPosition.y;
-	}
+	this->mKinematics.Jump(offset);
 }
 
 /* Updates the camera to apply the animation effects */
 void Camera::Update(double deltaTime) {
-	// Horizontal move effect
-	if (this->mIsMovingHorizontalStep) {
-		float velocity =  this->mMoveSpeed * deltaTime;
-
-		this->mPosition.x += velocity * this->mMoveHorizontalDirection;
-		this->mMoveHorizontalOffset -= velocity;
-
-		if (this->mMoveHorizontalOffset <= 0.0f) {
-			this->mPosition.x = this->mMoveHorizontalDestination;
-			this->mIsMovingHorizontalStep = false;
-		}
-	}
-
-	// Forward move effect
-	if (this->mIsMovingForwardStep) {
-		float velocity = this->mMoveSpeed * deltaTime;
-
-		this->mPosition.z += velocity * this->mMoveForwardDirection;
-		this->mMoveForwardOffset -= velocity;
-
-		if (this->mMoveForwardOffset <= 0.0f) {
-			this->mPosition.z = this->mMoveForwardDestination;
-			this->mIsMovingForwardStep = false;
-		}
-	}
-
-	// Jump and falling effects
-	if (this->mIsJumping) {
-		float velocity = this->mJumpVelocity * deltaTime;
-
-		this->mJumpVelocity -= this->mJumpAcceleration * deltaTime;
-
-		this->mPosition.y += velocity;
-
-		if (this->mPosition.y <= this->mGroundPosition) {
-			this->mPosition.y = this->mGroundPosition;
-			this->mIsJumping = false;
-		}
-	}
+	this->mKinematics.Update(deltaTime);
 }
 
 /* Moves the camera in a certain direction */
 void Camera::Move(CameraDirection direction, double deltaTime) {
-	float velocity = this->mMoveSpeed * deltaTime;
+	float velocity = this->mKinematics.GetMoveSpeed() * deltaTime;
+	glm::vec3 position = this->GetPosition();
 
 	if (direction == FORWARD)
-		this->mPosition += this->mFront * velocity;
+		position += this->mFront * velocity;
 	if (direction == BACKWARD)
-		this->mPosition -= this->mFront * velocity;
+		position -= this->mFront * velocity;
 	if (direction == RIGHT)
-		this->mPosition += this->mRight * velocity;
+		position += this->mRight * velocity;
 	if (direction == LEFT)
-		this->mPosition -= this->mRight * velocity;
+		position -= this->mRight * velocity;
+
+	this->SetPosition(position);
 }
 
 /* Changes camera direction by certain offset in X and Y */
@@ -289,9 +199,7 @@ void Camera::Zoom(double offset) {
 
 /* Stop any running animation */
 void Camera::StopAnimation() {
-	this->mIsJumping = false;
-	this->mIsMovingForwardStep = false;
-	this->mIsMovingHorizontalStep = false;
+	this->mKinematics.StopAnimation();
 }
 
 /* Calculates the front vector from the camera's (updated) Eular Angles */
@@ -11,18 +11,7 @@
 
 // Other Include
 #include "Shader.h"
-
-
-/*
-	Defines several possible options for camera movement.
-	Used as abstraction to stay away from window-system specific input methods
-*/
-enum CameraDirection {
-	FORWARD,
-	BACKWARD,
-	LEFT,
-	RIGHT,
-};
+#include "CameraKinematics.h"
 
 
 // Default camera values
@@ -36,12 +25,7 @@ const double MAX_YAW = YAW + 45.0f;
 const double MIN_YAW = YAW - 45.0f;
 const double MAX_PITCH = 45.0f;
 const double MIN_PITCH = -MAX_PITCH;
-// Animation constants
-const double MOVE_SPEED_INIT = 4.0f;
-const double MOVE_SPEED_MAX = 15.0f;
-const double MOVE_ACCELERATION_INIT = 0.01f;
-const double JUMP_SPEED = 4.0f;
-const double JUMP_ACCELERATION = 12.0f;			// If you want to jump with a certain height use this EQN => a = (MOVE_SPEED)^2 / (2 * Height)
+// Look around constants
 const double MOUSE_SENSITIVTY = 5.0f;
 // Camera options
 const double MAX_FOV = 45.0f;
@@ -58,7 +42,6 @@ class Camera
 {
 private:
 	// Camera attributes
-	glm::vec3 mPosition;
 	glm::vec3 mFront;
 	glm::vec3 mUp;
 	glm::vec3 mRight;
@@ -68,24 +51,8 @@ private:
 	double mHorAngle;	// Rotation angle around y-axis
 	double mVerAngle;	// Rotation angle around x-axis
 
-	// Animation variables
-	// Move
-	bool mIsMovingHorizontalStep;
-	bool mIsMovingForwardStep;
-	double mMoveSpeed;
-	double mMoveAcceleration;
-	double mMoveHorizontalDirection;
-	double mMoveForwardDirection;
-	double mMoveHorizontalOffset;
-	double mMoveForwardOffset;
-	double mMoveHorizontalDestination;
-	double mMoveForwardDestination;
-	// Jump
-	bool mIsJumping;
-	double mJumpVelocity;
-	double mJumpAcceleration;
-	double mGroundPosition;
-	double mJumpStartHeight;
+	// Position and animation variables
+	CameraKinematics mKinematics;
 	// Look around
 	double mMouseSensitivity;
 
@@ -149,6 +116,9 @@ public:
 	/* Returns the projection matrix */
 	glm::mat4 GetProjectionMatrix() const;
 
+	/* Sets the distance of the far clipping plane */
+	void SetFarPlane(double farPlane);
+
 	/* Applies camera view by sending the related matrices to the shader */
 	void ApplyEffects(const Shader& shader);
 
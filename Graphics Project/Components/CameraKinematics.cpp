@@ -0,0 +1,233 @@
+#include "CameraKinematics.h"
+
+/* Constructs the kinematics at the given position */
+CameraKinematics::CameraKinematics(double x, double y, double z) {
+	// Position
+	this->mPositionX = x;
+	this->mPositionY = y;
+	this->mPositionZ = z;
+
+	// Move
+	this->mIsMovingHorizontalStep = false;
+	this->mIsMovingForwardStep = false;
+	this->mMoveSpeed = MOVE_SPEED_INIT;
+	this->mMoveAcceleration = MOVE_ACCELERATION_INIT;
+	this->mMoveHorizontalDirection = 0.0f;
+	this->mMoveForwardDirection = 0.0f;
+	this->mMoveHorizontalOffset = 0.0f;
+	this->mMoveForwardOffset = 0.0f;
+	this->mMoveHorizontalDestination = 0.0f;
+	this->mMoveForwardDestination = 0.0f;
+	// Jump
+	this->mIsJumping = false;
+	this->mJumpVelocity = JUMP_SPEED;
+	this->mJumpAcceleration = JUMP_ACCELERATION;
+	this->mGroundPosition = y;
+	this->mJumpStartHeight = y;
+}
+
+/* Sets the position in world space */
+void CameraKinematics::SetPosition(double x, double y, double z) {
+	this->mPositionX = x;
+	this->mPositionY = y;
+	this->mPositionZ = z;
+}
+
+/* Returns the position on the X axis */
+double CameraKinematics::GetPositionX() const {
+	return this->mPositionX;
+}
+
+/* Returns the position on the Y axis */
+double CameraKinematics::GetPositionY() const {
+	return this->mPositionY;
+}
+
+/* Returns the position on the Z axis */
+double CameraKinematics::GetPositionZ() const {
+	return this->mPositionZ;
+}
+
+/* Returns the movement speed */
+double CameraKinematics::GetMoveSpeed() const {
+	return this->mMoveSpeed;
+}
+
+/* Moves the position and the running animations by the given offset, used to move the world origin */
+void CameraKinematics::Translate(double x, double y, double z) {
+	this->mPositionX += x;
+	this->mPositionY += y;
+	this->mPositionZ += z;
+
+	this->mMoveHorizontalDestination += x;
+	this->mMoveForwardDestination += z;
+	this->mGroundPosition += y;
+	this->mJumpStartHeight += y;
+}
+
+/* Sets the position of the ground/gravity, needed to apply falling effect */
+void CameraKinematics::SetGravityPosition(double ypos) {
+	if (this->mGroundPosition > ypos && !this->mIsJumping) {
+		this->mJumpVelocity = 0.0f;
+		this->mIsJumping = true;
+		this->mJumpStartHeight = this->mPositionY;
+	}
+
+	this->mGroundPosition = ypos;
+}
+
+/* Sets the movement speed with a certain value */
+void CameraKinematics::SetMoveSpeed(double speed) {
+	this->mMoveSpeed = speed;
+}
+
+/* Sets the movement acceleration with a certain value */
+void CameraKinematics::SetMoveAcceleration(double acceleration) {
+	this->mMoveAcceleration = acceleration;
+}
+
+/* Increases the speed by the movement acceleration */
+void CameraKinematics::AccelerateSpeed() {
+	this->mMoveSpeed += this->mMoveAcceleration;
+
+	if (this->mMoveSpeed > MOVE_SPEED_MAX) {
+		this->mMoveSpeed = MOVE_SPEED_MAX;
+	}
+}
+
+/* Returns whether moving left */
+bool CameraKinematics::IsMovingLeft() const {
+	return this->mIsMovingHorizontalStep && this->mMoveHorizontalDirection < 0.0f;
+}
+
+/* Returns whether moving right */
+bool CameraKinematics::IsMovingRight() const {
+	return this->mIsMovingHorizontalStep && this->mMoveHorizontalDirection > 0.0f;
+}
+
+/* Returns whether jumping */
+bool CameraKinematics::IsJumping() const {
+	return this->mIsJumping && this->mJumpVelocity > 0.0f;
+}
+
+/* Returns height from jumping start position */
+double CameraKinematics::JumpingOffset() const {
+	return this->mPositionY - this->mJumpStartHeight;
+}
+
+/* Moves a step in a certain direction */
+void CameraKinematics::MoveStep(CameraDirection type, double offset) {
+	switch (type)
+	{
+	case FORWARD:
+		if (!this->mIsMovingForwardStep) {
+			this->mIsMovingForwardStep = true;
+			this->mMoveForwardDirection = -1.0;
+			this->mMoveForwardOffset = offset;
+			this->mMoveForwardDestination = this->mPositionZ - offset;
+		}
+		break;
+	case BACKWARD:
+		if (!this->mIsMovingForwardStep) {
+			this->mIsMovingForwardStep = true;
+			this->mMoveForwardDirection = 1.0;
+			this->mMoveForwardOffset = offset;
+			this->mMoveForwardDestination = this->mPositionZ + offset;
+		}
+		break;
+	case LEFT:
+		if (!this->mIsMovingHorizontalStep) {
+			this->mIsMovingHorizontalStep = true;
+			this->mMoveHorizontalDirection = -1.0;
+			this->mMoveHorizontalOffset = offset;
+			this->mMoveHorizontalDestination = this->mPositionX - offset;
+		}
+		break;
+	case RIGHT:
+		if (!this->mIsMovingHorizontalStep) {
+			this->mIsMovingHorizontalStep = true;
+			this->mMoveHorizontalDirection = 1.0;
+			this->mMoveHorizontalOffset = offset;
+			this->mMoveHorizontalDestination = this->mPositionX + offset;
+		}
+		break;
+	}
+}
+
+/* Starts jumping animation */
+void CameraKinematics::Jump(double offset) {
+	// TODO: Force the camera to jump with a certain offset
+	if (!this->mIsJumping) {
+		this->mIsJumping = true;
+		this->mJumpVelocity = std::sqrt(2 * JUMP_ACCELERATION * offset);
+		this->mJumpStartHeight = this->mPositionY;
+	}
+}
+
+/* Returns the time until the running forward or sideways step reaches its destination, at most the given time */
+double CameraKinematics::GetStepTime(double maxTime) const {
+	double time = maxTime;
+
+	if (this->mMoveSpeed <= 0.0f)
+		return time;
+
+	if (this->mIsMovingHorizontalStep)
+		time = fmin(time, this->mMoveHorizontalOffset / this->mMoveSpeed);
+
+	if (this->mIsMovingForwardStep)
+		time = fmin(time, this->mMoveForwardOffset / this->mMoveSpeed);
+
+	return time;
+}
+
+/* Updates the position to apply the animation effects */
+void CameraKinematics::Update(double deltaTime) {
+	// Horizontal move effect
+	if (this->mIsMovingHorizontalStep) {
+		double velocity = this->mMoveSpeed * deltaTime;
+
+		this->mPositionX += velocity * this->mMoveHorizontalDirection;
+		this->mMoveHorizontalOffset -= velocity;
+
+		// A remaining offset too small to take any time at this speed would never be covered, the step is over
+		if (this->mMoveHorizontalOffset <= 0.0f || velocity <= 0.0f) {
+			this->mPositionX = this->mMoveHorizontalDestination;
+			this->mIsMovingHorizontalStep = false;
+		}
+	}
+
+	// Forward move effect
+	if (this->mIsMovingForwardStep) {
+		double velocity = this->mMoveSpeed * deltaTime;
+
+		this->mPositionZ += velocity * this->mMoveForwardDirection;
+		this->mMoveForwardOffset -= velocity;
+
+		// Same as the horizontal step
+		if (this->mMoveForwardOffset <= 0.0f || velocity <= 0.0f) {
+			this->mPositionZ = this->mMoveForwardDestination;
+			this->mIsMovingForwardStep = false;
+		}
+	}
+
+	// Jump and falling effects
+	if (this->mIsJumping) {
+		double velocity = this->mJumpVelocity * deltaTime;
+
+		this->mJumpVelocity -= this->mJumpAcceleration * deltaTime;
+
+		this->mPositionY += velocity;
+
+		if (this->mPositionY <= this->mGroundPosition) {
+			this->mPositionY = this->mGroundPosition;
+			this->mIsJumping = false;
+		}
+	}
+}
+
+/* Stop any running animation */
+void CameraKinematics::StopAnimation() {
+	this->mIsJumping = false;
+	this->mIsMovingForwardStep = false;
+	this->mIsMovingHorizontalStep = false;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+// STL Includes
+#include <cmath>
+
+
+// Animation constants
+const double MOVE_SPEED_INIT = 4.0f;
+const double MOVE_SPEED_MAX = 15.0f;
+const double MOVE_ACCELERATION_INIT = 0.01f;
+const double JUMP_SPEED = 4.0f;
+const double JUMP_ACCELERATION = 12.0f;			// If you want to jump with a certain height use this EQN => a = (MOVE_SPEED)^2 / (2 * Height)
+
+
+/*
+	Defines several possible options for camera movement.
+	Used as abstraction to stay away from window-system specific input methods
+*/
+enum CameraDirection {
+	FORWARD,
+	BACKWARD,
+	LEFT,
+	RIGHT,
+};
+
+
+/*
+	Class holding the camera position and its step, jump and falling animations.
+	It has no dependency on OpenGL so it can be simulated without a window
+*/
+class CameraKinematics
+{
+private:
+	// Position
+	double mPositionX;
+	double mPositionY;
+	double mPositionZ;
+
+	// Move
+	bool mIsMovingHorizontalStep;
+	bool mIsMovingForwardStep;
+	double mMoveSpeed;
+	double mMoveAcceleration;
+	double mMoveHorizontalDirection;
+	double mMoveForwardDirection;
+	double mMoveHorizontalOffset;
+	double mMoveForwardOffset;
+	double mMoveHorizontalDestination;
+	double mMoveForwardDestination;
+	// Jump
+	bool mIsJumping;
+	double mJumpVelocity;
+	double mJumpAcceleration;
+	double mGroundPosition;
+	double mJumpStartHeight;
+
+public:
+	/* Constructs the kinematics at the given position */
+	CameraKinematics(double x = 0.0f, double y = 0.0f, double z = 0.0f);
+
+	/* Sets the position in world space */
+	void SetPosition(double x, double y, double z);
+
+	/* Returns the position on the X axis */
+	double GetPositionX() const;
+
+	/* Returns the position on the Y axis */
+	double GetPositionY() const;
+
+	/* Returns the position on the Z axis */
+	double GetPositionZ() const;
+
+	/* Returns the movement speed */
+	double GetMoveSpeed() const;
+
+	/* Moves the position and the running animations by the given offset, used to move the world origin */
+	void Translate(double x, double y, double z);
+
+	/* Sets the position of the ground/gravity, needed to apply falling effect */
+	void SetGravityPosition(double ypos);
+
+	/* Sets the movement speed with a certain value */
+	void SetMoveSpeed(double speed);
+
+	/* Sets the movement acceleration with a certain value */
+	void SetMoveAcceleration(double acceleration);
+
+	/* Increases the speed by the movement acceleration */
+	void AccelerateSpeed();
+
+	/* Returns whether moving left */
+	bool IsMovingLeft() const;
+
+	/* Returns whether moving right */
+	bool IsMovingRight() const;
+
+	/* Returns whether jumping */
+	bool IsJumping() const;
+
+	/* Returns height from jumping start position */
+	double JumpingOffset() const;
+
+	/* Moves a step in a certain direction */
+	void MoveStep(CameraDirection type, double offset);
+
+	/* Starts jumping animation */
+	void Jump(double offset);
+
+	/* Returns the time until the running forward or sideways step reaches its destination, at most the given time */
+	double GetStepTime(double maxTime) const;
+
+	/* Updates the position to apply the animation effects */
+	void Update(double deltaTime);
+
+	/* Stop any running animation */
+	void StopAnimation();
+};
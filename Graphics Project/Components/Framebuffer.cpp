@@ -0,0 +1,130 @@
+#include "Framebuffer.h"
+
+/* Constructs a render target of the given size, multisampled if samples is above 1 */
+Framebuffer::Framebuffer(int width, int height, int samples) {
+	this->mWidth = width;
+	this->mHeight = height;
+	this->mSamples = max(samples, 1);
+	this->mColorTexture = 0;
+	this->mColorBuffer = 0;
+
+	glGenFramebuffers(1, &this->FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+
+	// Color
+	if (this->mSamples > 1) {
+		glGenRenderbuffers(1, &this->mColorBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, this->mColorBuffer);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->mSamples, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->mColorBuffer);
+	}
+	else {
+		glGenTextures(1, &this->mColorTexture);
+		glBindTexture(GL_TEXTURE_2D, this->mColorTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->mColorTexture, 0);
+	}
+
+	// Depth
+	glGenRenderbuffers(1, &this->mDepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->mDepthBuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->mSamples > 1 ? this->mSamples : 0, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->mDepthBuffer);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	if (!this->IsComplete())
+		std::cout << "GAME::ERROR: Incomplete " << width << "x" << height << " render target with " << this->mSamples << " samples" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_TARGETS, this->GetBytes());
+}
+
+/* Destructs the render target and free its buffers */
+Framebuffer::~Framebuffer() {
+	glDeleteFramebuffers(1, &this->FBO);
+	glDeleteTextures(1, &this->mColorTexture);
+	glDeleteRenderbuffers(1, &this->mColorBuffer);
+	glDeleteRenderbuffers(1, &this->mDepthBuffer);
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_TARGETS, -this->GetBytes());
+}
+
+/* Returns whether the target can be drawn into */
+bool Framebuffer::IsComplete() const {
+	GLint bound;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &bound);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, bound);
+	return complete;
+}
+
+/* Draws the next commands into the target, over its whole size */
+void Framebuffer::Bind() const {
+	this->Bind(this->mWidth, this->mHeight);
+}
+
+/* Draws the next commands into the lower left part of the target of the given size */
+void Framebuffer::Bind(int width, int height) const {
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+	glViewport(0, 0, width, height);
+	RenderStats::CountStateChanges(1);
+}
+
+/* Copies the color of the target into the given framebuffer (0 for the window), scaled to the given size */
+void Framebuffer::BlitTo(GLuint target, int width, int height) const {
+	this->BlitTo(target, width, height, this->mWidth, this->mHeight);
+}
+
+/* Copies the color of the lower left part of the target of the given source size into the given framebuffer (0 for the window),
+   scaled to the given size. A multisampled target is only resolved at the source size */
+void Framebuffer::BlitTo(GLuint target, int width, int height, int sourceWidth, int sourceHeight) const {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, this->FBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+
+	bool scaled = width != sourceWidth || height != sourceHeight;
+	glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target);
+	RenderStats::CountStateChanges(2);
+}
+
+/* Returns the framebuffer object of the target */
+GLuint Framebuffer::GetID() const {
+	return this->FBO;
+}
+
+/* Returns the color texture of a single sampled target, 0 if multisampled */
+GLuint Framebuffer::GetColorTexture() const {
+	return this->mColorTexture;
+}
+
+/* Returns the width of the target */
+int Framebuffer::GetWidth() const {
+	return this->mWidth;
+}
+
+/* Returns the height of the target */
+int Framebuffer::GetHeight() const {
+	return this->mHeight;
+}
+
+/* Returns the number of samples per pixel */
+int Framebuffer::GetSamples() const {
+	return this->mSamples;
+}
+
+/* Returns the GPU memory held by the target, in bytes */
+long long Framebuffer::GetBytes() const {
+	// 4 bytes of color and 4 of depth and stencil per sample
+	return (long long)this->mWidth * this->mHeight * this->mSamples * 8;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <algorithm>
+using namespace std;
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other Includes
+#include "../Utils/RenderStats.h"
+
+
+/*
+	Offscreen render target of a color and a depth buffer.
+	A single sampled target keeps its color in a texture so it can be sampled or read back,
+	a multisampled one is resolved by blitting it into another target or the window
+*/
+class Framebuffer
+{
+private:
+	GLuint FBO;
+	GLuint mColorTexture;			// Single sampled color
+	GLuint mColorBuffer;			// Multisampled color
+	GLuint mDepthBuffer;
+	int mWidth;
+	int mHeight;
+	int mSamples;
+
+public:
+	/* Constructs a render target of the given size, multisampled if samples is above 1 */
+	Framebuffer(int width, int height, int samples = 0);
+
+	/* Destructs the render target and free its buffers */
+	~Framebuffer();
+
+	/* Returns whether the target can be drawn into */
+	bool IsComplete() const;
+
+	/* Draws the next commands into the target, over its whole size */
+	void Bind() const;
+
+	/* Draws the next commands into the lower left part of the target of the given size */
+	void Bind(int width, int height) const;
+
+	/* Copies the color of the target into the given framebuffer (0 for the window), scaled to the given size */
+	void BlitTo(GLuint target, int width, int height) const;
+
+	/* Copies the color of the lower left part of the target of the given source size into the given framebuffer (0 for the window),
+	   scaled to the given size. A multisampled target is only resolved at the source size */
+	void BlitTo(GLuint target, int width, int height, int sourceWidth, int sourceHeight) const;
+
+	/* Returns the framebuffer object of the target */
+	GLuint GetID() const;
+
+	/* Returns the color texture of a single sampled target, 0 if multisampled */
+	GLuint GetColorTexture() const;
+
+	/* Returns the width of the target */
+	int GetWidth() const;
+
+	/* Returns the height of the target */
+	int GetHeight() const;
+
+	/* Returns the number of samples per pixel */
+	int GetSamples() const;
+
+private:
+	/* Returns the GPU memory held by the target, in bytes */
+	long long GetBytes() const;
+};
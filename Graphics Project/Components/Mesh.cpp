@@ -9,6 +9,7 @@ Mesh::Mesh(const vector<Vertex>& vertices, const vector<GLuint>& indices, const
 	this->VAO = -1;
 	this->VBO = -1;
 	this->EBO = -1;
+	this->mBufferBytes = 0;
 
 	this->SetupMesh(vertices, indices);
 }
@@ -19,10 +20,57 @@ Mesh::~Mesh() {
 	glDeleteBuffers(1, &this->VBO);
 	glDeleteBuffers(1, &this->EBO);
 	glDeleteVertexArrays(1, &this->VAO);
+	RenderStats::AddGpuMemory(GPU_MEMORY_MESHES, -this->mBufferBytes);
 }
 
 /* Render the mesh */
 void Mesh::Draw(const Shader& shader) {
+	this->BindMaterial(shader);
+
+	// Draw mesh
+	glBindVertexArray(this->VAO);
+	glDrawElements(GL_TRIANGLES, this->mIndicesCount, GL_UNSIGNED_INT, 0);
+	glBindVertexArray(0);
+
+	RenderStats::CountDraw(this->mIndicesCount / 3);
+	RenderStats::CountStateChanges(1);
+
+	this->UnbindMaterial();
+}
+
+/* Renders the given number of instances of the mesh, placed by the model matrices from the given one of the instance buffer */
+void Mesh::DrawInstanced(const Shader& shader, GLuint instanceBuffer, int first, int count) {
+	this->BindMaterial(shader);
+
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	// A matrix attribute is a column per location, advancing once per instance
+	for (int i = 0; i < 4; ++i) {
+		GLuint loc = VERTEX_INSTANCE_MATRIX_LOC + i;
+		glEnableVertexAttribArray(loc);
+		glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (GLvoid*)(first * sizeof(glm::mat4) + i * sizeof(glm::vec4)));
+		glVertexAttribDivisor(loc, 1);
+	}
+
+	glDrawElementsInstanced(GL_TRIANGLES, this->mIndicesCount, GL_UNSIGNED_INT, 0, count);
+
+	// Leave the instance attributes off for the single draws
+	for (int i = 0; i < 4; ++i) {
+		glDisableVertexAttribArray(VERTEX_INSTANCE_MATRIX_LOC + i);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	RenderStats::CountDraw((long long)(this->mIndicesCount / 3) * count);
+	RenderStats::CountStateChanges(2);
+
+	this->UnbindMaterial();
+}
+
+/* Sends the material properties to the shader and binds the textures */
+void Mesh::BindMaterial(const Shader& shader) {
 	// Send material properties to the related shader
 	glUniform1f(shader.MaterialShininessLoc, this->mMaterial.Shininess);
 	glUniform3f(shader.MaterialAmbientColorLoc, this->mMaterial.AmbientColor.x, this->mMaterial.AmbientColor.y, this->mMaterial.AmbientColor.z);
@@ -63,11 +111,11 @@ void Mesh::Draw(const Shader& shader) {
 		glBindTexture(GL_TEXTURE_2D, this->mTextures[i]->ID);
 	}
 
-	// Draw mesh
-	glBindVertexArray(this->VAO);
-	glDrawElements(GL_TRIANGLES, this->mIndicesCount, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
+	RenderStats::CountStateChanges(this->mTextures.size());
+}
 
+/* Unbinds the textures of the material */
+void Mesh::UnbindMaterial() {
 	// Always good practice to set everything back to defaults once configured.
 	for (unsigned int i = 0; i < this->mTextures.size(); ++i) {
 		glActiveTexture(GL_TEXTURE0 + i);
@@ -90,6 +138,9 @@ void Mesh::SetupMesh(const vector<Vertex>& vertices, const vector<GLuint>& indic
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+
+	this->mBufferBytes = vertices.size() * sizeof(Vertex) + indices.size() * sizeof(GLuint);
+	RenderStats::AddGpuMemory(GPU_MEMORY_MESHES, this->mBufferBytes);
 	
 	// Set the vertex attribute pointers
 	// Vertex Positions
@@ -16,6 +16,7 @@ using namespace std;
 // Other Includes
 #include "Shader.h"
 #include "Texture.h"
+#include "../Utils/RenderStats.h"
 
 
 /*
@@ -52,6 +53,7 @@ class Mesh {
 private:
 	GLuint VAO, VBO, EBO;
 	GLuint mIndicesCount;
+	long long mBufferBytes;
 	Material mMaterial;
 	vector<Texture*> mTextures;
 
@@ -65,7 +67,16 @@ public:
 	/* Render the mesh */
 	void Draw(const Shader& shader);
 
+	/* Renders the given number of instances of the mesh, placed by the model matrices from the given one of the instance buffer */
+	void DrawInstanced(const Shader& shader, GLuint instanceBuffer, int first, int count);
+
 private:
+	/* Sends the material properties to the shader and binds the textures */
+	void BindMaterial(const Shader& shader);
+
+	/* Unbinds the textures of the material */
+	void UnbindMaterial();
+
 	/* Initializes all the buffer objects and arrays from mesh's data */
 	void SetupMesh(const vector<Vertex>& vertices, const vector<GLuint>& indices);
 };
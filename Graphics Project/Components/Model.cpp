@@ -26,6 +26,8 @@ Model::~Model() {
 
 /* Draws the model, and thus all its meshes */
 void Model::Draw(const Shader& shader) {
+	PROFILE_SCOPE("Model::Draw");
+	glUniform1i(shader.InstancedLoc, GL_FALSE);
 	glUniformMatrix4fv(shader.ModelMatrixLoc, 1, GL_FALSE, glm::value_ptr(this->ModelMatrix));
 
 	for (unsigned int i = 0; i < this->mMeshes.size(); i++) {
@@ -33,6 +35,17 @@ void Model::Draw(const Shader& shader) {
 	}
 }
 
+/* Draws the given number of instances of the model, each placed by its model matrix from the given one of the instance buffer */
+void Model::DrawInstanced(const Shader& shader, GLuint instanceBuffer, int first, int count) {
+	PROFILE_SCOPE("Model::DrawInstanced");
+	glUniform1i(shader.InstancedLoc, GL_TRUE);
+	glUniformMatrix4fv(shader.LocalModelMatrixLoc, 1, GL_FALSE, glm::value_ptr(this->ModelMatrix));
+
+	for (unsigned int i = 0; i < this->mMeshes.size(); i++) {
+		this->mMeshes[i]->DrawInstanced(shader, instanceBuffer, first, count);
+	}
+}
+
 /* Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector */
 void Model::LoadModel(const string& path) {
 	// Read file via ASSIMP
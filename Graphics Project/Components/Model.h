@@ -20,6 +20,7 @@ using namespace std;
 
 // Other Includes
 #include "Mesh.h"
+#include "../Utils/Profiler.h"
 
 
 /*
@@ -48,6 +49,12 @@ public:
 	/* Draws the model, and thus all its meshes */
 	void Draw(const Shader& shader);
 
+	/*
+		Draws the given number of instances of the model, each placed by its model matrix from the given one of the instance buffer
+		and after the model's own matrix
+	*/
+	void DrawInstanced(const Shader& shader, GLuint instanceBuffer, int first, int count);
+
 private:
 	/* Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector */
 	void LoadModel(const string& path);
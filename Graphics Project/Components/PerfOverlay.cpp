@@ -0,0 +1,179 @@
+#include "PerfOverlay.h"
+
+/* Constructs a hidden overlay drawn with the given shaders and text renderer */
+PerfOverlay::PerfOverlay(Shader* graphShader, Shader* textShader, TextRenderer* textRenderer, float screenWidth, float screenHeight) {
+	this->mGraphShader = graphShader;
+	this->mTextShader = textShader;
+	this->mTextRenderer = textRenderer;
+	this->mProjectionMatrix = glm::ortho(0.0f, screenWidth, 0.0f, screenHeight);
+	this->mScreenWidth = screenWidth;
+	this->mScreenHeight = screenHeight;
+	this->mVisible = false;
+
+	memset(this->mSamples, 0, sizeof(this->mSamples));
+	this->mSamplesCount = 0;
+	this->mLastTextTime = -PERF_OVERLAY_TEXT_PERIOD;
+	this->mCost = 0;
+
+	// The ring twice, then the two ends of each budget line
+	vector<GLfloat> values(2 * PERF_OVERLAY_SAMPLES + 4, 0.0f);
+
+	for (int i = 0; i < 2; ++i) {
+		values[2 * PERF_OVERLAY_SAMPLES + 2 * i] = values[2 * PERF_OVERLAY_SAMPLES + 2 * i + 1] = (GLfloat)PERF_OVERLAY_BUDGETS[i];
+	}
+
+	glGenVertexArrays(1, &this->VAO);
+	glGenBuffers(1, &this->VBO);
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glBufferData(GL_ARRAY_BUFFER, values.size() * sizeof(GLfloat), &values[0], GL_DYNAMIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (GLvoid*)0);
+
+	// Unbind VAO/VBO
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_HUD, values.size() * sizeof(GLfloat));
+}
+
+/* Destructs the overlay and free resources */
+PerfOverlay::~PerfOverlay() {
+	glDeleteBuffers(1, &this->VBO);
+	glDeleteVertexArrays(1, &this->VAO);
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_HUD, -(long long)((2 * PERF_OVERLAY_SAMPLES + 4) * sizeof(GLfloat)));
+}
+
+/* Shows or hides the overlay */
+void PerfOverlay::SetVisible(bool visible) {
+	this->mVisible = visible;
+}
+
+/* Returns whether the overlay is shown */
+bool PerfOverlay::IsVisible() const {
+	return this->mVisible;
+}
+
+/* Adds the time of a frame to the graph, in seconds */
+void PerfOverlay::AddFrame(double frameTime) {
+	if (!this->mVisible)
+		return;
+
+	GLfloat value = (GLfloat)(frameTime * 1000.0);
+	int slot = (int)(this->mSamplesCount++ % PERF_OVERLAY_SAMPLES);
+	this->mSamples[slot] = value;
+
+	// Write the sample at both of its places
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, slot * sizeof(GLfloat), sizeof(GLfloat), &value);
+	glBufferSubData(GL_ARRAY_BUFFER, (slot + PERF_OVERLAY_SAMPLES) * sizeof(GLfloat), sizeof(GLfloat), &value);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	RenderStats::CountStateChanges(1);
+	RenderStats::CountStreamed(2 * sizeof(GLfloat));
+}
+
+/* Draws the overlay over the frame, at the given time in seconds */
+void PerfOverlay::Render(double time) {
+	if (!this->mVisible)
+		return;
+
+	PROFILE_SCOPE("PerfOverlay::Render");
+	uint64_t begin = Profiler::Now();
+
+	if (time - this->mLastTextTime >= PERF_OVERLAY_TEXT_PERIOD) {
+		this->UpdateText();
+		this->mLastTextTime = time;
+	}
+
+	float x = (float)(this->mScreenWidth - PERF_OVERLAY_MARGIN - PERF_OVERLAY_WIDTH);
+	float y = (float)PERF_OVERLAY_MARGIN;
+
+	// Frame times graph, the last samples are contiguous in the second copy of the ring or right before it
+	int count = (int)min(this->mSamplesCount, (long long)PERF_OVERLAY_SAMPLES);
+
+	this->mGraphShader->Use();
+	glUniformMatrix4fv(this->mGraphShader->ProjectionMatrixLoc, 1, GL_FALSE, glm::value_ptr(this->mProjectionMatrix));
+	glUniform4f(this->mGraphShader->GraphRectLoc, x, y, (GLfloat)PERF_OVERLAY_WIDTH, (GLfloat)PERF_OVERLAY_HEIGHT);
+	glUniform1f(this->mGraphShader->GraphMaxLoc, (GLfloat)PERF_OVERLAY_GRAPH_MAX);
+	glBindVertexArray(this->VAO);
+
+	if (count >= 2) {
+		int first = (int)((this->mSamplesCount - 1) % PERF_OVERLAY_SAMPLES) + PERF_OVERLAY_SAMPLES - count + 1;
+
+		glUniform1i(this->mGraphShader->GraphFirstLoc, first);
+		glUniform1i(this->mGraphShader->GraphSamplesLoc, PERF_OVERLAY_SAMPLES);
+		glUniform3f(this->mGraphShader->GraphColorLoc, PERF_OVERLAY_GRAPH_COLOR.x, PERF_OVERLAY_GRAPH_COLOR.y, PERF_OVERLAY_GRAPH_COLOR.z);
+		glDrawArrays(GL_LINE_STRIP, first, count);
+		RenderStats::CountDraw(0);
+	}
+
+	// Budget lines, each spread across the whole graph
+	glUniform1i(this->mGraphShader->GraphFirstLoc, 2 * PERF_OVERLAY_SAMPLES);
+	glUniform1i(this->mGraphShader->GraphSamplesLoc, 2);
+	glUniform3f(this->mGraphShader->GraphColorLoc, PERF_OVERLAY_BUDGET_COLOR.x, PERF_OVERLAY_BUDGET_COLOR.y, PERF_OVERLAY_BUDGET_COLOR.z);
+	glDrawArrays(GL_LINES, 2 * PERF_OVERLAY_SAMPLES, 4);
+	RenderStats::CountDraw(0);
+
+	glBindVertexArray(0);
+	RenderStats::CountStateChanges(1);
+
+	// Counters above the graph
+	y += (float)(PERF_OVERLAY_HEIGHT + PERF_OVERLAY_LINE_HEIGHT * this->mLines.size());
+
+	for (unsigned int i = 0; i < this->mLines.size(); ++i) {
+		this->mTextRenderer->RenderText(*this->mTextShader, this->mLines[i], x, y, (GLfloat)PERF_OVERLAY_FONT_SCALE, PERF_OVERLAY_TEXT_COLOR);
+		y -= (float)PERF_OVERLAY_LINE_HEIGHT;
+	}
+
+	this->mCost = (Profiler::Now() - begin) / 1e6;
+}
+
+/* Rebuilds the counters text from the last frame's counters */
+void PerfOverlay::UpdateText() {
+	const RenderCounters& counters = RenderStats::GetLastFrame();
+	int count = (int)min(this->mSamplesCount, (long long)PERF_OVERLAY_SAMPLES);
+	double mean = 0, worst = 0;
+
+	for (int i = 0; i < count; ++i) {
+		mean += this->mSamples[i];
+		worst = max(worst, (double)this->mSamples[i]);
+	}
+
+	if (count > 0)
+		mean /= count;
+
+	this->mLines.clear();
+	stringstream ss;
+	ss << fixed << setprecision(2);
+
+	ss << "Frame " << mean << " ms avg, " << worst << " ms max";
+	this->mLines.push_back(ss.str());
+
+	ss.str("");
+	ss << "Draws " << counters.DrawCalls << ", triangles " << counters.Triangles << ", state changes " << counters.StateChanges;
+	this->mLines.push_back(ss.str());
+
+	ss.str("");
+	ss << "Streamed " << counters.StreamedBytes / 1024.0 << " KB, items " << counters.VisibleItems << " visible, " << counters.CulledItems << " culled";
+	this->mLines.push_back(ss.str());
+
+	ss.str("");
+	ss << "Scene " << counters.SceneWidth << "x" << counters.SceneHeight << " (" << 100.0 * counters.SceneWidth / this->mScreenWidth << "%), AA "
+		<< AA_NAMES[counters.SceneAntiAliasing];
+	this->mLines.push_back(ss.str());
+
+	ss.str("");
+	ss << "GPU memory";
+
+	for (int i = 0; i < GPU_MEMORY_TYPES; ++i) {
+		ss << (i == 0 ? " " : ", ") << GPU_MEMORY_NAMES[i] << " " << RenderStats::GetGpuMemory((GpuMemoryType)i) / (1024.0 * 1024.0) << " MB";
+	}
+
+	this->mLines.push_back(ss.str());
+
+	ss.str("");
+	ss << "Overlay " << this->mCost << " ms";
+	this->mLines.push_back(ss.str());
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// STL Includes
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// GL Includes
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Other Includes
+#include "Shader.h"
+#include "TextRenderer.h"
+#include "SceneTarget.h"
+#include "../Utils/RenderStats.h"
+#include "../Utils/Profiler.h"
+
+// Overlay constants
+const int PERF_OVERLAY_SAMPLES = 240;					// Frame times shown by the graph
+const double PERF_OVERLAY_GRAPH_MAX = 50.0;				// Frame time at the top of the graph, in milliseconds
+const double PERF_OVERLAY_BUDGETS[2] = { 1000.0 / 60.0, 1000.0 / 30.0 };	// Frame budgets drawn across the graph, in milliseconds
+const double PERF_OVERLAY_TEXT_PERIOD = 0.25;			// Seconds between two updates of the counters text
+const double PERF_OVERLAY_WIDTH = 480.0;
+const double PERF_OVERLAY_HEIGHT = 120.0;
+const double PERF_OVERLAY_MARGIN = 25.0;
+const double PERF_OVERLAY_FONT_SCALE = 0.4;
+const double PERF_OVERLAY_LINE_HEIGHT = 22.0;
+const glm::vec3 PERF_OVERLAY_GRAPH_COLOR = glm::vec3(0.2f, 1.0f, 0.3f);
+const glm::vec3 PERF_OVERLAY_BUDGET_COLOR = glm::vec3(1.0f, 0.3f, 0.2f);
+const glm::vec3 PERF_OVERLAY_TEXT_COLOR = glm::vec3(1.0f, 1.0f, 1.0f);
+
+
+/*
+	Debug overlay showing a rolling graph of the frame times, the rendering counters of the last frame and the GPU memory.
+	The frame times live in a GPU ring written twice, at its slot and at its slot plus the ring size,
+	so the last samples are always contiguous and the graph is a single line strip draw of a new sample a frame.
+	The counters text is only rebuilt a few times a second
+*/
+class PerfOverlay
+{
+private:
+	GLuint VAO, VBO;
+	Shader* mGraphShader;
+	Shader* mTextShader;
+	TextRenderer* mTextRenderer;
+	glm::mat4 mProjectionMatrix;
+	float mScreenWidth;
+	float mScreenHeight;
+	bool mVisible;
+
+	// Frame times in milliseconds, the last PERF_OVERLAY_SAMPLES ones
+	float mSamples[PERF_OVERLAY_SAMPLES];
+	long long mSamplesCount;
+
+	// Counters text
+	vector<string> mLines;
+	double mLastTextTime;
+	double mCost;				// CPU time of the last overlay render, in milliseconds
+
+public:
+	/* Constructs a hidden overlay drawn with the given shaders and text renderer */
+	PerfOverlay(Shader* graphShader, Shader* textShader, TextRenderer* textRenderer, float screenWidth, float screenHeight);
+
+	/* Destructs the overlay and free resources */
+	~PerfOverlay();
+
+	/* Shows or hides the overlay */
+	void SetVisible(bool visible);
+
+	/* Returns whether the overlay is shown */
+	bool IsVisible() const;
+
+	/* Adds the time of a frame to the graph, in seconds */
+	void AddFrame(double frameTime);
+
+	/* Draws the overlay over the frame, at the given time in seconds */
+	void Render(double time);
+
+private:
+	/* Rebuilds the counters text from the last frame's counters */
+	void UpdateText();
+};
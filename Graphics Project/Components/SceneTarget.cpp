@@ -0,0 +1,225 @@
+#include "SceneTarget.h"
+
+/* Constructs a target for frames of the given size, with the given anti-aliasing */
+SceneTarget::SceneTarget(int width, int height, AntiAliasing antiAliasing) {
+	this->mWidth = width;
+	this->mHeight = height;
+	this->mTarget = NULL;
+	this->mResolve = NULL;
+	this->mFxaaShader = NULL;
+	this->mScale = 1.0;
+
+	glGenVertexArrays(1, &this->VAO);
+
+	glGenQueries(SCENE_TIMER_FRAMES, this->mQueries);
+
+	for (int i = 0; i < SCENE_TIMER_FRAMES; ++i) {
+		this->mPending[i] = false;
+	}
+
+	this->mFramesCount = 0;
+	this->mTiming = false;
+	this->mTime = 0;
+	this->mTimeScale = 1.0;
+	this->mNewTime = false;
+
+	this->SetAntiAliasing(antiAliasing);
+}
+
+/* Destructs the target and free its buffers and queries */
+SceneTarget::~SceneTarget() {
+	glDeleteQueries(SCENE_TIMER_FRAMES, this->mQueries);
+	glDeleteVertexArrays(1, &this->VAO);
+	delete this->mTarget;
+	delete this->mResolve;
+	delete this->mFxaaShader;
+}
+
+/* Sets the scale of the scene's width and height, up to 1 */
+void SceneTarget::SetScale(double scale) {
+	this->mScale = min(scale, 1.0);
+	this->mSceneWidth = max(1, (int)(this->mWidth * this->mScale + 0.5));
+	this->mSceneHeight = max(1, (int)(this->mHeight * this->mScale + 0.5));
+
+	// Only allocated once the scene is first scaled down
+	if (this->mResolve == NULL && this->mTarget->GetSamples() > 1 && this->mScale < 1.0)
+		this->mResolve = new Framebuffer(this->mWidth, this->mHeight);
+}
+
+/* Returns the scale of the scene's width and height */
+double SceneTarget::GetScale() const {
+	return this->mScale;
+}
+
+/* Returns the width the scene is drawn at */
+int SceneTarget::GetSceneWidth() const {
+	return this->mSceneWidth;
+}
+
+/* Returns the height the scene is drawn at */
+int SceneTarget::GetSceneHeight() const {
+	return this->mSceneHeight;
+}
+
+/* Changes the anti-aliasing of the scene, MSAA falls back to the most samples supported */
+void SceneTarget::SetAntiAliasing(AntiAliasing antiAliasing) {
+	while (!IsSupported(antiAliasing)) {
+		std::cout << "GAME::WARNING: " << AA_NAMES[antiAliasing] << " is not supported, falling back to " << AA_NAMES[antiAliasing - 1] << std::endl;
+		antiAliasing = (AntiAliasing)(antiAliasing - 1);
+	}
+
+	if (this->mTarget != NULL && antiAliasing == this->mAntiAliasing)
+		return;
+
+	// The bound framebuffer is kept, the target may be changed between two frames
+	GLint bound;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &bound);
+
+	this->mAntiAliasing = antiAliasing;
+	delete this->mTarget;
+	delete this->mResolve;
+	this->mTarget = new Framebuffer(this->mWidth, this->mHeight, AA_SAMPLES[antiAliasing]);
+	this->mResolve = NULL;
+
+	if (antiAliasing == AA_FXAA && this->mFxaaShader == NULL)
+		this->mFxaaShader = new Shader("Shaders/fxaa_vertex.shader", "Shaders/fxaa_fragment.shader");
+
+	this->SetScale(this->mScale);
+	glBindFramebuffer(GL_FRAMEBUFFER, bound);
+}
+
+/* Returns the anti-aliasing of the scene */
+AntiAliasing SceneTarget::GetAntiAliasing() const {
+	return this->mAntiAliasing;
+}
+
+/* Returns the number of samples per pixel of the scene */
+int SceneTarget::GetSamples() const {
+	return this->mTarget->GetSamples();
+}
+
+/* Clears the scene and draws the next commands into it */
+void SceneTarget::Begin() {
+	// Read back the query of the frame issued SCENE_TIMER_FRAMES frames ago, that frame is not timed if the GPU is not done with it
+	int slot = (int)(this->mFramesCount++ % SCENE_TIMER_FRAMES);
+
+	if (this->mPending[slot]) {
+		GLint available = 0;
+		glGetQueryObjectiv(this->mQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(this->mQueries[slot], GL_QUERY_RESULT, &elapsed);
+			this->mTime = elapsed / 1e9;
+			this->mTimeScale = this->mScales[slot];
+			this->mNewTime = true;
+			this->mPending[slot] = false;
+		}
+	}
+
+	this->mTiming = !this->mPending[slot];
+
+	if (this->mTiming) {
+		glBeginQuery(GL_TIME_ELAPSED, this->mQueries[slot]);
+		this->mPending[slot] = true;
+		this->mScales[slot] = this->mScale;
+	}
+
+	this->mTarget->Bind(this->mSceneWidth, this->mSceneHeight);
+
+	// Only the part drawn into is cleared
+	if (this->mScale < 1.0) {
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(0, 0, this->mSceneWidth, this->mSceneHeight);
+	}
+
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+
+	RenderStats::SetScene(this->mSceneWidth, this->mSceneHeight, this->mAntiAliasing);
+}
+
+/* Upscales the scene into the given framebuffer (0 for the window), which the next commands are drawn into over the frame's size */
+void SceneTarget::End(GLuint target) {
+	// A multisampled scene is resolved at its size before being scaled
+	if (this->mAntiAliasing == AA_FXAA) {
+		this->DrawFxaa(target);
+	}
+	else if (this->mScale >= 1.0) {
+		this->mTarget->BlitTo(target, this->mWidth, this->mHeight);
+	}
+	else if (this->mResolve != NULL) {
+		this->mTarget->BlitTo(this->mResolve->GetID(), this->mSceneWidth, this->mSceneHeight, this->mSceneWidth, this->mSceneHeight);
+		this->mResolve->BlitTo(target, this->mWidth, this->mHeight, this->mSceneWidth, this->mSceneHeight);
+	}
+	else {
+		this->mTarget->BlitTo(target, this->mWidth, this->mHeight, this->mSceneWidth, this->mSceneHeight);
+	}
+
+	glViewport(0, 0, this->mWidth, this->mHeight);
+
+	if (this->mTiming)
+		glEndQuery(GL_TIME_ELAPSED);
+}
+
+/* Returns the GPU time, in seconds, of the scene of the last frame read back since the previous call and the scale it was drawn at,
+   false if none was */
+bool SceneTarget::ReadTime(double& time, double& scale) {
+	if (!this->mNewTime)
+		return false;
+
+	time = this->mTime;
+	scale = this->mTimeScale;
+	this->mNewTime = false;
+	return true;
+}
+
+/* Returns whether the GPU supports the given anti-aliasing */
+bool SceneTarget::IsSupported(AntiAliasing antiAliasing) {
+	GLint maxSamples = 1;
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+
+	return AA_SAMPLES[antiAliasing] <= maxSamples;
+}
+
+/* Returns the anti-aliasing of the given name, false if there is none */
+bool SceneTarget::ParseAntiAliasing(const string& name, AntiAliasing& antiAliasing) {
+	for (int i = 0; i < AA_MODES; ++i) {
+		if (AA_NAMES[i] == name) {
+			antiAliasing = (AntiAliasing)i;
+			return true;
+		}
+	}
+
+	std::cout << "GAME::ERROR: Unknown anti-aliasing " << name << ", expected none, msaa2, msaa4, msaa8 or fxaa" << std::endl;
+	return false;
+}
+
+/* Filters the scene with FXAA while scaling it into the given framebuffer */
+void SceneTarget::DrawFxaa(GLuint target) {
+	glBindFramebuffer(GL_FRAMEBUFFER, target);
+	glViewport(0, 0, this->mWidth, this->mHeight);
+
+	// Covers the whole frame, as the blit does
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	this->mFxaaShader->Use();
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, this->mTarget->GetColorTexture());
+	glUniform1i(this->mFxaaShader->PostSourceLoc, 0);
+	glUniform2f(this->mFxaaShader->PostSourceScaleLoc, (GLfloat)this->mSceneWidth / this->mWidth, (GLfloat)this->mSceneHeight / this->mHeight);
+	glUniform2f(this->mFxaaShader->PostSourceTexelLoc, 1.0f / this->mWidth, 1.0f / this->mHeight);
+	glUniform2f(this->mFxaaShader->PostSourceMaxLoc, (this->mSceneWidth - 0.5f) / this->mWidth, (this->mSceneHeight - 0.5f) / this->mHeight);
+
+	glBindVertexArray(this->VAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+
+	RenderStats::CountDraw(1);
+	RenderStats::CountStateChanges(4);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <string>
+#include <algorithm>
+using namespace std;
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other Includes
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "../Utils/RenderStats.h"
+
+// Scene target constants
+const int SCENE_TIMER_FRAMES = 3;				// Frames in flight, the GPU time of a frame is read this many frames later
+
+
+/*
+	Anti-aliasing of the scene
+*/
+enum AntiAliasing {
+	AA_NONE,
+	AA_MSAA_2X,
+	AA_MSAA_4X,
+	AA_MSAA_8X,
+	AA_FXAA,				// Post filter along the edges of a single sampled scene, in the pass scaling it into the frame
+	AA_MODES
+};
+
+const string AA_NAMES[AA_MODES] = { "none", "msaa2", "msaa4", "msaa8", "fxaa" };
+const int AA_SAMPLES[AA_MODES] = { 1, 2, 4, 8, 1 };
+
+
+/*
+	Offscreen target the 3D scene is drawn into at a scaled resolution, then upscaled into the frame.
+	The target is allocated at the frame's size and the scene drawn into its lower left part,
+	so changing the scale every frame costs no allocation.
+	The GPU time of drawing and upscaling the scene is measured with queries read back frames later,
+	without waiting on the GPU. The anti-aliasing can be changed at any frame, reallocating the target.
+	Must be used from the thread owning the GL context
+*/
+class SceneTarget
+{
+private:
+	Framebuffer* mTarget;
+	Framebuffer* mResolve;				// Single sampled copy of a scaled multisampled scene, which can't be scaled while resolved
+	AntiAliasing mAntiAliasing;
+	Shader* mFxaaShader;				// Loaded once FXAA is first used
+	GLuint VAO;							// Without attributes, the post-process triangle is made from the vertex index
+	int mWidth;
+	int mHeight;
+	double mScale;
+	int mSceneWidth;
+	int mSceneHeight;
+
+	// GPU time
+	GLuint mQueries[SCENE_TIMER_FRAMES];
+	bool mPending[SCENE_TIMER_FRAMES];	// Issued and not read back yet
+	double mScales[SCENE_TIMER_FRAMES];	// Scale each query's frame was drawn at
+	long long mFramesCount;
+	bool mTiming;						// Whether the current frame is timed
+	double mTime;						// Last time read back, in seconds
+	double mTimeScale;					// Scale of the frame of that time
+	bool mNewTime;
+
+public:
+	/* Constructs a target for frames of the given size, with the given anti-aliasing */
+	SceneTarget(int width, int height, AntiAliasing antiAliasing);
+
+	/* Destructs the target and free its buffers and queries */
+	~SceneTarget();
+
+	/* Sets the scale of the scene's width and height, up to 1 */
+	void SetScale(double scale);
+
+	/* Returns the scale of the scene's width and height */
+	double GetScale() const;
+
+	/* Returns the width the scene is drawn at */
+	int GetSceneWidth() const;
+
+	/* Returns the height the scene is drawn at */
+	int GetSceneHeight() const;
+
+	/* Changes the anti-aliasing of the scene, MSAA falls back to the most samples supported */
+	void SetAntiAliasing(AntiAliasing antiAliasing);
+
+	/* Returns the anti-aliasing of the scene */
+	AntiAliasing GetAntiAliasing() const;
+
+	/* Returns the number of samples per pixel of the scene */
+	int GetSamples() const;
+
+	/* Clears the scene and draws the next commands into it */
+	void Begin();
+
+	/* Upscales the scene into the given framebuffer (0 for the window), which the next commands are drawn into over the frame's size */
+	void End(GLuint target);
+
+	/* Returns the GPU time, in seconds, of the scene of the last frame read back since the previous call and the scale it was drawn at,
+	   false if none was */
+	bool ReadTime(double& time, double& scale);
+
+	/* Returns whether the GPU supports the given anti-aliasing */
+	static bool IsSupported(AntiAliasing antiAliasing);
+
+	/* Returns the anti-aliasing of the given name, false if there is none */
+	static bool ParseAntiAliasing(const string& name, AntiAliasing& antiAliasing);
+
+private:
+	/* Filters the scene with FXAA while scaling it into the given framebuffer */
+	void DrawFxaa(GLuint target);
+};
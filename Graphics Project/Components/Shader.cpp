@@ -90,6 +90,7 @@ Shader::~Shader() {
 /* Activates the current shader */
 void Shader::Use() const {
 	glUseProgram(this->ProgramID);
+	RenderStats::CountStateChanges(1);
 }
 
 /* Setup shader's attribute and uniform locations */
@@ -98,9 +99,12 @@ void Shader::SetupLocations() {
 	this->VertexPositionLoc = VERTEX_POSITION_LOC;
 	this->VertexNormalLoc = VERTEX_NORMAL_LOC;
 	this->VertexTextureCoordLoc = VERTEX_TEXTURE_COORD_LOC;
+	this->VertexInstanceMatrixLoc = VERTEX_INSTANCE_MATRIX_LOC;
 
 	// Matrices
 	this->ModelMatrixLoc = glGetUniformLocation(this->ProgramID, MODEL_MATRIX_LOC);
+	this->LocalModelMatrixLoc = glGetUniformLocation(this->ProgramID, LOCAL_MODEL_MATRIX_LOC);
+	this->InstancedLoc = glGetUniformLocation(this->ProgramID, INSTANCED_LOC);
 	this->ViewMatrixLoc = glGetUniformLocation(this->ProgramID, VIEW_MATRIX_LOC);
 	this->ProjectionMatrixLoc = glGetUniformLocation(this->ProgramID, PROJECTION_MATRIX_LOC);
 
@@ -128,4 +132,17 @@ void Shader::SetupLocations() {
 	// Text
 	this->TextSamplerLoc = glGetUniformLocation(this->ProgramID, TEXT_SAMPLER_LOC);
 	this->TextColorLoc = glGetUniformLocation(this->ProgramID, TEXT_COLOR_LOC);
+
+	// Graph
+	this->GraphRectLoc = glGetUniformLocation(this->ProgramID, GRAPH_RECT_LOC);
+	this->GraphFirstLoc = glGetUniformLocation(this->ProgramID, GRAPH_FIRST_LOC);
+	this->GraphSamplesLoc = glGetUniformLocation(this->ProgramID, GRAPH_SAMPLES_LOC);
+	this->GraphMaxLoc = glGetUniformLocation(this->ProgramID, GRAPH_MAX_LOC);
+	this->GraphColorLoc = glGetUniformLocation(this->ProgramID, GRAPH_COLOR_LOC);
+
+	// Post-process
+	this->PostSourceLoc = glGetUniformLocation(this->ProgramID, POST_SOURCE_LOC);
+	this->PostSourceScaleLoc = glGetUniformLocation(this->ProgramID, POST_SOURCE_SCALE_LOC);
+	this->PostSourceTexelLoc = glGetUniformLocation(this->ProgramID, POST_SOURCE_TEXEL_LOC);
+	this->PostSourceMaxLoc = glGetUniformLocation(this->ProgramID, POST_SOURCE_MAX_LOC);
 }
@@ -10,11 +10,17 @@ using namespace std;
 // GL Includes
 #include <GL/glew.h>
 
+// Other includes
+#include "../Utils/RenderStats.h"
+
 // Attributes and uniform constants
 #define VERTEX_POSITION_LOC				0
 #define VERTEX_NORMAL_LOC				1
 #define VERTEX_TEXTURE_COORD_LOC		2
+#define VERTEX_INSTANCE_MATRIX_LOC		3	// Takes the 4 locations of the matrix columns
 #define MODEL_MATRIX_LOC				"model"
+#define LOCAL_MODEL_MATRIX_LOC			"local_model"
+#define INSTANCED_LOC					"instanced"
 #define VIEW_MATRIX_LOC					"view"
 #define PROJECTION_MATRIX_LOC			"projection"
 #define CAMERA_POSITION_LOC				"camera_position"
@@ -34,6 +40,15 @@ using namespace std;
 #define LIGHT_ATTEN_QUADRATIC_LOC		"light.atten_quadratic"
 #define TEXT_SAMPLER_LOC				"text"
 #define TEXT_COLOR_LOC					"text_color"
+#define GRAPH_RECT_LOC					"graph_rect"
+#define GRAPH_FIRST_LOC					"graph_first"
+#define GRAPH_SAMPLES_LOC				"graph_samples"
+#define GRAPH_MAX_LOC					"graph_max"
+#define GRAPH_COLOR_LOC					"graph_color"
+#define POST_SOURCE_LOC					"source"
+#define POST_SOURCE_SCALE_LOC			"source_scale"
+#define POST_SOURCE_TEXEL_LOC			"source_texel"
+#define POST_SOURCE_MAX_LOC				"source_max"
 
 /*
 	A shader program class which compiles vertex and fragment shaders
@@ -49,9 +64,12 @@ public:
 	GLint VertexPositionLoc;
 	GLint VertexNormalLoc;
 	GLint VertexTextureCoordLoc;
+	GLint VertexInstanceMatrixLoc;
 
 	// Matrices
 	GLint ModelMatrixLoc;
+	GLint LocalModelMatrixLoc;
+	GLint InstancedLoc;
 	GLint ViewMatrixLoc;
 	GLint ProjectionMatrixLoc;
 
@@ -80,6 +98,19 @@ public:
 	GLint TextSamplerLoc;
 	GLint TextColorLoc;
 
+	// Graph
+	GLint GraphRectLoc;
+	GLint GraphFirstLoc;
+	GLint GraphSamplesLoc;
+	GLint GraphMaxLoc;
+	GLint GraphColorLoc;
+
+	// Post-process
+	GLint PostSourceLoc;
+	GLint PostSourceScaleLoc;
+	GLint PostSourceTexelLoc;
+	GLint PostSourceMaxLoc;
+
 	/* Compiles and links the vertex and fragment shaders into a program */
 	Shader(const char* vertex_path, const char* fragment_path);
 
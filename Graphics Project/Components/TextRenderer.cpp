@@ -5,6 +5,12 @@ TextRenderer::TextRenderer(const char* font, int size, float screenWidth, float
 	// Calculate projection matrix to be using during rendering
 	mProjectionMatrix = glm::ortho(0.0f, screenWidth, 0.0f, screenHeight);
 
+	this->VAO = 0;
+	this->VBO = 0;
+	this->mAtlas = 0;
+	this->mAtlasWidth = this->mAtlasHeight = 0;
+	this->mBufferBytes = 0;
+
 	// FreeType
 	FT_Library ft;
 
@@ -29,43 +35,63 @@ TextRenderer::TextRenderer(const char* font, int size, float screenWidth, float
 	// Disable byte-alignment restriction
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-	// Load first 128 characters of ASCII set
+	// Place the first 128 characters of ASCII set in rows of the atlas
+	GLuint x = TEXT_ATLAS_PADDING, y = TEXT_ATLAS_PADDING, rowHeight = 0;
+
 	for (GLubyte c = 0; c < ASCII_COUNT; ++c) {
+		memset(&this->mCharacters[c], 0, sizeof(Glyph));
+
 		// Load character glyph 
 		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
 			std::cout << "ERROR::FREETYTPE: Failed to load Glyph of character '" << c << "'" << std::endl;
 			continue;
 		}
 
-		// Generate texture
-		GLuint texture;
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RED,
-			face->glyph->bitmap.width,
-			face->glyph->bitmap.rows,
-			0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			face->glyph->bitmap.buffer
-		);
-
-		// Set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		GLuint width = face->glyph->bitmap.width;
+		GLuint height = face->glyph->bitmap.rows;
+
+		if (x + width + TEXT_ATLAS_PADDING > TEXT_ATLAS_WIDTH) {
+			x = TEXT_ATLAS_PADDING;
+			y += rowHeight + TEXT_ATLAS_PADDING;
+			rowHeight = 0;
+		}
 
 		// Now store character for later use
-		this->mCharacters[c].TextureID = texture;
-		this->mCharacters[c].Width = face->glyph->bitmap.width;
-		this->mCharacters[c].Height = face->glyph->bitmap.rows;
+		this->mCharacters[c].AtlasX = x;
+		this->mCharacters[c].AtlasY = y;
+		this->mCharacters[c].Width = width;
+		this->mCharacters[c].Height = height;
 		this->mCharacters[c].BearingX = face->glyph->bitmap_left;
 		this->mCharacters[c].BearingY = face->glyph->bitmap_top;
 		this->mCharacters[c].Advance = face->glyph->advance.x >> 6;	// Bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+
+		x += width + TEXT_ATLAS_PADDING;
+		rowHeight = max(rowHeight, height);
+	}
+
+	this->mAtlasWidth = TEXT_ATLAS_WIDTH;
+	this->mAtlasHeight = y + rowHeight + TEXT_ATLAS_PADDING;
+
+	// Generate the atlas texture, cleared so the padding stays empty
+	vector<GLubyte> clear(this->mAtlasWidth * this->mAtlasHeight, 0);
+	glGenTextures(1, &this->mAtlas);
+	glBindTexture(GL_TEXTURE_2D, this->mAtlas);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, this->mAtlasWidth, this->mAtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, &clear[0]);
+
+	// Set texture options
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// Copy each glyph into its place
+	for (GLubyte c = 0; c < ASCII_COUNT; ++c) {
+		const Glyph& ch = this->mCharacters[c];
+
+		if (ch.Width == 0 || ch.Height == 0 || FT_Load_Char(face, c, FT_LOAD_RENDER))
+			continue;
+
+		glTexSubImage2D(GL_TEXTURE_2D, 0, ch.AtlasX, ch.AtlasY, ch.Width, ch.Height, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
 	}
 
 	// Unbind texture target
@@ -80,7 +106,7 @@ TextRenderer::TextRenderer(const char* font, int size, float screenWidth, float
 	glGenBuffers(1, &this->VBO);
 	glBindVertexArray(this->VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, 0, NULL, GL_STREAM_DRAW);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
 
@@ -90,6 +116,8 @@ TextRenderer::TextRenderer(const char* font, int size, float screenWidth, float
 
 	// Disable attributes
 	glDisableVertexAttribArray(0);
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_HUD, (long long)this->mAtlasWidth * this->mAtlasHeight);
 }
 
 /* Destructs the loaded font */
@@ -98,23 +126,23 @@ TextRenderer::~TextRenderer() {
 	glDeleteBuffers(1, &this->VBO);
 	glDeleteVertexArrays(1, &this->VAO);
 
-	// Release textures
-	for (GLubyte c = 0; c < ASCII_COUNT; ++c) {
-		glDeleteTextures(1, &this->mCharacters[c].TextureID);
-	}
+	// Release the atlas
+	glDeleteTextures(1, &this->mAtlas);
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_HUD, -(long long)this->mAtlasWidth * this->mAtlasHeight - this->mBufferBytes);
 }
 
 /* Draws the given text starting from (x, y) with the specified scale and color  */
 void TextRenderer::RenderText(const Shader &shader, const string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
-	shader.Use();
-	glUniformMatrix4fv(shader.ProjectionMatrixLoc, 1, GL_FALSE, glm::value_ptr(mProjectionMatrix));
-	glUniform3f(shader.TextColorLoc, color.x, color.y, color.z);
+	if (text.empty())
+		return;
 
-	// Activate corresponding render state	
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(this->VAO);
+	// Build the quads of all the characters
+	this->mVertices.resize(text.size() * 6 * 4);
+	GLfloat* vertices = &this->mVertices[0];
+	GLfloat atlasWidth = (GLfloat)this->mAtlasWidth;
+	GLfloat atlasHeight = (GLfloat)this->mAtlasHeight;
 
-	// Iterate through all characters
 	for (unsigned int i = 0; i < text.size(); ++i) {
 		const Glyph& ch = this->mCharacters[text[i]];
 
@@ -124,35 +152,62 @@ void TextRenderer::RenderText(const Shader &shader, const string& text, GLfloat
 		GLfloat w = ch.Width * scale;
 		GLfloat h = ch.Height * scale;
 
-		// Update VBO for each character
-		GLfloat vertices[6][4] = {
-			{ xpos,     ypos + h,   0.0, 0.0 },
-			{ xpos,     ypos,       0.0, 1.0 },
-			{ xpos + w, ypos,       1.0, 1.0 },
+		// Corners of the glyph in the atlas
+		GLfloat u0 = ch.AtlasX / atlasWidth;
+		GLfloat v0 = ch.AtlasY / atlasHeight;
+		GLfloat u1 = (ch.AtlasX + ch.Width) / atlasWidth;
+		GLfloat v1 = (ch.AtlasY + ch.Height) / atlasHeight;
 
-			{ xpos,     ypos + h,   0.0, 0.0 },
-			{ xpos + w, ypos,       1.0, 1.0 },
-			{ xpos + w, ypos + h,   1.0, 0.0 }
-		};
-
-		// Render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+		GLfloat quad[6][4] = {
+			{ xpos,     ypos + h,   u0, v0 },
+			{ xpos,     ypos,       u0, v1 },
+			{ xpos + w, ypos,       u1, v1 },
 
-		// Update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+			{ xpos,     ypos + h,   u0, v0 },
+			{ xpos + w, ypos,       u1, v1 },
+			{ xpos + w, ypos + h,   u1, v0 }
+		};
 
-		// Render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		memcpy(vertices + i * 6 * 4, quad, sizeof(quad));
 
 		// Now advance cursors for next glyph
 		x += ch.Advance * scale;
 	}
 
+	shader.Use();
+	glUniformMatrix4fv(shader.ProjectionMatrixLoc, 1, GL_FALSE, glm::value_ptr(mProjectionMatrix));
+	glUniform3f(shader.TextColorLoc, color.x, color.y, color.z);
+
+	// Activate corresponding render state	
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, this->mAtlas);
+	glBindVertexArray(this->VAO);
+
+	// Orphan the VBO so the draws of the previous texts don't have to finish before it is written,
+	// growing it when the text is longer than any before
+	long long bytes = this->mVertices.size() * sizeof(GLfloat);
+
+	if (bytes > this->mBufferBytes) {
+		RenderStats::AddGpuMemory(GPU_MEMORY_HUD, bytes - this->mBufferBytes);
+		this->mBufferBytes = bytes;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glBufferData(GL_ARRAY_BUFFER, this->mBufferBytes, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Render all the quads
+	glDrawArrays(GL_TRIANGLES, 0, text.size() * 6);
+
 	// Unbing VAO/Texture
 	glBindVertexArray(0);
 	glBindTexture(GL_TEXTURE_2D, 0);
+
+	RenderStats::CountDraw(text.size() * 2);
+	RenderStats::CountStateChanges(3);
+	RenderStats::CountStreamed(bytes);
 }
 
 /* Returns the width of the given text */
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <vector>
+#include <algorithm>
+#include <cstring>
 using namespace std;
 
 // GL Includes
@@ -18,13 +21,15 @@ using namespace std;
 
 // Other Includes
 #include "Shader.h"
+#include "../Utils/RenderStats.h"
 
 
 /*
 	Holds all state information relevant to a character glyph as loaded using FreeType
 */
 struct Glyph {
-	GLuint TextureID;		// ID handle of the glyph texture
+	GLuint AtlasX;			// Left of the glyph in the atlas texture
+	GLuint AtlasY;			// Top of the glyph in the atlas texture
 	GLuint Width;			// Width of glyph
 	GLuint Height;			// Height of glyph
 	GLuint BearingX;		// Offset from baseline to left of glyph
@@ -34,17 +39,24 @@ struct Glyph {
 
 // Constants
 const int ASCII_COUNT = 128;
+const int TEXT_ATLAS_WIDTH = 1024;		// Glyphs are packed in rows of this width, within the texture size every GL 3.3 device supports
+const int TEXT_ATLAS_PADDING = 1;		// Empty pixels around a glyph so filtering doesn't bleed its neighbours in
 
 
 /*
-	Class used to render text on OpenGL based applications
+	Class used to render text on OpenGL based applications,
+	the glyphs are packed into a single texture so a text is drawn at once
 */
 class TextRenderer
 {
 private:
 	GLuint VAO, VBO;
+	GLuint mAtlas;
+	GLuint mAtlasWidth, mAtlasHeight;
 	glm::mat4 mProjectionMatrix;
 	Glyph mCharacters[ASCII_COUNT];
+	vector<GLfloat> mVertices;
+	long long mBufferBytes;
 	
 public:
 	/* Loads a given font with the specified size */
@@ -15,6 +15,10 @@ Texture::Texture(const char* path, TextureType type) {
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
 	glGenerateMipmap(GL_TEXTURE_2D);
 
+	// The mipmaps add a third of the base level
+	this->mBytes = (long long)width * height * 3 * 4 / 3;
+	RenderStats::AddGpuMemory(GPU_MEMORY_TEXTURES, this->mBytes);
+
 	// Set texture parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -32,4 +36,5 @@ Texture::Texture(const char* path, TextureType type) {
 Texture::~Texture() {
 	glDeleteTextures(1, &this->ID);
 	this->ID = -1;
+	RenderStats::AddGpuMemory(GPU_MEMORY_TEXTURES, -this->mBytes);
 }
\ No newline at end of file
@@ -10,6 +10,9 @@ using namespace std;
 // Image Loading Library Includes
 #include <SOIL/SOIL.h>
 
+// Other includes
+#include "../Utils/RenderStats.h"
+
 
 /*
 	Defines several types for textures
@@ -36,4 +39,7 @@ public:
 
 	/* Destructs the texture and free resources up */
 	~Texture();
+
+private:
+	long long mBytes;		// GPU memory of the texture and its mipmaps
 };
@@ -0,0 +1,282 @@
+#include "BlockGenerator.h"
+
+/* Returns true with the given probability */
+static bool Chance(Random& random, double probability) {
+	return random.Next() < probability * 4294967296.0;
+}
+
+/* Returns the tag of the given block of the given epoch */
+static unsigned long long MakeTag(unsigned int epoch, unsigned int index) {
+	return ((unsigned long long)epoch << 32) | index;
+}
+
+/* Constructs a generator of the given difficulty for the given number of games, keeping up with views of the given number of slices, and starts its thread */
+BlockGenerator::BlockGenerator(int channelsCount, int viewSlices, const BlockDifficulty& difficulty) {
+	this->mDifficulty = difficulty;
+	this->mChannelsCount = channelsCount;
+	this->mChannels = new Channel[channelsCount];
+	this->mStopping = false;
+	this->mSleeping = false;
+	this->mWakeRequested = false;
+
+	// A reset goes back to the block of the observation's end, at most one block more than the view holds
+	this->mViewSlices = max(viewSlices, LANES_Z_COUNT);
+	this->mHistoryBlocks = (this->mViewSlices + LANES_Z_COUNT - 1) / LANES_Z_COUNT + 1;
+	this->mQueueBlocks = this->mHistoryBlocks + GENERATOR_QUEUE_BLOCKS;
+
+	for (int i = 0; i < channelsCount; ++i) {
+		Channel& channel = this->mChannels[i];
+		channel.Config = 0;
+		channel.NextIndex = 0;
+		channel.Floor = 0;
+		channel.Blocks = new GeneratedBlock[this->mQueueBlocks];
+		channel.ProducerEpoch = 0;
+		channel.ProducerIndex = 0;
+		channel.Misses = 0;
+
+		// No block belongs to any epoch yet
+		for (int b = 0; b < this->mQueueBlocks; ++b) {
+			channel.Blocks[b].Tag = ~0ULL;
+		}
+	}
+
+	this->mWorker = thread(&BlockGenerator::WorkerLoop, this);
+}
+
+/* Stops the generator thread */
+BlockGenerator::~BlockGenerator() {
+	{
+		lock_guard<mutex> lock(this->mWakeMutex);
+		this->mStopping = true;
+	}
+
+	this->mWake.notify_one();
+	this->mWorker.join();
+
+	for (int i = 0; i < this->mChannelsCount; ++i) {
+		delete[] this->mChannels[i].Blocks;
+	}
+
+	delete[] this->mChannels;
+}
+
+/* Returns the number of games the generator has a channel for */
+int BlockGenerator::GetChannelsCount() const {
+	return this->mChannelsCount;
+}
+
+/* Returns the longest view, in slices, the rings are sized for */
+int BlockGenerator::GetViewSlices() const {
+	return this->mViewSlices;
+}
+
+/* Restarts the blocks of a game from the given seed */
+void BlockGenerator::Seed(int channel, unsigned int seed) {
+	Channel& c = this->mChannels[channel];
+	unsigned int epoch = (unsigned int)(c.Config.load() >> 32) + 1;
+
+	// The index is reset first, so the generator thread never sees the new seed with the old index
+	c.NextIndex.store(0);
+	c.Floor.store(MakeTag(epoch, 0));
+	c.Config.store(((unsigned long long)epoch << 32) | seed);
+
+	this->Wake();
+}
+
+/* Copies the next packed block of a game into the given buffer, never waits for the generator thread */
+void BlockGenerator::NextBlock(int channel, unsigned char* cells) {
+	Channel& c = this->mChannels[channel];
+	unsigned long long config = c.Config.load();
+	unsigned int epoch = (unsigned int)(config >> 32);
+	unsigned int seed = (unsigned int)config;
+	unsigned int index = c.NextIndex.load();
+	unsigned int floor = (unsigned int)c.Floor.load(memory_order_relaxed);
+	GeneratedBlock& block = c.Blocks[index % this->mQueueBlocks];
+
+	// The slots of the blocks from the floor on are never written over, the older ones may be being written
+	if (index >= floor && block.Tag.load(memory_order_acquire) == MakeTag(epoch, index)) {
+		memcpy(cells, block.Cells, LEVEL_BLOCK_SIZE);
+	}
+	else {
+		// The generator thread is behind
+		this->Generate(seed, index, cells);
+		c.Misses++;
+	}
+
+	c.NextIndex.store(index + 1);
+
+	// The blocks before the oldest one a reset may go back to make room for new ones
+	if (index + 1 >= floor + this->mHistoryBlocks) {
+		c.Floor.store(MakeTag(epoch, index + 1 - this->mHistoryBlocks));
+		this->Wake();
+	}
+}
+
+/* Returns the index of the next block of a game */
+unsigned int BlockGenerator::GetNextIndex(int channel) const {
+	return this->mChannels[channel].NextIndex.load();
+}
+
+/* Makes the given block of a game its next block again, with the same seed */
+void BlockGenerator::Rewind(int channel, unsigned int index) {
+	Channel& c = this->mChannels[channel];
+
+	// The taken blocks are still in the ring, unless the game goes back further than its view
+	c.NextIndex.store(index);
+}
+
+/* Returns the number of blocks a game had to generate itself */
+unsigned long long BlockGenerator::GetMisses(int channel) const {
+	return this->mChannels[channel].Misses.load();
+}
+
+/* Generates block i of the game with the given seed into the given packed buffer */
+void BlockGenerator::Generate(unsigned int seed, unsigned int index, unsigned char* cells) const {
+	Random random(seed ^ (index * 0x9E3779B9u));
+	unsigned char items[LANES_Z_COUNT][LANES_Y_COUNT][LANES_X_COUNT];
+	double density = min(this->mDifficulty.MaxObstacleDensity, this->mDifficulty.ObstacleDensity + this->mDifficulty.ObstacleDensityRamp * index);
+
+	for (int attempt = 0; attempt < GENERATOR_MAX_ATTEMPTS; ++attempt) {
+		memset(items, EMPTY, sizeof(items));
+
+		// Obstacles, the first and last slices stay free so any block can follow any other
+		for (int z = 1; z + 1 < LANES_Z_COUNT; ++z) {
+			for (int x = 0; x < LANES_X_COUNT; ++x) {
+				if (!Chance(random, density))
+					continue;
+
+				int height = 1;
+				while (height + 1 < LANES_Y_COUNT && Chance(random, this->mDifficulty.StackChance)) {
+					height++;
+				}
+
+				for (int y = 0; y < height; ++y) {
+					items[z][y][x] = BLOCK;
+				}
+			}
+		}
+
+		if (IsPassable(items))
+			break;
+
+		// Give up on obstacles
+		if (attempt + 1 == GENERATOR_MAX_ATTEMPTS)
+			memset(items, EMPTY, sizeof(items));
+	}
+
+	// Coins and gems on the free cells the character can stand in
+	for (int z = 0; z < LANES_Z_COUNT; ++z) {
+		for (int y = 0; y < LANES_Y_COUNT; ++y) {
+			for (int x = 0; x < LANES_X_COUNT; ++x) {
+				if (items[z][y][x] != EMPTY || (y > 0 && items[z][y - 1][x] != BLOCK))
+					continue;
+
+				if (!Chance(random, this->mDifficulty.CoinDensity))
+					continue;
+
+				if (Chance(random, this->mDifficulty.GemChance))
+					items[z][y][x] = GEM_DOUBLE_SCORE + random.NextInt(GEM_REVERSED_MODE - GEM_DOUBLE_SCORE + 1);
+				else
+					items[z][y][x] = COIN;
+			}
+		}
+	}
+
+	// Pack the items
+	const unsigned char* item = &items[0][0][0];
+	memset(cells, 0, LEVEL_BLOCK_SIZE);
+
+	for (int i = 0; i < LEVEL_BLOCK_CELLS; ++i) {
+		cells[i >> 1] |= item[i] << ((i & 1) << 2);
+	}
+}
+
+/* Returns whether the character can go through the given block from any ground lane of its first slice */
+bool BlockGenerator::IsPassable(const unsigned char items[LANES_Z_COUNT][LANES_Y_COUNT][LANES_X_COUNT]) {
+	unsigned long long ground = BlockGraph::GetGroundStates(DEFAULT_GRID_DIMS);
+	unsigned long long states[GRAPH_MAX_STATE_WORDS];
+
+	BlockGraph::GetEntryStates(DEFAULT_GRID_DIMS, &items[0][0][0], states);
+	return (states[0] & ground) == ground;
+}
+
+/* Fills the rings of all of the games until the generator is stopped */
+void BlockGenerator::WorkerLoop() {
+	while (!this->mStopping) {
+		bool produced = false;
+
+		for (int i = 0; i < this->mChannelsCount && !this->mStopping; ++i) {
+			produced |= this->Produce(this->mChannels[i]);
+		}
+
+		if (produced)
+			continue;
+
+		// All of the rings are full. They are looked at once more after announcing the sleep,
+		// so a game making room in between either sees the announcement or has its room seen
+		this->mSleeping = true;
+
+		for (int i = 0; i < this->mChannelsCount && !this->mStopping; ++i) {
+			produced |= this->Produce(this->mChannels[i]);
+		}
+
+		unique_lock<mutex> lock(this->mWakeMutex);
+
+		if (!produced)
+			this->mWake.wait(lock, [this] { return this->mStopping || this->mWakeRequested; });
+
+		this->mWakeRequested = false;
+		this->mSleeping = false;
+	}
+}
+
+/* Generates the next block of a game if its ring isn't full, returns false if it is */
+bool BlockGenerator::Produce(Channel& channel) {
+	unsigned long long config = channel.Config.load();
+	unsigned int epoch = (unsigned int)(config >> 32);
+	unsigned int seed = (unsigned int)config;
+	unsigned int index = channel.NextIndex.load();
+
+	// The game was seeded again
+	if (channel.ProducerEpoch != epoch) {
+		channel.ProducerEpoch = epoch;
+		channel.ProducerIndex = 0;
+	}
+
+	// The game generated blocks itself
+	if (channel.ProducerIndex < index)
+		channel.ProducerIndex = index;
+
+	// A floor of another epoch means the game was seeded since the config was read, its slots may be in use again
+	unsigned long long floorTag = channel.Floor.load();
+	if ((unsigned int)(floorTag >> 32) != epoch)
+		return false;
+
+	// The ring holds the blocks from the floor on, the slots of the older ones are free
+	unsigned int floor = (unsigned int)floorTag;
+	if (channel.ProducerIndex < floor)
+		channel.ProducerIndex = floor;
+
+	if (channel.ProducerIndex - floor >= (unsigned int)this->mQueueBlocks)
+		return false;
+
+	GeneratedBlock& block = channel.Blocks[channel.ProducerIndex % this->mQueueBlocks];
+	this->Generate(seed, channel.ProducerIndex, block.Cells);
+	block.Tag.store(MakeTag(epoch, channel.ProducerIndex), memory_order_release);
+
+	channel.ProducerIndex++;
+	return true;
+}
+
+/* Wakes the generator thread up if it sleeps, after a game made room in its ring */
+void BlockGenerator::Wake() {
+	if (!this->mSleeping)
+		return;
+
+	{
+		lock_guard<mutex> lock(this->mWakeMutex);
+		this->mWakeRequested = true;
+	}
+
+	this->mWake.notify_one();
+}
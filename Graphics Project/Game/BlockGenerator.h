@@ -0,0 +1,151 @@
+#pragma once
+
+// STL Includes
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Utils/Random.h"
+#include "Level.h"
+#include "BlockGraph.h"
+
+
+// Generator constants
+const int GENERATOR_QUEUE_BLOCKS = 4;		// Blocks generated ahead for each game, beyond the blocks of its view
+const int GENERATOR_MAX_ATTEMPTS = 16;		// Blocks tried before falling back to a block without obstacles
+
+
+/*
+	Parameters of the generated blocks, the obstacles get denser with every block until the maximum density
+*/
+struct BlockDifficulty {
+	double ObstacleDensity;			// Chance of an obstacle on the ground of a cell
+	double ObstacleDensityRamp;		// Added to the obstacle density with every block
+	double MaxObstacleDensity;
+	double StackChance;				// Chance of stacking one more obstacle over another one
+	double CoinDensity;				// Chance of a coin on a free cell standing on the ground or an obstacle
+	double GemChance;				// Chance of a gem instead of a coin
+};
+
+// Default difficulty
+const BlockDifficulty BLOCK_DIFFICULTY_DEFAULT = { 0.08, 0.002, 0.22, 0.35, 0.25, 0.3 };
+
+
+/*
+	Class generating random blocks on a background thread ahead of the games playing them.
+	Every generated block is checked by a reachability search to have a path through it,
+	so a procedural level can always be survived. The blocks have the dimensions of the default tunnel.
+
+	Each game has its own channel: a single producer single consumer lock-free ring filled by the generator thread,
+	where block i of the game's seed lives in slot i of the ring. The ring keeps the blocks of the game's view
+	after they are taken, since a reset takes back the blocks beyond the observation, and holds GENERATOR_QUEUE_BLOCKS
+	more blocks ahead of them. The generator thread sleeps while all of the rings are full and a game taking a block wakes it.
+	Block i of a game only depends on the game's seed, so when the ring is empty the game generates it right away
+	and the game plays the same blocks however fast the generator thread is
+*/
+class BlockGenerator
+{
+private:
+	/*
+		A generated block of a game
+	*/
+	struct GeneratedBlock {
+		// Epoch and index of the block in the cells, packed as (epoch << 32 | index), published once the cells are written
+		atomic<unsigned long long> Tag;
+		unsigned char Cells[LEVEL_BLOCK_SIZE];
+	};
+
+	/*
+		Blocks generated ahead for a game
+	*/
+	struct Channel {
+		// Game seed and the number of times it was seeded, packed as (epoch << 32 | seed)
+		atomic<unsigned long long> Config;
+
+		// Index of the next block taken by the game
+		atomic<unsigned int> NextIndex;
+
+		// Oldest block the game may go back to, packed as (epoch << 32 | index).
+		// The generator thread fills the ring up to the blocks after it, only while it is of the epoch it generates for
+		atomic<unsigned long long> Floor;
+
+		// Ring of generated blocks, block i in slot i modulo the ring size
+		GeneratedBlock* Blocks;
+
+		// Used by the generator thread only
+		unsigned int ProducerEpoch;
+		unsigned int ProducerIndex;
+
+		// Number of blocks the game generated itself
+		atomic<unsigned long long> Misses;
+	};
+
+	BlockDifficulty mDifficulty;
+	Channel* mChannels;
+	int mChannelsCount;
+	int mViewSlices;
+	int mHistoryBlocks;						// Taken blocks a game may go back to
+	int mQueueBlocks;						// Blocks of a ring
+
+	thread mWorker;
+	atomic<bool> mStopping;
+
+	// Wakeup of the generator thread, sleeping while all of the rings are full
+	mutex mWakeMutex;
+	condition_variable mWake;
+	atomic<bool> mSleeping;
+	bool mWakeRequested;
+
+public:
+	/* Constructs a generator of the given difficulty for the given number of games, keeping up with views of the given number of slices, and starts its thread */
+	BlockGenerator(int channelsCount, int viewSlices = LANES_Z_COUNT, const BlockDifficulty& difficulty = BLOCK_DIFFICULTY_DEFAULT);
+
+	/* Stops the generator thread */
+	~BlockGenerator();
+
+	/* Returns the number of games the generator has a channel for */
+	int GetChannelsCount() const;
+
+	/* Returns the longest view, in slices, the rings are sized for */
+	int GetViewSlices() const;
+
+	/* Restarts the blocks of a game from the given seed */
+	void Seed(int channel, unsigned int seed);
+
+	/* Copies the next packed block of a game into the given buffer, never waits for the generator thread */
+	void NextBlock(int channel, unsigned char* cells);
+
+	/* Returns the index of the next block of a game */
+	unsigned int GetNextIndex(int channel) const;
+
+	/* Makes the given block of a game its next block again, with the same seed */
+	void Rewind(int channel, unsigned int index);
+
+	/* Returns the number of blocks a game had to generate itself */
+	unsigned long long GetMisses(int channel) const;
+
+	/* Generates block i of the game with the given seed into the given packed buffer */
+	void Generate(unsigned int seed, unsigned int index, unsigned char* cells) const;
+
+	/* Returns whether the character can go through the given block, ordered [z][y][x], from any ground lane of its first slice */
+	static bool IsPassable(const unsigned char items[LANES_Z_COUNT][LANES_Y_COUNT][LANES_X_COUNT]);
+
+private:
+	/* Fills the rings of all of the games until the generator is stopped */
+	void WorkerLoop();
+
+	/* Generates the next block of a game if its ring isn't full, returns false if it is */
+	bool Produce(Channel& channel);
+
+	/* Wakes the generator thread up if it sleeps, after a game made room in its ring */
+	void Wake();
+
+	BlockGenerator(const BlockGenerator&) = delete;
+	BlockGenerator& operator=(const BlockGenerator&) = delete;
+};
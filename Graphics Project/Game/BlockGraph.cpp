@@ -0,0 +1,487 @@
+#include "BlockGraph.h"
+#include "GameLogic.h"
+
+/* Returns the number of lanes on Y of the states, the character can also run on top of the grid */
+static int StateLanesY(const GridDims& dims) {
+	return dims.Y + 1;
+}
+
+/* Returns the number of lane states of a slice for each number of slices left in the air */
+static int SliceStates(const GridDims& dims) {
+	return StateLanesY(dims) * dims.X;
+}
+
+/* Returns the number of lane states followed by the graph, with jumps of GRAPH_JUMP_SLICES slices */
+static int GraphStates(const GridDims& dims) {
+	return SliceStates(dims) * (GRAPH_JUMP_SLICES + 1);
+}
+
+/*
+	The helpers below are templated on the words of the states bitmasks they work on: 1 for the grids whose states fit
+	a single word, like the default tunnel, so that their bitmasks stay in registers, or GRAPH_MAX_STATE_WORDS otherwise
+*/
+
+/* Returns the number of words of the states bitmasks of a grid of the given dimensions */
+template <int Words>
+static int StateWords(const GridDims& dims) {
+	return (Words == 1) ? 1 : BlockGraph::GetStateWords(dims);
+}
+
+/* Returns whether a state is in a states bitmask */
+template <int Words>
+static bool HasState(const unsigned long long* states, int state) {
+	int word = (Words == 1) ? 0 : state >> 6;
+	return ((states[word] >> (state & 63)) & 1) != 0;
+}
+
+/* Adds a state to a states bitmask */
+template <int Words>
+static void AddState(unsigned long long* states, int state) {
+	int word = (Words == 1) ? 0 : state >> 6;
+	states[word] |= 1ULL << (state & 63);
+}
+
+/* Returns whether there is an obstacle at the given lanes of a slice ordered [y][x], the lane on top of the grid is always free */
+static bool IsObstacle(const GridDims& dims, const unsigned char* slice, int y, int x) {
+	return y < dims.Y && slice[y * dims.X + x] == BLOCK;
+}
+
+/* Writes the lane states of the given slice that aren't inside an obstacle */
+template <int Words>
+static void FreeStates(const GridDims& dims, const unsigned char* slice, unsigned long long states[Words]) {
+	int sliceCells = dims.Y * dims.X;
+	fill(states, states + StateWords<Words>(dims), 0ULL);
+
+	for (int lanes = 0; lanes < SliceStates(dims); ++lanes) {
+		if (lanes < sliceCells && slice[lanes] == BLOCK)
+			continue;
+
+		for (int state = lanes; state < GraphStates(dims); state += SliceStates(dims)) {
+			AddState<Words>(states, state);
+		}
+	}
+}
+
+/* Returns whether the given state of the given slice leads to one of the given states of the next slice with jumps of GRAPH_JUMP_SLICES slices */
+template <int Words>
+static bool Reaches(const GridDims& dims, const unsigned char* slice, int state, const unsigned long long next[Words]) {
+	LaneMove moves[GRAPH_MAX_MOVES];
+	int count = BlockGraph::GetMoves(dims, slice, state, GRAPH_JUMP_SLICES, moves);
+	bool reaches = false;
+
+	for (int m = 0; m < count; ++m) {
+		reaches |= HasState<Words>(next, moves[m].State);
+	}
+
+	return reaches;
+}
+
+/* Writes the lane states of the next slice reachable from the given states of the given slice */
+template <int Words>
+static void Advance(const GridDims& dims, const unsigned char* slice, const unsigned long long states[Words], unsigned long long next[Words]) {
+	int words = StateWords<Words>(dims);
+	fill(next, next + words, 0ULL);
+
+	for (int w = 0; w < words; ++w) {
+		for (unsigned long long bits = states[w]; bits != 0; bits &= bits - 1) {
+			LaneMove moves[GRAPH_MAX_MOVES];
+			int count = BlockGraph::GetMoves(dims, slice, w * 64 + LowestBit(bits), GRAPH_JUMP_SLICES, moves);
+
+			for (int m = 0; m < count; ++m) {
+				AddState<Words>(next, moves[m].State);
+			}
+		}
+	}
+}
+
+/* Writes the states on the first slice of the given block from which the character can get through it */
+template <int Words>
+static void EntryStates(const GridDims& dims, const unsigned char* items, unsigned long long* states) {
+	int sliceCells = dims.Y * dims.X;
+	int words = StateWords<Words>(dims);
+
+	// Walk back from the last slice, keeping the states that lead to it
+	unsigned long long finishing[Words];
+	unsigned long long free[Words];
+	unsigned long long leading[Words];
+	FreeStates<Words>(dims, items + (dims.Z - 1) * sliceCells, finishing);
+
+	for (int z = dims.Z - 2; z >= 0; --z) {
+		const unsigned char* slice = items + z * sliceCells;
+		FreeStates<Words>(dims, slice, free);
+
+		for (int w = 0; w < words; ++w) {
+			leading[w] = 0;
+
+			for (unsigned long long bits = free[w]; bits != 0; bits &= bits - 1) {
+				if (Reaches<Words>(dims, slice, w * 64 + LowestBit(bits), finishing))
+					leading[w] |= bits & (~bits + 1);
+			}
+		}
+
+		copy(leading, leading + words, finishing);
+	}
+
+	copy(finishing, finishing + words, states);
+}
+
+/* Writes the states after the given block the character can reach from the given entry states */
+template <int Words>
+static void ExitStates(const GridDims& dims, const unsigned char* items, const unsigned long long* entryStates, unsigned long long* states) {
+	int sliceCells = dims.Y * dims.X;
+	int words = StateWords<Words>(dims);
+	unsigned long long current[Words];
+	unsigned long long free[Words];
+	unsigned long long reached[Words];
+
+	FreeStates<Words>(dims, items, free);
+	for (int w = 0; w < words; ++w) {
+		current[w] = entryStates[w] & free[w];
+	}
+
+	for (int z = 0; z + 1 < dims.Z; ++z) {
+		Advance<Words>(dims, items + z * sliceCells, current, reached);
+		FreeStates<Words>(dims, items + (z + 1) * sliceCells, free);
+
+		for (int w = 0; w < words; ++w) {
+			current[w] = reached[w] & free[w];
+		}
+	}
+
+	Advance<Words>(dims, items + (dims.Z - 1) * sliceCells, current, reached);
+	copy(reached, reached + words, states);
+}
+
+/*
+	States bitmask of a block used as a hash map key, pointing into the states of the graph
+*/
+struct StatesKey {
+	const unsigned long long* States;
+	int Words;
+
+	bool operator==(const StatesKey& other) const {
+		return equal(this->States, this->States + this->Words, other.States);
+	}
+};
+
+struct StatesKeyHash {
+	size_t operator()(const StatesKey& key) const {
+		unsigned long long hash = 14695981039346656037ULL;
+
+		for (int w = 0; w < key.Words; ++w) {
+			hash = (hash ^ key.States[w]) * 1099511628211ULL;
+		}
+
+		return (size_t)hash;
+	}
+};
+
+/* Constructs an empty graph */
+BlockGraph::BlockGraph() {
+	this->mStateWords = 0;
+	this->mDeadEnds = 0;
+}
+
+/* Analyzes all of the blocks of the given level */
+void BlockGraph::Build(const Level& level) {
+	this->Clear();
+
+	const GridDims& dims = level.GetDims();
+	int blocksCount = level.GetBlocksCount();
+	int words = GetStateWords(dims);
+	this->mStateWords = words;
+	this->mEntryStates.resize((size_t)blocksCount * words);
+	this->mExitStates.resize((size_t)blocksCount * words);
+	this->mBlockTables.resize(blocksCount);
+
+	// States of every block, reading the blocks in batches
+	int blockSize = level.GetBlockSize();
+	int sliceCells = dims.Y * dims.X;
+	vector<unsigned char> cells((size_t)GRAPH_READ_BLOCKS * blockSize);
+	vector<unsigned char> items((size_t)dims.Z * sliceCells);
+
+	for (int first = 0; first < blocksCount; first += GRAPH_READ_BLOCKS) {
+		int count = min(GRAPH_READ_BLOCKS, blocksCount - first);
+		level.CopyBlocks(first, count, &cells[0]);
+
+		for (int i = 0; i < count; ++i) {
+			for (int z = 0; z < dims.Z; ++z) {
+				Level::UnpackSlice(dims, &cells[(size_t)i * blockSize], z, &items[z * sliceCells]);
+			}
+
+			unsigned long long* entryStates = &this->mEntryStates[(size_t)(first + i) * words];
+			GetEntryStates(dims, &items[0], entryStates);
+			GetExitStates(dims, &items[0], entryStates, &this->mExitStates[(size_t)(first + i) * words]);
+		}
+	}
+
+	// Group the blocks by their entry states
+	unordered_map<StatesKey, int, StatesKeyHash> groups;
+
+	for (int b = 1; b < blocksCount; ++b) {
+		StatesKey key = { this->GetEntryStates(b), words };
+		unordered_map<StatesKey, int, StatesKeyHash>::iterator it = groups.find(key);
+
+		if (it == groups.end()) {
+			it = groups.insert(make_pair(key, (int)this->mGroupBlocks.size())).first;
+			this->mGroupStates.insert(this->mGroupStates.end(), key.States, key.States + words);
+			this->mGroupBlocks.push_back(vector<int>());
+		}
+
+		this->mGroupBlocks[it->second].push_back(b);
+	}
+
+	// One alias table for each distinct exit states
+	unordered_map<StatesKey, int, StatesKeyHash> tables;
+
+	for (int b = 0; b < blocksCount; ++b) {
+		StatesKey key = { this->GetExitStates(b), words };
+		unordered_map<StatesKey, int, StatesKeyHash>::iterator it = tables.find(key);
+
+		if (it == tables.end()) {
+			it = tables.insert(make_pair(key, (int)this->mTables.size())).first;
+			this->mTables.push_back(AliasTable());
+			this->BuildTable(key.States, this->mTables.back());
+		}
+
+		this->mBlockTables[b] = it->second;
+
+		if (!this->mTables[it->second].Compatible)
+			this->mDeadEnds++;
+	}
+}
+
+/* Removes all of the blocks */
+void BlockGraph::Clear() {
+	this->mEntryStates.clear();
+	this->mExitStates.clear();
+	this->mGroupStates.clear();
+	this->mGroupBlocks.clear();
+	this->mTables.clear();
+	this->mBlockTables.clear();
+	this->mStateWords = 0;
+	this->mDeadEnds = 0;
+}
+
+/* Returns a random legal successor of the given block, or any random block if there is none */
+int BlockGraph::PickNext(int block, Random& random) const {
+	const AliasTable& table = this->mTables[this->mBlockTables[block]];
+
+	// The level has only the initial block
+	if (table.Groups.empty())
+		return 0;
+
+	int i = random.NextInt((int)table.Groups.size());
+	if (random.Next() >= table.Threshold[i])
+		i = table.Alias[i];
+
+	const vector<int>& blocks = this->mGroupBlocks[table.Groups[i]];
+	return blocks[random.NextInt((int)blocks.size())];
+}
+
+/* Returns the number of words of the states bitmasks */
+int BlockGraph::GetStateWords() const {
+	return this->mStateWords;
+}
+
+/* Returns the entry states bitmask of a block */
+const unsigned long long* BlockGraph::GetEntryStates(int block) const {
+	return &this->mEntryStates[(size_t)block * this->mStateWords];
+}
+
+/* Returns the exit states bitmask of a block */
+const unsigned long long* BlockGraph::GetExitStates(int block) const {
+	return &this->mExitStates[(size_t)block * this->mStateWords];
+}
+
+/* Returns whether the character can get through a block from any state */
+bool BlockGraph::IsPassable(int block) const {
+	const unsigned long long* entryStates = this->GetEntryStates(block);
+
+	for (int w = 0; w < this->mStateWords; ++w) {
+		if (entryStates[w] != 0)
+			return true;
+	}
+
+	return false;
+}
+
+/* Returns whether the second block can follow the first one */
+bool BlockGraph::IsCompatible(int block, int next) const {
+	const unsigned long long* exitStates = this->GetExitStates(block);
+	const unsigned long long* entryStates = this->GetEntryStates(next);
+
+	for (int w = 0; w < this->mStateWords; ++w) {
+		if ((exitStates[w] & entryStates[w]) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+/* Returns the number of blocks without a legal successor */
+int BlockGraph::GetDeadEnds() const {
+	return this->mDeadEnds;
+}
+
+/* Returns the number of words of the states bitmasks of a grid of the given dimensions */
+int BlockGraph::GetStateWords(const GridDims& dims) {
+	return (GraphStates(dims) + 63) / 64;
+}
+
+/* Returns the number of slices a jump stays a lane up at the given camera speed, up to GRAPH_MAX_JUMP_SLICES */
+int BlockGraph::GetJumpSlices(double speed) {
+	double airTime = 2 * JUMP_SPEED / JUMP_ACCELERATION;
+	int slices = (int)ceil(speed * airTime / LANE_DEPTH - 1e-9);
+
+	return max(1, min(GRAPH_MAX_JUMP_SLICES, slices));
+}
+
+/* Returns the number of lane states of a grid of the given dimensions with jumps of the given slices */
+int BlockGraph::GetStatesCount(const GridDims& dims, int jumpSlices) {
+	return SliceStates(dims) * (jumpSlices + 1);
+}
+
+/* Returns the lanes (y * X + x) of a lane state, y being X for the lane on top of the grid */
+int BlockGraph::GetStateLanes(const GridDims& dims, int state) {
+	return state % SliceStates(dims);
+}
+
+/* Returns whether a lane state is outside of the obstacles of the given slice */
+bool BlockGraph::IsFree(const GridDims& dims, const unsigned char* slice, int state) {
+	int lanes = state % SliceStates(dims);
+	return !IsObstacle(dims, slice, lanes / dims.X, lanes % dims.X);
+}
+
+/* Writes the moves from the given state of the given slice with jumps of the given slices, returns their number */
+int BlockGraph::GetMoves(const GridDims& dims, const unsigned char* slice, int state, int jumpSlices, LaneMove moves[GRAPH_MAX_MOVES]) {
+	int air = state / SliceStates(dims);
+	int y = (state % SliceStates(dims)) / dims.X;
+	int x = state % dims.X;
+	int count = 0;
+
+	bool supported = (y == 0 || IsObstacle(dims, slice, y - 1, x));
+
+	// Landing ends the jump
+	if (supported)
+		air = 0;
+
+	// Fall a lane
+	if (air == 0 && !supported) {
+		moves[count].State = (y - 1) * dims.X + x;
+		moves[count++].Input = false;
+		return count;
+	}
+
+	// Go forward or step aside
+	for (int dx = -1; dx <= 1; ++dx) {
+		int nx = x + dx;
+
+		if (nx >= 0 && nx < dims.X && !IsObstacle(dims, slice, y, nx)) {
+			moves[count].State = (max(0, air - 1) * StateLanesY(dims) + y) * dims.X + nx;
+			moves[count++].Input = (dx != 0);
+		}
+	}
+
+	// Jump a lane up
+	if (air == 0 && y + 1 < StateLanesY(dims) && !IsObstacle(dims, slice, y + 1, x)) {
+		moves[count].State = (jumpSlices * StateLanesY(dims) + y + 1) * dims.X + x;
+		moves[count++].Input = true;
+	}
+
+	return count;
+}
+
+/* Returns the states of the ground lanes of a grid of the given dimensions */
+unsigned long long BlockGraph::GetGroundStates(const GridDims& dims) {
+	return (dims.X < 64) ? (1ULL << dims.X) - 1 : ~0ULL;
+}
+
+/* Writes the states on the first slice of the given block from which the character can get through it */
+void BlockGraph::GetEntryStates(const GridDims& dims, const unsigned char* items, unsigned long long states[]) {
+	if (GetStateWords(dims) == 1)
+		EntryStates<1>(dims, items, states);
+	else
+		EntryStates<GRAPH_MAX_STATE_WORDS>(dims, items, states);
+}
+
+/* Writes the states after the given block the character can reach from the given entry states */
+void BlockGraph::GetExitStates(const GridDims& dims, const unsigned char* items, const unsigned long long entryStates[], unsigned long long states[]) {
+	if (GetStateWords(dims) == 1)
+		ExitStates<1>(dims, items, entryStates, states);
+	else
+		ExitStates<GRAPH_MAX_STATE_WORDS>(dims, items, entryStates, states);
+}
+
+/* Builds the alias table of the groups that can follow the given exit states */
+void BlockGraph::BuildTable(const unsigned long long* exitStates, AliasTable& table) const {
+	int groupsCount = (int)this->mGroupBlocks.size();
+	int words = this->mStateWords;
+	const unsigned long long* groupStates = this->mGroupStates.data();
+	vector<unsigned long long> weights;
+
+	// Groups sharing states with the exit states, weighted by their number of blocks and shared states
+	for (int g = 0; g < groupsCount; ++g, groupStates += words) {
+		int shared = PopCount(exitStates[0] & groupStates[0]);
+
+		for (int w = 1; w < words; ++w) {
+			shared += PopCount(exitStates[w] & groupStates[w]);
+		}
+
+		if (shared > 0) {
+			table.Groups.push_back(g);
+			weights.push_back(this->mGroupBlocks[g].size() * shared);
+		}
+	}
+
+	table.Compatible = !table.Groups.empty();
+
+	// Otherwise all of the groups, weighted by their number of blocks
+	if (!table.Compatible) {
+		for (int g = 0; g < groupsCount; ++g) {
+			table.Groups.push_back(g);
+			weights.push_back(this->mGroupBlocks[g].size());
+		}
+	}
+
+	// Vose's alias method, the weights are scaled so that their average is the total weight
+	int n = (int)table.Groups.size();
+	unsigned long long totalWeight = 0;
+	vector<int> small, large;
+
+	for (int i = 0; i < n; ++i) {
+		totalWeight += weights[i];
+	}
+
+	for (int i = 0; i < n; ++i) {
+		weights[i] *= n;
+
+		if (weights[i] < totalWeight)
+			small.push_back(i);
+		else
+			large.push_back(i);
+	}
+
+	table.Threshold.assign(n, 1ULL << 32);
+	table.Alias.resize(n);
+
+	for (int i = 0; i < n; ++i) {
+		table.Alias[i] = i;
+	}
+
+	while (!small.empty() && !large.empty()) {
+		int s = small.back();
+		int l = large.back();
+		small.pop_back();
+
+		table.Threshold[s] = (weights[s] << 32) / totalWeight;
+		table.Alias[s] = l;
+
+		weights[l] = weights[l] + weights[s] - totalWeight;
+
+		if (weights[l] < totalWeight) {
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+}
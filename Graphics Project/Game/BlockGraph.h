@@ -0,0 +1,140 @@
+#pragma once
+
+// STL Includes
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Utils/Random.h"
+#include "../Utils/Bits.h"
+#include "Level.h"
+
+
+// Block graph constants
+const int GRAPH_JUMP_SLICES = 2;				// Slices a jump stays a lane up at the slowest speed, GetJumpSlices(CAMERA_SPEED_INIT)
+const int GRAPH_MAX_JUMP_SLICES = 15;			// Longest jump the lane moves are followed for
+const int GRAPH_MAX_MOVES = 4;					// Moves from a lane state: going forward, stepping aside either way and jumping
+const int GRAPH_READ_BLOCKS = 1024;				// Blocks read at once while analyzing a level
+const int GRAPH_MAX_STATE_WORDS = ((LANES_Y_MAX + 1) * LANES_X_MAX * (GRAPH_JUMP_SLICES + 1) + 63) / 64;	// Words of the states bitmask of the largest grid
+
+
+/*
+	A move of the character from a lane state to a lane state of the next slice
+*/
+struct LaneMove {
+	int State;
+	bool Input;			// Whether a key must be pressed
+};
+
+
+/*
+	Class holding which blocks of a level can follow each other.
+
+	A lane state is the lanes of the character and the slices it has left in the air after a jump, the character
+	can also run on top of the grid so the state (x, y, air) is the bit ((air * (Y + 1) + y) * X + x) of a states bitmask,
+	made of as many 64-bit words as the grid needs, a single one for the default tunnel.
+	Every block is analyzed once when the level is loaded: its entry states are the states on its first slice
+	from which the character can get through the block, and its exit states are the states on the following slice
+	the character can reach coming from the entry states.
+	A block can follow another one if they share a state at their seam, and is more likely to the more states they share.
+
+	The blocks are grouped by their entry states, and each distinct exit states bitmask has an alias table
+	over the groups it can be followed by, weighted by their number of blocks and shared states, so picking a legal
+	next block is three random numbers whatever the number of blocks. Block 0 is the initial block and is never picked
+*/
+class BlockGraph
+{
+private:
+	/*
+		Walker alias table picking one of its entries with the probability of its weight
+	*/
+	struct AliasTable {
+		vector<unsigned long long> Threshold;	// Keep the drawn entry if the next random number is below it
+		vector<int> Alias;						// Entry taken otherwise
+		vector<int> Groups;						// Group of each entry
+		bool Compatible;						// Whether the groups can follow the exit states, or are all of the groups
+	};
+
+	// States of every block, mStateWords words each
+	int mStateWords;
+	vector<unsigned long long> mEntryStates;
+	vector<unsigned long long> mExitStates;
+
+	// Blocks grouped by their entry states, except for the initial block
+	vector<unsigned long long> mGroupStates;
+	vector<vector<int>> mGroupBlocks;
+
+	// Successors of every block
+	vector<AliasTable> mTables;
+	vector<int> mBlockTables;				// Alias table of each block's exit states
+	int mDeadEnds;							// Blocks without a legal successor
+
+public:
+	/* Constructs an empty graph */
+	BlockGraph();
+
+	/* Analyzes all of the blocks of the given level */
+	void Build(const Level& level);
+
+	/* Removes all of the blocks */
+	void Clear();
+
+	/* Returns a random legal successor of the given block, or any random block if there is none */
+	int PickNext(int block, Random& random) const;
+
+	/* Returns the number of words of the states bitmasks */
+	int GetStateWords() const;
+
+	/* Returns the entry states bitmask of a block, of GetStateWords() words */
+	const unsigned long long* GetEntryStates(int block) const;
+
+	/* Returns the exit states bitmask of a block, of GetStateWords() words */
+	const unsigned long long* GetExitStates(int block) const;
+
+	/* Returns whether the character can get through a block from any state */
+	bool IsPassable(int block) const;
+
+	/* Returns whether the second block can follow the first one */
+	bool IsCompatible(int block, int next) const;
+
+	/* Returns the number of blocks without a legal successor */
+	int GetDeadEnds() const;
+
+	/* Returns the number of words of the states bitmasks of a grid of the given dimensions, up to GRAPH_MAX_STATE_WORDS */
+	static int GetStateWords(const GridDims& dims);
+
+	/* Returns the number of slices a jump stays a lane up at the given camera speed, up to GRAPH_MAX_JUMP_SLICES */
+	static int GetJumpSlices(double speed);
+
+	/* Returns the number of lane states of a grid of the given dimensions with jumps of the given slices */
+	static int GetStatesCount(const GridDims& dims, int jumpSlices);
+
+	/* Returns the lanes (y * X + x) of a lane state, y being X for the lane on top of the grid */
+	static int GetStateLanes(const GridDims& dims, int state);
+
+	/* Returns whether a lane state is outside of the obstacles of the given slice, ordered [y][x] */
+	static bool IsFree(const GridDims& dims, const unsigned char* slice, int state);
+
+	/*
+		Writes the moves from the given state of the given slice, ordered [y][x], with jumps of the given slices, returns their number.
+		The character goes forward or steps aside, jumps a lane up for the jump slices, lands on obstacles
+		and falls a lane per slice when nothing is below. The obstacles of the next slice aren't checked
+	*/
+	static int GetMoves(const GridDims& dims, const unsigned char* slice, int state, int jumpSlices, LaneMove moves[GRAPH_MAX_MOVES]);
+
+	/* Returns the states of the ground lanes of a grid of the given dimensions, they all are in the first word of a states bitmask */
+	static unsigned long long GetGroundStates(const GridDims& dims);
+
+	/* Writes the states on the first slice of the given block, ordered [z][y][x], from which the character can get through it */
+	static void GetEntryStates(const GridDims& dims, const unsigned char* items, unsigned long long states[]);
+
+	/* Writes the states after the given block, ordered [z][y][x], the character can reach from the given entry states */
+	static void GetExitStates(const GridDims& dims, const unsigned char* items, const unsigned long long entryStates[], unsigned long long states[]);
+
+private:
+	/* Builds the alias table of the groups that can follow the given exit states */
+	void BuildTable(const unsigned long long* exitStates, AliasTable& table) const;
+};
@@ -1,35 +1,111 @@
 #include "Game.h"
 
+/* Returns the index of the model drawing the given item, in the order of the models of Game::RenderItems */
+static int ItemModel(GameItem type) {
+	switch (type)
+	{
+	case BLOCK:
+		return 0;
+	case COIN:
+		return 1;
+	case GEM_DOUBLE_SCORE:
+		return 2;
+	case GEM_SPEED:
+		return 3;
+	default:
+		return 4;
+	}
+}
+
+/* Extracts the planes (a, b, c, d) of the frustum of the given view projection matrix, a point is inside when a * x + b * y + c * z + d >= 0 */
+static void FrustumPlanes(const glm::mat4& matrix, float planes[6][4]) {
+	// The matrix is column major, a plane is the sum or difference of its last row and one of the others
+	const float* m = glm::value_ptr(matrix);
+
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			planes[2 * i][j] = m[j * 4 + 3] + m[j * 4 + i];
+			planes[2 * i + 1][j] = m[j * 4 + 3] - m[j * 4 + i];
+		}
+	}
+}
+
+/* Returns whether the given box is at least partly inside all of the frustum planes */
+static bool IsBoxVisible(const float planes[6][4], const float boxMin[3], const float boxMax[3]) {
+	for (int i = 0; i < 6; ++i) {
+		// The corner of the box furthest along the plane normal
+		float distance = planes[i][3];
+
+		for (int j = 0; j < 3; ++j) {
+			distance += planes[i][j] * (planes[i][j] >= 0 ? boxMax[j] : boxMin[j]);
+		}
+
+		if (distance < 0)
+			return false;
+	}
+
+	return true;
+}
+
 /* Constructs a new game with all related objects and components */
 Game::Game(GameEngine* engine, const char* title) {
 	this->mEngine = engine;
 	this->mEngine->RegisterGame(this, title);
 	this->mGameTitle = title;
 
-	srand(time(NULL));
+	this->mInputHeld = 0;
+	this->mInputLatched = 0;
+	this->mScreenshotKeyHeld = false;
+	this->mAntiAliasingKeyHeld = false;
+
+	this->mSeed = (unsigned int)time(NULL);
+	this->mViewSlices = 0;
+	this->mGenerator = NULL;
+	this->mRecording = NULL;
+	this->mReplay = NULL;
+	this->mReplayTick = 0;
+	this->mSnapshots = new TripleBuffer<FrameSnapshot>();
+	this->mRendered = NULL;
+	memset(&this->mSummary, 0, sizeof(this->mSummary));
 
 	InitSounds();
 	InitCamera();
 	InitShaders();
-	InitGameBlocks();
+	InitGameLogic();
 	InitModels();
+	InitChunks();
 	InitLightSources();
 	InitTextRenderers();
+	InitOverlay();
 
-	ResetGame();
+	PublishSnapshot();
 }
 
 /* Destructs the game and free resources */
 Game::~Game() {
+	// Save and destroy the session recording
+	if (this->mRecording != NULL) {
+		this->mRecording->Save(this->mRecordingPath);
+		delete this->mRecording;
+	}
+
+	delete this->mReplay;
+
 	// Destroy engines
 	delete this->mSoundEngine;
 
+	// Destroy game logic
+	delete this->mLogic;
+	delete this->mGenerator;
+	delete this->mLevel;
+
 	// Destroy camera
 	delete this->mCamera;
 
 	// Destroy shaders
 	delete this->mShader;
 	delete this->mTextShader;
+	delete this->mGraphShader;
 
 	// Destroy models
 	delete this->mScene;
@@ -39,175 +115,417 @@ Game::~Game() {
 	delete this->mGemSpeed;
 	delete this->mGemCrazy;
 
+	// Destroy chunk instances
+	for (int i = 0; i < VIEW_CHUNKS_MAX; ++i) {
+		glDeleteBuffers(1, &this->mChunks[i].Buffer);
+		RenderStats::AddGpuMemory(GPU_MEMORY_INSTANCES, -this->mChunks[i].BufferBytes);
+	}
+
+	delete this->mSnapshots;
+
 	// Destroy light sources
 	delete this->mLight;
 
 	// Destroy text renderers
+	delete this->mOverlay;
 	delete this->mTextRenderer;
 }
 
 /* Returns the current game state */
 GameState Game::GetGameState() const {
-	return this->mGameState;
+	return this->mLogic->GetGameState();
 }
 
-/* Receives user input and processes it for the next frame */
-void Game::ProcessInput() {
-	this->ProcessKeyInput();
-	//this->ProcessMouseInput();
-}
+/* Plays procedurally generated blocks after the level's initial block, or the level's blocks, and restarts the game */
+void Game::SetProceduralBlocks(bool procedural) {
+	if (procedural == (this->mGenerator != NULL))
+		return;
 
-/* Updates objects' information needed to apply effects on the next frame  */
-void Game::Update() {
-	// Update music
-	if (!this->mSoundEngine->isCurrentlyPlaying(BACKGROUND_MUSIC[this->mMusicIdx].c_str())) {
-		this->mMusicIdx = (this->mMusicIdx + 1) % BACKGROUND_MUSIC_COUNT;
-		this->mSoundEngine->play2D(BACKGROUND_MUSIC[this->mMusicIdx].c_str());
-	}
+	// The view distance can change while the generator is kept, so its ring fits the longest one
+	BlockGenerator* generator = procedural ? new BlockGenerator(1, VIEW_SLICES_MAX) : NULL;
+	this->mLogic->SetGenerator(generator);
+	this->mLogic->Seed(this->mSeed);
 
-	// Return if game is not running
-	if (this->mGameState != RUNNING)
+	delete this->mGenerator;
+	this->mGenerator = generator;
+
+	if (this->mRecording != NULL)
+		this->mRecording->SetFlags(procedural ? REPLAY_FLAG_PROCEDURAL : 0);
+
+	this->PublishSnapshot();
+}
+
+/* Keeps and draws the given number of slices ahead, or a block length if 0, and restarts the game */
+void Game::SetViewSlices(int viewSlices) {
+	if (viewSlices == this->mViewSlices)
 		return;
 
-	// Update runnning game time
-	this->mGameTime += this->mEngine->mTimer->ElapsedFramesTime;
+	GameLogic* logic = new GameLogic(this->mLevel, this->mSeed, viewSlices);
+	logic->SetGenerator(this->mGenerator);
+	logic->Seed(this->mSeed);
 
-	// Removes the double score effect after certain amount of time
-	if (this->mDoubleScore) {
-		this->mDoubleScoreTime += this->mEngine->mTimer->ElapsedFramesTime;
+	delete this->mLogic;
+	this->mLogic = logic;
+	this->mViewSlices = viewSlices;
 
-		if (this->mDoubleScoreTime >= DOUBLE_SCORE_DURATION) {
-			this->mDoubleScore = false;
-			this->mCoinValue /= 2;
-		}
+	this->PublishSnapshot();
+}
+
+/* Shows or hides the performance overlay, also toggled with F3 */
+void Game::SetOverlayVisible(bool visible) {
+	this->mOverlay->SetVisible(visible);
+}
+
+/* Records the inputs of the session to be saved into the given file when the game ends */
+void Game::StartRecording(const string& path) {
+	delete this->mRecording;
+	this->mRecording = new Replay(this->mSeed, SIMULATION_TICK_RATE, this->mGenerator != NULL ? REPLAY_FLAG_PROCEDURAL : 0);
+	this->mRecordingPath = path;
+}
+
+/* Replays the session saved in the given file instead of the user input, returns false on failure */
+bool Game::StartReplay(const string& path) {
+	Replay* replay = new Replay();
+
+	if (!replay->Load(path)) {
+		delete replay;
+		return false;
 	}
 
-	// Removes the increase speed effect after certain amount of time
-	if (this->mIncreaseSpeed) {
-		this->mIncreaseSpeedTime += this->mEngine->mTimer->ElapsedFramesTime;
+	this->StartReplay(replay);
+	return true;
+}
 
-		if (this->mIncreaseSpeedTime >= INCREASE_SPEED_DURATION) {
-			this->mIncreaseSpeed = false;
-			this->mCamera->SetMoveSpeed(this->mCamera->GetCameraSpeed() / INCREASE_SPEED_FACTOR);
-		}
+/* Replays the given session instead of the user input, the game takes ownership of the replay */
+void Game::StartReplay(Replay* replay) {
+	if (replay->GetTickRate() != SIMULATION_TICK_RATE) {
+		std::cout << "GAME::WARNING: Replay recorded at " << replay->GetTickRate() << " ticks/s is played with its own time step" << std::endl;
 	}
 
-	// Update extra coins time
-	if (this->mExtraScore) {
-		this->mExtraScoreTime += this->mEngine->mTimer->ElapsedFramesTime;
+	delete this->mReplay;
+	this->mReplay = replay;
+	this->mReplayTick = 0;
 
-		if (this->mExtraScoreTime >= EXTRA_SCORE_DURATION) {
-			this->mExtraScore = false;
-		}
+	// Restart the game from the recorded seed in the recorded mode
+	this->mSeed = replay->GetSeed();
+	this->SetProceduralBlocks((replay->GetFlags() & REPLAY_FLAG_PROCEDURAL) != 0);
+	this->mLogic->Seed(this->mSeed);
+	this->mHighScore = this->ReadHighScore();
+	this->PublishSnapshot();
+}
+
+/* Returns whether a replay is being played and has ticks left */
+bool Game::IsReplaying() const {
+	return this->mReplay != NULL && this->mReplayTick < this->mReplay->GetTicksCount();
+}
+
+/* Polls user input to be consumed by the next simulation tick (rendering thread) */
+void Game::ProcessInput() {
+	unsigned int input = 0;
+
+	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_A) == GLFW_PRESS)
+		input |= INPUT_LEFT;
+	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_D) == GLFW_PRESS)
+		input |= INPUT_RIGHT;
+	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_SPACE) == GLFW_PRESS)
+		input |= INPUT_JUMP;
+	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		input |= INPUT_PAUSE;
+	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_Q) == GLFW_PRESS)
+		input |= INPUT_QUIT;
+	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_R) == GLFW_PRESS)
+		input |= INPUT_REPLAY;
+
+	// The overlay is toggled once per press, on the rendering thread only
+	bool overlayKey = glfwGetKey(this->mEngine->mWind, GLFW_KEY_F3) == GLFW_PRESS;
+
+	if (overlayKey && !this->mOverlayKeyHeld)
+		this->mOverlay->SetVisible(!this->mOverlay->IsVisible());
+
+	this->mOverlayKeyHeld = overlayKey;
+
+	// Likewise a single screenshot per press
+	bool screenshotKey = glfwGetKey(this->mEngine->mWind, GLFW_KEY_F12) == GLFW_PRESS;
+
+	if (screenshotKey && !this->mScreenshotKeyHeld)
+		this->mEngine->TakeScreenshot();
+
+	this->mScreenshotKeyHeld = screenshotKey;
+
+	// And the next supported anti-aliasing mode per press
+	bool antiAliasingKey = glfwGetKey(this->mEngine->mWind, GLFW_KEY_F4) == GLFW_PRESS;
+
+	if (antiAliasingKey && !this->mAntiAliasingKeyHeld) {
+		AntiAliasing next = this->mEngine->GetAntiAliasing();
+
+		do {
+			next = (AntiAliasing)((next + 1) % AA_MODES);
+		} while (!SceneTarget::IsSupported(next));
+
+		this->mEngine->SetAntiAliasing(next);
 	}
 
-	// Update reversed directions effect
-	if (this->mDirectionsReversed) {
-		this->mDirectionsReversedTime += this->mEngine->mTimer->ElapsedFramesTime;
+	this->mAntiAliasingKeyHeld = antiAliasingKey;
 
-		if (this->mDirectionsReversedTime >= DIRECTIONS_REVERSED_DURATION) {
-			this->mDirectionsReversed = false;
-			this->mLight->SpecularColor = glm::vec3(1.0f, 1.0f, 1.0f);
-			this->mLight->DiffuseColor = this->mLight->SpecularColor * 0.9f;
-			this->mLight->AmbientColor = this->mLight->SpecularColor * 0.3f;
-		}
+	// Latch the pressed keys so short presses between two ticks are not lost
+	this->mInputHeld.store(input, memory_order_relaxed);
+	this->mInputLatched.fetch_or(input, memory_order_relaxed);
+	//this->ProcessMouseInput();
+}
+
+/* Advances the game logic by the given time step and publishes a new snapshot (simulation thread) */
+void Game::Update(double deltaTime) {
+	PROFILE_SCOPE("Game::Update");
+
+	// Consume the input polled since the last tick
+	unsigned int input = this->mInputHeld.load(memory_order_relaxed) | this->mInputLatched.exchange(0, memory_order_relaxed);
+
+	// Replay the recorded input with the recorded time step until the replay ends
+	if (this->IsReplaying()) {
+		input = this->mReplay->GetInput(this->mReplayTick++);
+		deltaTime = this->mReplay->GetTickTime();
+	}
+
+	if (this->mRecording != NULL) {
+		this->mRecording->Record(input);
+	}
+
+	// Step the game logic
+	this->ProcessEvents(this->mLogic->Step(input, deltaTime));
+
+	// Update music
+	if (this->mSoundEngine != NULL && !this->mSoundEngine->isCurrentlyPlaying(BACKGROUND_MUSIC[this->mMusicIdx].c_str())) {
+		this->mMusicIdx = (this->mMusicIdx + 1) % BACKGROUND_MUSIC_COUNT;
+		this->mSoundEngine->play2D(BACKGROUND_MUSIC[this->mMusicIdx].c_str());
 	}
 
-	// Update camera to give animation effects
-	this->mCamera->MoveStep(FORWARD, LANE_DEPTH);
-	this->mCamera->Update(this->mEngine->mTimer->ElapsedFramesTime);
+	// Hand the new state to the renderer
+	this->PublishSnapshot();
+}
+
+/* Renders the 3D scene of the last published snapshot (rendering thread) */
+void Game::RenderScene() {
+	PROFILE_SCOPE("Game::RenderScene");
+	this->mRendered = &this->mSnapshots->Read();
+	const FrameSnapshot& snapshot = *this->mRendered;
+
+	// Move the camera to the simulated position
+	this->mCamera->SetPosition(glm::vec3(snapshot.CameraX, snapshot.CameraY, snapshot.CameraZ));
 
 	// Update light sources
-	if (this->mDirectionsReversed) {
-		double r = abs(sin(this->mGameTime) / 2.0f) + 0.5f;
-		double g = abs(cos(this->mGameTime) / 2.0f) + 0.5f;
-		double b = 1.0f;// abs(tan(this->mGameTime) / 2.0f) + 0.5f;
+	if (snapshot.DirectionsReversed) {
+		double r = abs(sin(snapshot.GameTime) / 2.0f) + 0.5f;
+		double g = abs(cos(snapshot.GameTime) / 2.0f) + 0.5f;
+		double b = 1.0f;// abs(tan(snapshot.GameTime) / 2.0f) + 0.5f;
 		this->mLight->SpecularColor = glm::vec3(r, g, b);
-		this->mLight->DiffuseColor = this->mLight->SpecularColor * 0.9f;
-		this->mLight->AmbientColor = this->mLight->SpecularColor * 0.3f;
 	}
-	
+	else {
+		this->mLight->SpecularColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	}
+
+	this->mLight->DiffuseColor = this->mLight->SpecularColor * 0.9f;
+	this->mLight->AmbientColor = this->mLight->SpecularColor * 0.3f;
 	this->mLight->Position = this->mCamera->GetPosition();
 	this->mLight->Position -= this->mCamera->GetFront();
 
-	// Move the scene with the camera to make it feel infinite
-	this->mScene->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.5 * SCENE_HEIGHT, this->mCamera->GetPosition().z - CAMERA_POSITION_INIT.z - 0.5 * SCENE_DEPTH));
-	this->mScene->ModelMatrix = glm::scale(this->mScene->ModelMatrix, glm::vec3(SCENE_WIDTH, SCENE_HEIGHT, SCENE_DEPTH));
+	// Move the scene with the camera to make it feel infinite, as deep as the view
+	double sceneWidth = snapshot.Dims.X * LANE_WIDTH;
+	double sceneHeight = snapshot.Dims.Y * LANE_HEIGHT + SCENE_EXTRA_HEIGHT;
+	double sceneDepth = snapshot.ViewSlices * LANE_DEPTH;
 
-	// Detect collisions
-	this->DetectCollision(this->mCamera->GetPosition() - CAMERA_POSITION_INIT);
+	this->mScene->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.5 * sceneHeight, snapshot.CameraZ - CAMERA_POSITION_INIT.z - 0.5 * sceneDepth));
+	this->mScene->ModelMatrix = glm::scale(this->mScene->ModelMatrix, glm::vec3(sceneWidth, sceneHeight, sceneDepth));
 
-	// Update the scene items to be rendered
-	this->GenerateSceneItems();
-}
+	// See the whole look-ahead
+	this->mCamera->SetFarPlane(max(FAR_PLANE, sceneDepth + CHARACTER_OFFSET));
 
-/* Renders the new frame */
-void Game::Render() {
 	// Apply effect to the shader
 	this->mShader->Use();
 	this->mCamera->ApplyEffects(*mShader);
 	this->mLight->ApplyEffects(*mShader);
 
 	// Draw the scene
-	this->mScene->Draw(*this->mShader);
+	{
+		PROFILE_GPU_SCOPE(this->mEngine->mGpuTimer, "GPU::Scene");
+		this->mScene->Draw(*this->mShader);
+	}
 
 	// Draw game items
-	for (int y = 0; y < LANES_Y_COUNT; ++y) {
-		for (int x = 0; x < LANES_X_COUNT; ++x) {
-			for (int z = 0; z < this->mGrid[y][x].size(); ++z) {
-				GameItem cell = this->mGrid[y][x].front();
-				this->mGrid[y][x].pop_front();
-				this->mGrid[y][x].push_back(cell);
-
-				switch (cell)
-				{
-				case BLOCK:
-					this->mCube->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3((x - LANES_X_COUNT / 2) * LANE_WIDTH, 0.5f * CUBE_HEIGHT + y * LANE_HEIGHT, -(z + mGridIndexZ) * LANE_DEPTH));
-					this->mCube->ModelMatrix = glm::scale(this->mCube->ModelMatrix, glm::vec3(CUBE_WIDTH, CUBE_HEIGHT, CUBE_DEPTH));
-					this->mCube->Draw(*this->mShader);
-					break;
-				case COIN:
-					this->mCoin->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3((x - LANES_X_COUNT / 2) * LANE_WIDTH, COIN_SIZE + y * LANE_HEIGHT, -(z + mGridIndexZ) * LANE_DEPTH));
-					this->mCoin->ModelMatrix = glm::scale(this->mCoin->ModelMatrix, glm::vec3(COIN_SIZE, COIN_SIZE, COIN_SIZE));
-					this->mCoin->ModelMatrix = glm::rotate(this->mCoin->ModelMatrix, (float)this->mEngine->mTimer->CurrentFrameTime, glm::vec3(0.0f, 1.0f, 0.0f));
-					this->mCoin->Draw(*this->mShader);
-					break;
-				case GEM_DOUBLE_SCORE:
-					this->mGemScore->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3((x - LANES_X_COUNT / 2) * LANE_WIDTH, GEM_SIZE + y * LANE_HEIGHT, -(z + mGridIndexZ) * LANE_DEPTH));
-					this->mGemScore->ModelMatrix = glm::scale(this->mGemScore->ModelMatrix, glm::vec3(GEM_SIZE, GEM_SIZE, GEM_SIZE));
-					this->mGemScore->ModelMatrix = glm::rotate(this->mGemScore->ModelMatrix, (float)this->mEngine->mTimer->CurrentFrameTime, glm::vec3(0.0f, 1.0f, 0.0f));
-					this->mGemScore->Draw(*this->mShader);
-					break;
-				case GEM_SPEED:
-					this->mGemSpeed->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3((x - LANES_X_COUNT / 2) * LANE_WIDTH, GEM_SIZE + y * LANE_HEIGHT, -(z + mGridIndexZ) * LANE_DEPTH));
-					this->mGemSpeed->ModelMatrix = glm::scale(this->mGemSpeed->ModelMatrix, glm::vec3(GEM_SIZE, GEM_SIZE, GEM_SIZE));
-					this->mGemSpeed->ModelMatrix = glm::rotate(this->mGemSpeed->ModelMatrix, (float)this->mEngine->mTimer->CurrentFrameTime, glm::vec3(0.0f, 1.0f, 0.0f));
-					this->mGemSpeed->Draw(*this->mShader);
-					break;
-				case GEM_EXTRA_SCORE:
-				case GEM_REVERSED_MODE:
-					this->mGemCrazy->ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3((x - LANES_X_COUNT / 2) * LANE_WIDTH, GEM_SIZE + y * LANE_HEIGHT, -(z + mGridIndexZ) * LANE_DEPTH));
-					this->mGemCrazy->ModelMatrix = glm::scale(this->mGemCrazy->ModelMatrix, glm::vec3(GEM_SIZE, GEM_SIZE, GEM_SIZE));
-					this->mGemCrazy->ModelMatrix = glm::rotate(this->mGemCrazy->ModelMatrix, (float)this->mEngine->mTimer->CurrentFrameTime, glm::vec3(0.0f, 1.0f, 0.0f));
-					this->mGemCrazy->Draw(*this->mShader);
-					break;
-				}
-			}
-		}
+	{
+		PROFILE_GPU_SCOPE(this->mEngine->mGpuTimer, "GPU::Items");
+		this->RenderItems(snapshot);
 	}
+}
+
+/* Renders the game information and the overlay of the snapshot of the scene, over it at the frame's resolution (rendering thread) */
+void Game::RenderHud() {
+	PROFILE_SCOPE("Game::RenderHud");
+	const FrameSnapshot& snapshot = *this->mRendered;
 
 	// Draw game information
-	this->RenderText();
+	{
+		PROFILE_GPU_SCOPE(this->mEngine->mGpuTimer, "GPU::Text");
+		this->RenderText(snapshot);
+	}
+
+	// Draw the performance overlay
+	if (this->mOverlay->IsVisible()) {
+		PROFILE_GPU_SCOPE(this->mEngine->mGpuTimer, "GPU::Overlay");
+		this->mOverlay->AddFrame(this->mEngine->mTimer->ElapsedFramesTime);
+		this->mOverlay->Render(this->mEngine->mTimer->CurrentFrameTime);
+	}
+}
+
+/* Describes the input and the last published game state as name and value pairs (any thread) */
+void Game::DescribeState(vector<pair<string, string>>& fields) {
+	const char* keys[REPLAY_INPUT_BITS] = { "LEFT", "RIGHT", "JUMP", "PAUSE", "QUIT", "REPLAY" };
+	const char* states[] = { "RUNNING", "PAUSED", "LOST" };
+	unsigned int input = this->mInputHeld.load(memory_order_relaxed);
+	string held;
+
+	for (int i = 0; i < REPLAY_INPUT_BITS; ++i) {
+		if (input & (1 << i))
+			held += (held.empty() ? "" : " ") + string(keys[i]);
+	}
+
+	GameSummary summary;
+	{
+		lock_guard<mutex> lock(this->mSummaryMutex);
+		summary = this->mSummary;
+	}
+
+	fields.push_back(make_pair(string("input_held"), held));
+	fields.push_back(make_pair(string("state"), string(states[summary.State])));
+	fields.push_back(make_pair(string("score"), to_string(summary.Score)));
+	fields.push_back(make_pair(string("game_time"), to_string(summary.GameTime)));
+	fields.push_back(make_pair(string("camera_z"), to_string(summary.CameraZ)));
+	fields.push_back(make_pair(string("items"), to_string(summary.ItemsCount)));
+	fields.push_back(make_pair(string("snapshots"), to_string(summary.Published)));
+	fields.push_back(make_pair(string("seed"), to_string(this->mSeed)));
+	fields.push_back(make_pair(string("replaying"), this->mReplay != NULL ? "yes" : "no"));
+}
+
+/* Renders the items of the snapshot chunk by chunk, skipping the chunks out of the camera's view */
+void Game::RenderItems(const FrameSnapshot& snapshot) {
+	PROFILE_SCOPE("Game::RenderItems");
+	Model* models[ITEM_MODELS_COUNT] = { this->mCube, this->mCoin, this->mGemScore, this->mGemSpeed, this->mGemCrazy };
+
+	// The instances are placed by their chunk's matrices, the coins and gems then spin around their own axis
+	glm::mat4 spin = glm::rotate(glm::mat4(1.0f), (float)this->mEngine->mTimer->CurrentFrameTime, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	for (int m = 0; m < ITEM_MODELS_COUNT; ++m) {
+		models[m]->ModelMatrix = (m == ItemModel(BLOCK)) ? glm::mat4(1.0f) : spin;
+	}
+
+	float planes[6][4];
+	FrustumPlanes(this->mCamera->GetProjectionMatrix() * this->mCamera->GetViewMatrix(), planes);
+
+	int centerX = (snapshot.Dims.X - 1) / 2;
+
+	for (int c = 0; c < snapshot.ChunksCount; ++c) {
+		const SceneChunk& chunk = snapshot.Chunks[c];
+
+		// Bounds of the lanes of the chunk's items
+		float boxMin[3] = {
+			(float)((chunk.MinX - centerX - 0.5) * LANE_WIDTH - CHUNK_BOUNDS_MARGIN),
+			(float)(chunk.MinY * LANE_HEIGHT - CHUNK_BOUNDS_MARGIN),
+			(float)(-(chunk.MaxZ + 0.5) * LANE_DEPTH - CHUNK_BOUNDS_MARGIN)
+		};
+		float boxMax[3] = {
+			(float)((chunk.MaxX - centerX + 0.5) * LANE_WIDTH + CHUNK_BOUNDS_MARGIN),
+			(float)((chunk.MaxY + 1) * LANE_HEIGHT + CHUNK_BOUNDS_MARGIN),
+			(float)(-(chunk.MinZ - 0.5) * LANE_DEPTH + CHUNK_BOUNDS_MARGIN)
+		};
+
+		if (!IsBoxVisible(planes, boxMin, boxMax)) {
+			RenderStats::CountItems(0, chunk.ItemsCount);
+			continue;
+		}
+
+		RenderStats::CountItems(chunk.ItemsCount, 0);
+
+		// Upload the chunk's instances again only when its items changed
+		ChunkInstances& instances = this->mChunks[chunk.Index % VIEW_CHUNKS_MAX];
+
+		if (instances.Index != chunk.Index || instances.Key != chunk.Key)
+			this->BuildChunk(snapshot, chunk, instances);
+
+		for (int m = 0; m < ITEM_MODELS_COUNT; ++m) {
+			if (instances.Count[m] > 0)
+				models[m]->DrawInstanced(*this->mShader, instances.Buffer, instances.First[m], instances.Count[m]);
+		}
+	}
+}
+
+/* Uploads the model matrices of the items of a snapshot chunk into the given chunk instances */
+void Game::BuildChunk(const FrameSnapshot& snapshot, const SceneChunk& chunk, ChunkInstances& instances) {
+	PROFILE_SCOPE("Game::BuildChunk");
+	const SceneItem* items = &snapshot.Items[chunk.FirstItem];
+	int centerX = (snapshot.Dims.X - 1) / 2;
+
+	// Group the matrices by model
+	memset(instances.Count, 0, sizeof(instances.Count));
+
+	for (int i = 0; i < chunk.ItemsCount; ++i) {
+		instances.Count[ItemModel(items[i].Type)]++;
+	}
+
+	int next[ITEM_MODELS_COUNT];
+
+	for (int m = 0, first = 0; m < ITEM_MODELS_COUNT; first += instances.Count[m++]) {
+		instances.First[m] = next[m] = first;
+	}
+
+	this->mInstanceMatrices.resize(chunk.ItemsCount);
+
+	for (int i = 0; i < chunk.ItemsCount; ++i) {
+		const SceneItem& item = items[i];
+		glm::mat4& matrix = this->mInstanceMatrices[next[ItemModel(item.Type)]++];
+
+		double x = (item.X - centerX) * LANE_WIDTH;
+		double y = item.Y * LANE_HEIGHT;
+		double z = -(item.Z + snapshot.GridIndexZ) * LANE_DEPTH;
+
+		switch (item.Type)
+		{
+		case BLOCK:
+			matrix = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.5f * CUBE_HEIGHT + y, z));
+			matrix = glm::scale(matrix, glm::vec3(CUBE_WIDTH, CUBE_HEIGHT, CUBE_DEPTH));
+			break;
+		case COIN:
+			matrix = glm::translate(glm::mat4(1.0f), glm::vec3(x, COIN_SIZE + y, z));
+			matrix = glm::scale(matrix, glm::vec3(COIN_SIZE, COIN_SIZE, COIN_SIZE));
+			break;
+		default:
+			matrix = glm::translate(glm::mat4(1.0f), glm::vec3(x, GEM_SIZE + y, z));
+			matrix = glm::scale(matrix, glm::vec3(GEM_SIZE, GEM_SIZE, GEM_SIZE));
+			break;
+		}
+	}
+
+	long long bytes = chunk.ItemsCount * sizeof(glm::mat4);
+	glBindBuffer(GL_ARRAY_BUFFER, instances.Buffer);
+	glBufferData(GL_ARRAY_BUFFER, bytes, &this->mInstanceMatrices[0], GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	RenderStats::CountStreamed(bytes);
+	RenderStats::AddGpuMemory(GPU_MEMORY_INSTANCES, bytes - instances.BufferBytes);
+	instances.BufferBytes = bytes;
+
+	instances.Index = chunk.Index;
+	instances.Key = chunk.Key;
 }
 
 /* Renders the text of the game */
-void Game::RenderText() {
-	int w, h, x, y;
+void Game::RenderText(const FrameSnapshot& snapshot) {
+	PROFILE_SCOPE("Game::RenderText");
+	int w = this->mEngine->GetWidth();
+	int h = this->mEngine->GetHeight();
+	int x, y;
 	stringstream ss;
-	glfwGetWindowSize(this->mEngine->mWind, &w, &h);
 
 	// Score
-	ss << SCORE_LABEL << this->mScore;
+	ss << SCORE_LABEL << snapshot.Score;
 	x = FONT_MARGIN;
 	y = h - FONT_MARGIN - FONT_SIZE;
 	this->mTextRenderer->RenderText(*this->mTextShader, ss.str(), x, y, FONT_SCALE, FONT_COLOR);
@@ -215,7 +533,7 @@ void Game::RenderText() {
 	// High score
 	ss.clear();
 	ss.str("");
-	ss << HIGHSCORE_LABEL << this->mHighScore;
+	ss << HIGHSCORE_LABEL << snapshot.HighScore;
 	x = FONT_MARGIN;
 	y = h - FONT_MARGIN * 3 - FONT_SIZE;
 	this->mTextRenderer->RenderText(*this->mTextShader, ss.str(), x, y, FONT_SCALE, FONT_COLOR);
@@ -224,8 +542,8 @@ void Game::RenderText() {
 	// Time
 	ss.clear();
 	ss.str("");
-	int m = (int)this->mGameTime / 60;
-	int s = (int)this->mGameTime % 60;
+	int m = (int)snapshot.GameTime / 60;
+	int s = (int)snapshot.GameTime % 60;
 	ss << TIME_LABEL;
 	if (m < 10) ss << 0; ss << m << ".";
 	if (s < 10) ss << 0; ss << s;
@@ -242,24 +560,24 @@ void Game::RenderText() {
 	this->mTextRenderer->RenderText(*this->mTextShader, ss.str(), x, y, FONT_SCALE, FONT_COLOR);
 
 	// Gem score percentage
-	if (this->mGameState == RUNNING && this->mDoubleScore) {
+	if (snapshot.State == RUNNING && snapshot.DoubleScore) {
 		ss.clear();
 		ss.str("");
-		ss << GEM_SCORE_LABEL << (int)(((DOUBLE_SCORE_DURATION - this->mDoubleScoreTime) / DOUBLE_SCORE_DURATION) * 100) << "%";
+		ss << GEM_SCORE_LABEL << (int)(((DOUBLE_SCORE_DURATION - snapshot.DoubleScoreTime) / DOUBLE_SCORE_DURATION) * 100) << "%";
 		x = (w - this->mGemScoreLabelWidth) / 2;
 		y = h - FONT_MARGIN - FONT_SIZE;
 		this->mTextRenderer->RenderText(*this->mTextShader, ss.str(), x, y, FONT_SCALE, FONT_COLOR);
 	}
 
 	// Gem speed percentage
-	if (this->mGameState == RUNNING && this->mIncreaseSpeed) {
+	if (snapshot.State == RUNNING && snapshot.IncreaseSpeed) {
 		ss.clear();
 		ss.str("");
-		ss << GEM_SPEED_LABEL << (int)(((INCREASE_SPEED_DURATION - this->mIncreaseSpeedTime) / INCREASE_SPEED_DURATION) * 100) << "%";
+		ss << GEM_SPEED_LABEL << (int)(((INCREASE_SPEED_DURATION - snapshot.IncreaseSpeedTime) / INCREASE_SPEED_DURATION) * 100) << "%";
 		x = (w - this->mGemSpeedLabelWidth) / 2;
 		y = h - FONT_MARGIN - FONT_SIZE;
 
-		if (this->mDoubleScore) {
+		if (snapshot.DoubleScore) {
 			y -= FONT_MARGIN * 3;
 		}
 
@@ -267,18 +585,18 @@ void Game::RenderText() {
 	}
 
 	// Extra score gift
-	if (this->mGameState == RUNNING && this->mExtraScore) {
+	if (snapshot.State == RUNNING && snapshot.ExtraScore) {
 		x = (w - this->mExtraScoreLabelWidth) / 2;
-		y = h / 2 + FONT_MARGIN * FONT_MARGIN * this->mExtraScoreTime;
+		y = h / 2 + FONT_MARGIN * FONT_MARGIN * snapshot.ExtraScoreTime;
 
 		this->mTextRenderer->RenderText(*this->mTextShader, GEM_EXTRA_SCORE_LABEL, x, y, FONT_SCALE, FONT_COLOR);
 	}
 
 	// Directions reversed percentage
-	if (this->mGameState == RUNNING && this->mDirectionsReversed) {
+	if (snapshot.State == RUNNING && snapshot.DirectionsReversed) {
 		ss.clear();
 		ss.str("");
-		ss << GEM_REVERSED_MODE_LABEL << (int)(((DIRECTIONS_REVERSED_DURATION - this->mDirectionsReversedTime) / DIRECTIONS_REVERSED_DURATION) * 100) << "%";
+		ss << GEM_REVERSED_MODE_LABEL << (int)(((DIRECTIONS_REVERSED_DURATION - snapshot.DirectionsReversedTime) / DIRECTIONS_REVERSED_DURATION) * 100) << "%";
 		x = (w - this->mReversedLabelWidth) / 2;
 		y = FONT_MARGIN + FONT_SIZE;
 
@@ -286,14 +604,14 @@ void Game::RenderText() {
 	}
 
 	// Game over label
-	if (this->mGameState == LOST) {
+	if (snapshot.State == LOST) {
 		x = (w - this->mGameOverMsgWidth) / 2;
 		y = h / 2 - FONT_SIZE * MENU_FONT_SCALE + FONT_MARGIN * 2;
 		this->mTextRenderer->RenderText(*this->mTextShader, GAME_OVER_MSG, x, y, MENU_FONT_SCALE, FONT_COLOR);
 	}
 
 	// Game paused messages
-	if (this->mGameState != RUNNING) {
+	if (snapshot.State != RUNNING) {
 		// Title
 		x = (w - this->mGameTitleLabelWidth) / 2;
 		y = h / 2 - FONT_SIZE * TITLE_FONT_SCALE + FONT_MARGIN * 7;
@@ -306,52 +624,34 @@ void Game::RenderText() {
 	}
 }
 
-/* Processes inputs from keyboard */
-void Game::ProcessKeyInput() {
-	// Pause/Resume
-	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_ESCAPE) == GLFW_PRESS && this->mEscReleased && this->mGameState != LOST) {
-		this->mGameState = (this->mGameState == PAUSED) ? RUNNING : PAUSED;
-		this->mEscReleased = false;
-	}
-
-	// Detect when ESC is released
-	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_ESCAPE) == GLFW_RELEASE)
-		this->mEscReleased = true;
-
-	// Return if game is not running
-	if (this->mGameState != RUNNING) {
-		// Quit
-		if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_Q) == GLFW_PRESS)
-			glfwSetWindowShouldClose(this->mEngine->mWind, GL_TRUE);
-
-		// Replay
-		if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_R) == GLFW_PRESS)
-			this->ResetGame();
-
-		return;
+/* Plays the sounds and applies the side effects of the given game events */
+void Game::ProcessEvents(unsigned int events) {
+	// An offscreen game plays silently and leaves the high score as it is
+	if (this->mSoundEngine != NULL) {
+		if (events & EVENT_JUMP)
+			this->mSoundEngine->play2D("Sounds/Jump.wav");
+		if (events & EVENT_COIN)
+			this->mSoundEngine->play2D("Sounds/coin.mp3");
+		if (events & EVENT_GEM)
+			this->mSoundEngine->play2D("Sounds/gem.wav");
+		if (events & EVENT_GAME_OVER)
+			this->mSoundEngine->play2D("Sounds/game_over.mp3");
 	}
-		
 
-	// Game control
-	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_A) == GLFW_PRESS && (this->mDirectionsReversed ? mBorderRight : mBorderLeft) != BLOCK)
-		this->mCamera->MoveStep(this->mDirectionsReversed ? RIGHT : LEFT, LANE_WIDTH);
-	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_D) == GLFW_PRESS && (this->mDirectionsReversed ? mBorderLeft : mBorderRight) != BLOCK)
-		this->mCamera->MoveStep(this->mDirectionsReversed ? LEFT : RIGHT, LANE_WIDTH);
+	if ((events & EVENT_GAME_OVER) && !this->mEngine->IsOffscreen())
+		this->SaveHighScore(this->mLogic->GetScore());
 
-	// Jump
-	if (glfwGetKey(this->mEngine->mWind, GLFW_KEY_SPACE) == GLFW_PRESS) {
-		if (!this->mCamera->JumpingOffset()) {
-			this->mSoundEngine->play2D("Sounds/Jump.wav");
-		}
+	if (events & EVENT_RESET)
+		this->mHighScore = this->ReadHighScore();
 
-		this->mCamera->Jump(CAMERA_JUMP_OFFSET);
-	}
+	if ((events & EVENT_QUIT) && !this->mEngine->IsOffscreen())
+		glfwSetWindowShouldClose(this->mEngine->mWind, GL_TRUE);
 }
 
 /* Processes inputs from mouse */
 void Game::ProcessMouseInput() {
 	// Return if game is not running
-	if (this->mGameState != RUNNING)
+	if (this->GetGameState() != RUNNING)
 		return;
 
 	double xpos, ypos;
@@ -359,253 +659,30 @@ void Game::ProcessMouseInput() {
 	this->mCamera->ChangeDirection(xpos, ypos, this->mEngine->mTimer->ElapsedFramesTime);
 }
 
-/* Detects the collision with the character and returns the colliding item */
-void Game::DetectCollision(glm::vec3 characterPos) {
-	this->mBorderLeft = this->mBorderRight = EMPTY;
-
-	int x = (characterPos.x) / LANE_WIDTH + (LANES_X_COUNT - 1) / 2;
-	int y = (characterPos.y) / LANE_HEIGHT;
-	int z = CHARACTER_OFFSET / LANE_DEPTH;
-
-	if (x <= 0)
-		this->mBorderLeft = BLOCK;
-	if (x + 1 >= LANES_X_COUNT)
-		this->mBorderRight = BLOCK;
-
-	if (this->mCamera->IsMovingRight())
-		++x;
-	if (this->mCamera->IsJumping() && this->mCamera->JumpingOffset() < LANE_HEIGHT)
-		++y;
-
-	// Check if out of range
-	if (y < 0 || y > LANES_Y_COUNT || x < 0 || x >= LANES_X_COUNT) {
-		return;
-	}
+/* Copies the current game state into a new frame snapshot */
+void Game::PublishSnapshot() {
+	PROFILE_SCOPE("Game::PublishSnapshot");
+	FrameSnapshot& snapshot = this->mSnapshots->GetWriteBuffer();
 
-	this->GetSlice(z);
-
-	// Set left and right borders
-	if (y < LANES_Y_COUNT) {
-	this->mBorderLeft = (x <= 0) ? BLOCK : mCharacterGrid[y][x - 1];
-	this->mBorderRight = (x + 1 >= LANES_X_COUNT) ? BLOCK : mCharacterGrid[y][x + 1];
-	}
-
-	// Set gravity position
-	for (int i = y; i >= 0; --i) {
-		if (i == 0 || mCharacterGrid[i - 1][x] == BLOCK) {
-			this->mCamera->SetGravityPosition(i * LANE_HEIGHT + GRAVITY_POS);
-			break;
-		}
-	}
-
-	// Detected collision
-	if (y < LANES_Y_COUNT && mCharacterGrid[y][x] != EMPTY) {
-		this->Collide(mCharacterGrid[y][x]);
-
-		if (mCharacterGrid[y][x] != BLOCK) {
-			mCharacterGrid[y][x] = EMPTY;
-		}
-	}
-
-	this->EditSlice(z);
-}
-
-/* Gets a slice from the game grid at certain offset in Z lanes*/
-void Game::GetSlice(int idx) {
-	if (mGrid[0][0].empty())
-		return;
+	this->mLogic->FillSnapshot(snapshot);
+	snapshot.HighScore = this->mHighScore;
 
-	stack<GameItem> temp;
-
-	for (int y = 0; y < LANES_Y_COUNT; ++y) {
-		for (int x = 0; x < LANES_X_COUNT; ++x) {
-			for (int z = 0; z <= idx; ++z) {
-				temp.push(this->mGrid[y][x].front());
-				this->mGrid[y][x].pop_front();
-			}
-
-			mCharacterGrid[y][x] = temp.top();
-
-			while (!temp.empty()) {
-				this->mGrid[y][x].push_front(temp.top());
-				temp.pop();
-			}
-		}
-	}
-}
-
-/* Edits a slice after collision */
-void Game::EditSlice(int idx) {
-	if (mGrid[0][0].empty())
-		return;
-
-	stack<GameItem> temp;
-
-	for (int y = 0; y < LANES_Y_COUNT; ++y) {
-		for (int x = 0; x < LANES_X_COUNT; ++x) {
-			for (int z = 0; z <= idx; ++z) {
-				temp.push(this->mGrid[y][x].front());
-				this->mGrid[y][x].pop_front();
-			}
-
-			temp.top() = mCharacterGrid[y][x];
-
-			while (!temp.empty()) {
-				this->mGrid[y][x].push_front(temp.top());
-				temp.pop();
-			}
-		}
-	}
-}
-
-/* Executes actions according to different types of collision with game items */
-void Game::Collide(GameItem item) {
-	switch (item)
 	{
-	case BLOCK:
-		this->mGameState = LOST;
-		this->mSoundEngine->play2D("Sounds/game_over.mp3");
-		this->SaveHighScore();
-		break;
-	case COIN:
-		this->mScore += this->mCoinValue;
-		this->mSoundEngine->play2D("Sounds/coin.mp3");
-		break;
-	case GEM_DOUBLE_SCORE:
-		this->mDoubleScoreTime = 0.0f;
-		if (!mDoubleScore) {
-			this->mCoinValue *= 2;
-			this->mDoubleScore = true;
-		}
-		this->mSoundEngine->play2D("Sounds/gem.wav");
-		break;
-	case GEM_SPEED:
-		this->mIncreaseSpeedTime = 0.0f;
-		if (!mIncreaseSpeed) {
-			this->mCamera->SetMoveSpeed(this->mCamera->GetCameraSpeed() * INCREASE_SPEED_FACTOR);
-			this->mIncreaseSpeed = true;
-		}
-		this->mSoundEngine->play2D("Sounds/gem.wav");
-		break;
-	case GEM_EXTRA_SCORE:
-		this->mExtraScoreTime = 0.0f;
-		this->mExtraScore = true;
-		this->mScore += EXTRA_COINS_VALUE;
-		this->mSoundEngine->play2D("Sounds/gem.wav");
-		break;
-	case GEM_REVERSED_MODE:
-		this->mDirectionsReversedTime = 0.0f;
-		this->mDirectionsReversed = true;
-		this->mSoundEngine->play2D("Sounds/gem.wav");
-		break;
-	}
-}
-
-/* Generates all of the scene items */
-void Game::GenerateSceneItems() {
-	// Clear the grid's first slice if we exceeded the whole tile
-	ClearGrid();
-
-	while (this->mGrid[0][0].size() < LANES_Z_COUNT) {
-		// If we consumed the whole block then get a new one
-		if (mBlockSliceIdx >= LANES_Z_COUNT) {
-			// Randomlly get a new game block
-			this->mBlockId = rand() % (mBlocksCount - 1) + 1;
-			this->mBlockSliceIdx = 0;
-
-			// Increase camera speed every new block
-			this->mCamera->AccelerateSpeed();
-		}
-
-		// Fills the queue with the slice items
-		for (int y = 0; y < LANES_Y_COUNT; ++y) {
-			for (int x = 0; x < LANES_X_COUNT; ++x) {
-				// Don't always spawn the gem but some times spawn it and sometimes no (for more rarity)
-				if (mSceneBlocks[mBlockSliceIdx][y][x][mBlockId] >= GEM_DOUBLE_SCORE && mSceneBlocks[mBlockSliceIdx][y][x][mBlockId] <= GEM_REVERSED_MODE) {
-					int random = rand() % 10;
-
-					if (random == 0) {
-						if (mSceneBlocks[mBlockSliceIdx][y][x][mBlockId] == GEM_EXTRA_SCORE || mSceneBlocks[mBlockSliceIdx][y][x][mBlockId] == GEM_REVERSED_MODE) {
-							if (rand() % 2 == 0)
-								mSceneBlocks[mBlockSliceIdx][y][x][mBlockId] = GEM_EXTRA_SCORE;
-							else
-								mSceneBlocks[mBlockSliceIdx][y][x][mBlockId] = GEM_REVERSED_MODE;
-						}
-
-						this->mGrid[y][x].push_back(mSceneBlocks[mBlockSliceIdx][y][x][mBlockId]);
-					}
-					else {
-						this->mGrid[y][x].push_back(COIN);
-					}
-				}
-				else {
-					this->mGrid[y][x].push_back(mSceneBlocks[mBlockSliceIdx][y][x][mBlockId]);
-				}
-			}
-		}
-
-		this->mBlockSliceIdx++;
+		lock_guard<mutex> lock(this->mSummaryMutex);
+		this->mSummary.State = snapshot.State;
+		this->mSummary.Score = snapshot.Score;
+		this->mSummary.GameTime = snapshot.GameTime;
+		this->mSummary.CameraZ = snapshot.CameraZ;
+		this->mSummary.ItemsCount = snapshot.ItemsCount;
+		this->mSummary.Published++;
 	}
-}
-
-/* Clears the passed scene items from the grid */
-void Game::ClearGrid() {
-	if (this->mGrid[0][0].empty())
-		return;
 
-	int idx = abs(this->mCamera->GetPosition().z / LANE_DEPTH);
-
-	if (this->mGridIndexZ < idx) {
-		this->mGridIndexZ = idx;
-
-		for (int y = 0; y < LANES_Y_COUNT; ++y) {
-			for (int x = 0; x < LANES_X_COUNT; ++x) {
-				this->mGrid[y][x].pop_front();
-			}
-		}
-	}
-}
-
-/* Resets the game initial values */
-void Game::ResetGame() {
-	this->mScore = 0;
-	this->mHighScore = this->ReadHighScore();
-	this->mGameTime = 0;
-	this->mGameState = RUNNING;
-	this->mCoinValue = COIN_VALUE;
-	this->mDoubleScore = false;
-	this->mIncreaseSpeed = false;
-	this->mExtraScore = false;
-	this->mDirectionsReversed = false;
-
-	this->mCamera->SetPosition(CAMERA_POSITION_INIT);
-	this->mCamera->SetMoveSpeed(CAMERA_SPEED_INIT);
-	this->mCamera->StopAnimation();
-
-	this->mLight->SpecularColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	this->mLight->DiffuseColor = this->mLight->SpecularColor * 0.9f;
-	this->mLight->AmbientColor = this->mLight->SpecularColor * 0.3f;
-
-	this->mBlockId = 0;
-	this->mGridIndexZ = 0;
-	this->mBlockSliceIdx = 0;
-	this->mBorderLeft = EMPTY;
-	this->mBorderRight = EMPTY;
-
-	for (int y = 0; y < LANES_Y_COUNT; ++y) {
-		for (int x = 0; x < LANES_X_COUNT; ++x) {
-			this->mCharacterGrid[y][x] = EMPTY;
-
-			while (!mGrid[y][x].empty()) {
-				this->mGrid[y][x].pop_front();
-			}
-		}
-	}
+	this->mSnapshots->Publish();
 }
 
-/* Saves the high score in a file */
-void Game::SaveHighScore() {
-	if (this->mScore < this->mHighScore) {
+/* Saves the given score in a file if it is a new high score */
+void Game::SaveHighScore(int score) {
+	if (score < this->mHighScore) {
 		return;
 	}
 
@@ -616,12 +693,16 @@ void Game::SaveHighScore() {
 		return;
 	}
 
-	fout << this->mScore;
+	fout << score;
 	fout.close();
 }
 
 /* Reads the high score from the file */
 int Game::ReadHighScore() {
+	// The frames drawn offscreen must not depend on the player's files
+	if (this->mEngine->IsOffscreen())
+		return 0;
+
 	ifstream fin("highscore.txt");
 
 	// Failed to find high score file
@@ -639,8 +720,10 @@ int Game::ReadHighScore() {
 
 /* Initializes the game sounds and background music */
 void Game::InitSounds() {
-	this->mSoundEngine = createIrrKlangDevice();
-	this->mSoundEngine->play2D(BACKGROUND_MUSIC[0].c_str());
+	this->mSoundEngine = this->mEngine->IsOffscreen() ? NULL : createIrrKlangDevice();
+
+	if (this->mSoundEngine != NULL)
+		this->mSoundEngine->play2D(BACKGROUND_MUSIC[0].c_str());
 }
 
 /* Initializes the game models */
@@ -651,59 +734,47 @@ void Game::InitModels() {
 	this->mGemScore = new Model("Models/gem_score/gem_score.obj");
 	this->mGemSpeed = new Model("Models/gem_speed/gem_speed.obj");
 	this->mGemCrazy = new Model("Models/gem_crazy/gem_crazy.obj");
-
-	this->GenerateSceneItems();
 }
 
-/* Initializes the game blocks */
-void Game::InitGameBlocks() {
-	ifstream fin;
-	fin.open("Levels/Level.txt");
-	if (!fin.is_open()) {
-		std::cout << "GAME::ERROR: Could not load file " << "Levels/Level.txt" << std::endl;
-		return;
-	}
-
-	string line = "#";
-	while (line[0] == '#' || line.size() == 0) {
-		getline(fin, line);
+/* Initializes the instance buffers of the chunks */
+void Game::InitChunks() {
+	for (int i = 0; i < VIEW_CHUNKS_MAX; ++i) {
+		ChunkInstances& instances = this->mChunks[i];
+		instances.Index = -1;
+		instances.Key = 0;
+		instances.BufferBytes = 0;
+		memset(instances.First, 0, sizeof(instances.First));
+		memset(instances.Count, 0, sizeof(instances.Count));
+		glGenBuffers(1, &instances.Buffer);
 	}
-	mBlocksCount = stoi(line);
-
+}
 
-	for (int b = 0; b < mBlocksCount; ++b) {
-		for (int y = 0; y < LANES_Y_COUNT; ++y) {
-			for (int x = 0; x < LANES_X_COUNT; ++x) {
-				getline(fin, line);
-				// Line is empty or a comment
-				if (line.size() == 0 || line[0] == '#') {
-					x--;
-					continue;
-				}
+/* Initializes the game logic and its level blocks */
+void Game::InitGameLogic() {
+	this->mLevel = new Level();
 
-				for (int z = 0; z < LANES_Z_COUNT; ++z) {
-					mSceneBlocks[z][y][x].resize(mBlocksCount);
-					mSceneBlocks[z][y][x][b] = (GameItem)(line[z] - '0');
-				}
-			}
-		}
+	// Prefer the compiled level pack unless the text level was edited after it was compiled
+	if (!this->mLevel->LoadLatest(LEVEL_PACK_PATH, LEVEL_PATH)) {
+		std::cout << "GAME::ERROR: Could not load the level from " << LEVEL_PACK_PATH << " or " << LEVEL_PATH << std::endl;
+		exit(EXIT_FAILURE);
 	}
 
-	fin.close();
+	this->mLogic = new GameLogic(this->mLevel, this->mSeed, this->mViewSlices);
+	this->mHighScore = this->ReadHighScore();
 }
 
 /* Initializes the game shaders */
 void Game::InitShaders() {
 	this->mShader = new Shader("Shaders/lighting_vertex.shader", "Shaders/lighting_fragment.shader");
 	this->mTextShader = new Shader("Shaders/text_vertex.shader", "Shaders/text_fragment.shader");
+	this->mGraphShader = new Shader("Shaders/graph_vertex.shader", "Shaders/graph_fragment.shader");
 }
 
 /* Initializes the game camera */
 void Game::InitCamera() {
-	int w, h;
-	glfwGetWindowSize(this->mEngine->mWind, &w, &h);
+	int w = this->mEngine->GetWidth();
+	int h = this->mEngine->GetHeight();
 	this->mCamera = new Camera(CAMERA_POSITION_INIT, (double)w / (double)h);
-	this->mCamera->SetMoveAcceleration(CAMERA_ACCELERATION);
 }
 
 /* Initializes the game light sources */
@@ -716,8 +787,8 @@ void Game::InitLightSources() {
 
 /* Initializes the game text renderers */
 void Game::InitTextRenderers() {
-	int w, h;
-	glfwGetWindowSize(this->mEngine->mWind, &w, &h);
+	int w = this->mEngine->GetWidth();
+	int h = this->mEngine->GetHeight();
 	this->mTextRenderer = new TextRenderer("Fonts/nickname.ttf", FONT_SIZE, w, h);
 
 	this->mGameTitleLabelWidth = this->mTextRenderer->GetTextWidth(this->mGameTitle, TITLE_FONT_SCALE);
@@ -727,4 +798,12 @@ void Game::InitTextRenderers() {
 	this->mGemSpeedLabelWidth = this->mTextRenderer->GetTextWidth(GEM_SPEED_LABEL + "100%", FONT_SCALE);
 	this->mReversedLabelWidth = this->mTextRenderer->GetTextWidth(GEM_REVERSED_MODE_LABEL + "100%", FONT_SCALE);
 	this->mExtraScoreLabelWidth = this->mTextRenderer->GetTextWidth(GEM_EXTRA_SCORE_LABEL, FONT_SCALE);
+}
+
+/* Initializes the performance overlay */
+void Game::InitOverlay() {
+	int w = this->mEngine->GetWidth();
+	int h = this->mEngine->GetHeight();
+	this->mOverlay = new PerfOverlay(this->mGraphShader, this->mTextShader, this->mTextRenderer, w, h);
+	this->mOverlayKeyHeld = false;
 }
\ No newline at end of file
@@ -3,10 +3,11 @@
 // STL Includes
 #include <string>
 #include <vector>
-#include <queue>
-#include <stack>
 #include <time.h>
 #include <fstream>
+#include <atomic>
+#include <mutex>
+#include <cstdlib>
 using namespace std;
 
 // GL Includes
@@ -25,46 +26,19 @@ using namespace irrklang;
 #include "../Components/Camera.h"
 #include "../Components/LightSource.h"
 #include "../Components/TextRenderer.h"
-
-
-/*
-	Defines several game items used in filling the game grid
-*/
-enum GameItem {
-	EMPTY,
-	BLOCK,
-	COIN,
-	GEM_DOUBLE_SCORE,
-	GEM_SPEED,
-	GEM_EXTRA_SCORE,
-	GEM_REVERSED_MODE,
-	ITEMS_COUNT
-};
-
-
-/*
-	Defines several game states
-*/
-enum GameState {
-	RUNNING,
-	PAUSED,
-	LOST
-};
+#include "../Components/PerfOverlay.h"
+#include "../Utils/RenderStats.h"
+#include "../Utils/TripleBuffer.h"
+#include "GameLogic.h"
+#include "Replay.h"
+#include "BlockGenerator.h"
 
 
 // Forward class declaration
 class GameEngine;
 
-// Scene constants
-const int LANES_X_COUNT = 3;
-const int LANES_Y_COUNT = 4;
-const int LANES_Z_COUNT = 20;
-const double LANE_WIDTH = 1.5f;
-const double LANE_HEIGHT = 1.0f;
-const double LANE_DEPTH = 1.5f;
-const double SCENE_WIDTH = LANES_X_COUNT * LANE_WIDTH;
-const double SCENE_HEIGHT = (LANES_Y_COUNT + 3) * LANE_HEIGHT;
-const double SCENE_DEPTH = LANES_Z_COUNT * LANE_DEPTH;
+// Scene constants, the tunnel is sized for the lanes of the level
+const double SCENE_EXTRA_HEIGHT = 3 * LANE_HEIGHT;
 const double CUBE_WIDTH = LANE_WIDTH;
 const double CUBE_HEIGHT = LANE_HEIGHT;
 const double CUBE_DEPTH = LANE_DEPTH;
@@ -74,12 +48,11 @@ const double COIN_SIZE = 0.2;
 const double RING_RADIUS = 0.5;
 const double RING_DEPTH = 0.2;
 
+// Chunk rendering constants
+const int ITEM_MODELS_COUNT = 5;				// Models drawing the game items, the cube, the coin and the gems
+const double CHUNK_BOUNDS_MARGIN = LANE_HEIGHT;	// Added around the lanes of a chunk's items to hold their models
+
 // Camera constants
-const double GRAVITY_POS = LANE_HEIGHT;
-const double CHARACTER_OFFSET = LANE_DEPTH * 1.5;
-const double CAMERA_SPEED_INIT = 4;
-const double CAMERA_JUMP_OFFSET = LANE_HEIGHT;
-const double CAMERA_ACCELERATION = 0.5f;
 const glm::vec3 CAMERA_POSITION_INIT = glm::vec3(0.0f, GRAVITY_POS, 0.0f);
 
 // Font constants
@@ -103,13 +76,8 @@ const string GEM_EXTRA_SCORE_LABEL = "+100";
 const string GEM_REVERSED_MODE_LABEL = "Crazy Mode: ";
 
 // Game constants
-const int COIN_VALUE = 1;
-const int EXTRA_COINS_VALUE = 100;
-const double DOUBLE_SCORE_DURATION = 10.0f;
-const double INCREASE_SPEED_DURATION = 10.0f;
-const double INCREASE_SPEED_FACTOR = 1.25f;
-const double EXTRA_SCORE_DURATION = 2.0f;
-const double DIRECTIONS_REVERSED_DURATION = 10.0f;
+const string LEVEL_PATH = "Levels/Level.txt";
+const string LEVEL_PACK_PATH = "Levels/Level.trl";	// Compiled from LEVEL_PATH by the level compiler
 
 // Music constants
 const int BACKGROUND_MUSIC_COUNT = 5;
@@ -123,7 +91,35 @@ const string BACKGROUND_MUSIC[] = {
 
 
 /*
-	Class containing all our game logic and drawing
+	Model matrices of the items of a chunk of the world in a GPU buffer, grouped by item model
+	and kept until the items of the chunk change
+*/
+struct ChunkInstances {
+	int Index;
+	unsigned long long Key;
+	GLuint Buffer;
+	long long BufferBytes;
+	int First[ITEM_MODELS_COUNT];
+	int Count[ITEM_MODELS_COUNT];
+};
+
+
+/*
+	Summary of the game state for the diagnostics, such as the hitch traces
+*/
+struct GameSummary {
+	GameState State;
+	int Score;
+	double GameTime;
+	double CameraZ;
+	int ItemsCount;
+	unsigned long long Published;		// Snapshots published so far
+};
+
+
+/*
+	Class containing our game drawing, sounds and input,
+	driving the game logic on the simulation thread
 */
 class Game
 {
@@ -142,6 +138,7 @@ private:
 	// Shaders
 	Shader* mShader;
 	Shader* mTextShader;
+	Shader* mGraphShader;
 	// Camera
 	Camera* mCamera;
 	// Light sources
@@ -155,35 +152,45 @@ private:
 	double mGemSpeedLabelWidth;
 	double mExtraScoreLabelWidth;
 	double mReversedLabelWidth;
+	// Performance overlay
+	PerfOverlay* mOverlay;
+	bool mOverlayKeyHeld;
+	bool mScreenshotKeyHeld;
+	bool mAntiAliasingKeyHeld;
 	
-	// Scene variables
-	deque<GameItem> mGrid[LANES_Y_COUNT][LANES_X_COUNT];
-	vector<GameItem> mSceneBlocks[LANES_Z_COUNT][LANES_Y_COUNT][LANES_X_COUNT];
-	GameItem mCharacterGrid[LANES_Y_COUNT][LANES_X_COUNT];
-	GameItem mBorderLeft;
-	GameItem mBorderRight;
-	int mBlockId;
-	int mGridIndexZ;
-	int mBlockSliceIdx;
-	int mBlocksCount;
+	// Game logic
+	Level* mLevel;
+	GameLogic* mLogic;
+	BlockGenerator* mGenerator;
+	unsigned int mSeed;
+	int mViewSlices;
+
+	// Session recording and replaying
+	Replay* mRecording;
+	string mRecordingPath;
+	Replay* mReplay;
+	unsigned long long mReplayTick;
 
 	// Game properties and variables
 	string mGameTitle;
-	GameState mGameState;
-	int mScore;
 	int mHighScore;
-	int mCoinValue;
 	int mMusicIdx = 0;
-	double mGameTime;
-	double mDoubleScoreTime;
-	double mIncreaseSpeedTime;
-	double mExtraScoreTime;
-	double mDirectionsReversedTime;
-	bool mDoubleScore;
-	bool mIncreaseSpeed;
-	bool mExtraScore;
-	bool mDirectionsReversed;
-	bool mEscReleased = true;
+
+	// Input state shared between the rendering and the simulation threads
+	atomic<unsigned int> mInputHeld;	// Keys currently held down
+	atomic<unsigned int> mInputLatched;	// Keys pressed since the last simulation tick
+
+	// Summary of the last published snapshot, for any thread
+	GameSummary mSummary;
+	mutex mSummaryMutex;
+
+	// Frame snapshots handed from the simulation thread to the rendering thread, too large for the stack
+	TripleBuffer<FrameSnapshot>* mSnapshots;
+	const FrameSnapshot* mRendered;			// Snapshot of the frame being drawn, read once for the scene and the HUD
+
+	// Item instances of the chunks in view, the chunk of index i is kept in slot i % VIEW_CHUNKS_MAX (rendering thread)
+	ChunkInstances mChunks[VIEW_CHUNKS_MAX];
+	vector<glm::mat4> mInstanceMatrices;
 	
 public:
 	/* Constructs a new game with all related objects and components */
@@ -195,49 +202,64 @@ public:
 	/* Returns the current game state */
 	GameState GetGameState() const;
 
-	/* Receives user input and processes it for the next frame */
-	void ProcessInput();
+	/* Plays procedurally generated blocks after the level's initial block, or the level's blocks, and restarts the game */
+	void SetProceduralBlocks(bool procedural);
 
-	/* Updates objects' information needed to apply effects to the next frame  */
-	void Update();
+	/* Keeps and draws the given number of slices ahead, or a block length if 0, and restarts the game */
+	void SetViewSlices(int viewSlices);
 
-	/* Renders the new frame */
-	void Render();
+	/* Shows or hides the performance overlay, also toggled with F3 */
+	void SetOverlayVisible(bool visible);
 
-private:
+	/* Records the inputs of the session to be saved into the given file when the game ends */
+	void StartRecording(const string& path);
 
-	/* Renders the text of the game */
-	void RenderText();
+	/* Replays the session saved in the given file instead of the user input, returns false on failure */
+	bool StartReplay(const string& path);
 
-	/* Processes inputs from keyboard */
-	void ProcessKeyInput();
+	/* Replays the given session instead of the user input, the game takes ownership of the replay */
+	void StartReplay(Replay* replay);
 
-	/* Processes inputs from mouse */
-	void ProcessMouseInput();
+	/* Returns whether a replay is being played and has ticks left */
+	bool IsReplaying() const;
 
-	/* Detects the collision with the character and returns the colliding item */
-	void DetectCollision(glm::vec3 characterPos);
+	/* Polls user input to be consumed by the next simulation tick (rendering thread) */
+	void ProcessInput();
 
-	/* Gets a slice from the game grid at certain offset in Z lanes*/
-	void GetSlice(int idx);
+	/* Advances the game logic by the given time step and publishes a new snapshot (simulation thread) */
+	void Update(double deltaTime);
 
-	/* Edits a slice after collision */
-	void EditSlice(int idx);
+	/* Renders the 3D scene of the last published snapshot (rendering thread) */
+	void RenderScene();
 
-	/* Executes actions according to different types of collision with game items */
-	void Collide(GameItem item);
+	/* Renders the game information and the overlay of the snapshot of the scene, over it at the frame's resolution (rendering thread) */
+	void RenderHud();
 
-	/* Generates all of the scene items */
-	void GenerateSceneItems();
+	/* Describes the input and the last published game state as name and value pairs (any thread) */
+	void DescribeState(vector<pair<string, string>>& fields);
 
-	/* Clears the passed scene items from the grid */
-	void ClearGrid();
+private:
 
-	/* Resets the game initial values */
-	void ResetGame();
+	/* Renders the items of the snapshot chunk by chunk, skipping the chunks out of the camera's view */
+	void RenderItems(const FrameSnapshot& snapshot);
 
-	/* Saves the high score in a file */
-	void SaveHighScore();
+	/* Uploads the model matrices of the items of a snapshot chunk into the given chunk instances */
+	void BuildChunk(const FrameSnapshot& snapshot, const SceneChunk& chunk, ChunkInstances& instances);
+
+	/* Renders the text of the game */
+	void RenderText(const FrameSnapshot& snapshot);
+
+	/* Plays the sounds and applies the side effects of the given game events */
+	void ProcessEvents(unsigned int events);
+
+	/* Processes inputs from mouse */
+	void ProcessMouseInput();
+
+	/* Copies the current game state into a new frame snapshot */
+	void PublishSnapshot();
+
+	/* Saves the given score in a file if it is a new high score */
+	void SaveHighScore(int score);
 
 	/* Reads the high score from the file */
 	int ReadHighScore();
@@ -248,8 +270,11 @@ private:
 	/* Initializes the game models */
 	void InitModels();
 
-	/* Initialezies the game blocks */
-	void InitGameBlocks();
+	/* Initializes the instance buffers of the chunks */
+	void InitChunks();
+
+	/* Initializes the game logic and its level blocks */
+	void InitGameLogic();
 
 	/* Initializes the game shaders */
 	void InitShaders();
@@ -262,4 +287,7 @@ private:
 
 	/* Initializes the game text renderers */
 	void InitTextRenderers();
+
+	/* Initializes the performance overlay */
+	void InitOverlay();
 };
\ No newline at end of file
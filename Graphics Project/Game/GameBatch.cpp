@@ -0,0 +1,862 @@
+#include "GameBatch.h"
+
+/* Constructs the given number of games playing the given level, game i is seeded with seed + i */
+GameBatch::GameBatch(const Level* level, int gamesCount, unsigned int seed, int threadsCount, int viewSlices) :
+	mRandom(gamesCount),
+	mBlockRandom(gamesCount),
+	mKinematics(gamesCount, CameraKinematics(0.0f, GRAVITY_POS, 0.0f)),
+	mGridHead(gamesCount, 0),
+	mGridSize(gamesCount, 0),
+	mBorderLeft(gamesCount, EMPTY),
+	mBorderRight(gamesCount, EMPTY),
+	mBlockId(gamesCount, 0),
+	mGridIndexZ(gamesCount, 0),
+	mOriginIndexZ(gamesCount, 0),
+	mBlockSliceIdx(gamesCount, 0),
+	mNextBlocks(gamesCount * LEVEL_READ_AHEAD_BLOCKS, 0),
+	mNextBlockHead(gamesCount, 0),
+	mGameState(gamesCount, RUNNING),
+	mScore(gamesCount, 0),
+	mCoinValue(gamesCount, COIN_VALUE),
+	mGameTime(gamesCount, 0.0f),
+	mDoubleScoreTime(gamesCount, 0.0f),
+	mIncreaseSpeedTime(gamesCount, 0.0f),
+	mExtraScoreTime(gamesCount, 0.0f),
+	mDirectionsReversedTime(gamesCount, 0.0f),
+	mDoubleScore(gamesCount, false),
+	mIncreaseSpeed(gamesCount, false),
+	mExtraScore(gamesCount, false),
+	mDirectionsReversed(gamesCount, false),
+	mEscReleased(gamesCount, true),
+	mEvents(gamesCount, 0),
+	mRewardsBuffer(gamesCount, 0.0f),
+	mDonesBuffer(gamesCount, 0) {
+	this->mLevel = level;
+	this->mGamesCount = gamesCount;
+
+	// Grids sized for the level, with the specialized code of its dimensions if there is one
+	this->mDims = level->GetDims();
+	this->mSliceCells = this->mDims.Y * this->mDims.X;
+	this->mGridCells = this->mDims.Z * this->mSliceCells;
+	this->mBlockSize = level->GetBlockSize();
+
+	if (this->mDims == GridDims{ DefaultGridDims::X, DefaultGridDims::Y, DefaultGridDims::Z })
+		this->mGridConfig = GRID_DEFAULT;
+	else if (this->mDims == GridDims{ WideGridDims::X, WideGridDims::Y, WideGridDims::Z })
+		this->mGridConfig = GRID_WIDE;
+	else if (this->mDims == GridDims{ DeepGridDims::X, DeepGridDims::Y, DeepGridDims::Z })
+		this->mGridConfig = GRID_DEEP;
+	else
+		this->mGridConfig = GRID_RUNTIME;
+
+	// Rings long enough for the view distance, and for at least an observation
+	this->mViewSlices = (viewSlices > 0) ? min(max(viewSlices, this->mDims.Z), VIEW_SLICES_MAX) : this->mDims.Z;
+	this->mRingSlices = 1;
+
+	while (this->mRingSlices < this->mViewSlices) {
+		this->mRingSlices *= 2;
+	}
+
+	this->mRingMask = this->mRingSlices - 1;
+
+	this->mGrids.assign((size_t)gamesCount * this->mRingSlices * this->mSliceCells, EMPTY);
+	this->mSolidMasks.assign((size_t)gamesCount * this->mRingSlices * this->mDims.Y, 0);
+	this->mCoinMasks.assign((size_t)gamesCount * this->mRingSlices * this->mDims.Y, 0);
+	this->mGemMasks.assign((size_t)gamesCount * this->mRingSlices * this->mDims.Y, 0);
+
+	if (this->mViewSlices > this->mDims.Z)
+		this->mFillCursors.resize((size_t)gamesCount * this->mRingSlices);
+	this->mBlockCells.assign((size_t)gamesCount * this->mBlockSize, 0);
+	this->mObservationsBuffer.assign((size_t)gamesCount * this->mGridCells, EMPTY);
+	this->mThreadPool = new ThreadPool(threadsCount);
+	this->mStepActions = NULL;
+	this->mStepDeltaTime = 0;
+	this->mGenerator = NULL;
+
+	for (int i = 0; i < gamesCount; ++i) {
+		this->mKinematics[i].SetMoveAcceleration(CAMERA_ACCELERATION);
+	}
+
+	this->Seed(seed);
+	this->SetBuffers(NULL, NULL, NULL);
+}
+
+/* Destructs the games */
+GameBatch::~GameBatch() {
+	delete this->mThreadPool;
+}
+
+/* Returns the number of games */
+int GameBatch::GetGamesCount() const {
+	return this->mGamesCount;
+}
+
+/* Returns the number of threads stepping the games */
+int GameBatch::GetThreadsCount() const {
+	return this->mThreadPool->GetThreadsCount();
+}
+
+/* Returns the grid dimensions of the games */
+const GridDims& GameBatch::GetDims() const {
+	return this->mDims;
+}
+
+/* Returns the number of items of an observation */
+int GameBatch::GetObservationSize() const {
+	return this->mGridCells;
+}
+
+/* Returns the number of slices kept ahead of the games */
+int GameBatch::GetViewSlices() const {
+	return this->mViewSlices;
+}
+
+/* Makes the games play the blocks of the given generator, null goes back to picking the level's blocks */
+void GameBatch::SetGenerator(BlockGenerator* generator) {
+	if (generator != NULL && !(this->mDims == DEFAULT_GRID_DIMS)) {
+		std::cout << "GAME::ERROR: Generated blocks only fit levels of the default dimensions" << std::endl;
+		return;
+	}
+
+	if (generator != NULL && generator->GetChannelsCount() < this->mGamesCount) {
+		std::cout << "GAME::ERROR: The block generator has " << generator->GetChannelsCount() << " channels for "
+			<< this->mGamesCount << " games" << std::endl;
+		return;
+	}
+
+	// A shorter ring would make the games generate the blocks of a reset themselves
+	if (generator != NULL && generator->GetViewSlices() < this->mViewSlices) {
+		std::cout << "GAME::ERROR: The block generator keeps " << generator->GetViewSlices() << " slices for a view of "
+			<< this->mViewSlices << " slices" << std::endl;
+		return;
+	}
+
+	this->mGenerator = generator;
+}
+
+/* Restarts the random sequences, game i from seed + i, and resets all of the games */
+void GameBatch::Seed(unsigned int seed) {
+	for (int i = 0; i < this->mGamesCount; ++i) {
+		this->Seed(i, seed + i);
+	}
+}
+
+/* Restarts the random sequence of a game from the given seed and resets it */
+void GameBatch::Seed(int game, unsigned int seed) {
+	this->mRandom[game].Seed(seed);
+	this->mEscReleased[game] = true;
+
+	if (this->mGenerator != NULL)
+		this->mGenerator->Seed(game, seed);
+
+	// Blocks are picked from their own sequence so they are known ahead of the gems drawn in between
+	this->mBlockRandom[game].Seed(seed ^ 0x5A5A5A5A);
+	this->mNextBlockHead[game] = 0;
+
+	for (int i = 0; i < LEVEL_READ_AHEAD_BLOCKS; ++i) {
+		this->mNextBlocks[game * LEVEL_READ_AHEAD_BLOCKS + i] = this->PickNextBlock(game, i > 0 ? this->mNextBlocks[game * LEVEL_READ_AHEAD_BLOCKS + i - 1] : 0);
+	}
+
+	// The streams start over, so none of the filled slices is taken back
+	this->mGridSize[game] = 0;
+
+	this->Reset(game);
+}
+
+/* Resets a game initial values */
+void GameBatch::Reset(int game) {
+	this->mScore[game] = 0;
+	this->mGameTime[game] = 0;
+	this->mGameState[game] = RUNNING;
+	this->mCoinValue[game] = COIN_VALUE;
+	this->mDoubleScore[game] = false;
+	this->mIncreaseSpeed[game] = false;
+	this->mExtraScore[game] = false;
+	this->mDirectionsReversed[game] = false;
+	this->mDoubleScoreTime[game] = 0.0f;
+	this->mIncreaseSpeedTime[game] = 0.0f;
+	this->mExtraScoreTime[game] = 0.0f;
+	this->mDirectionsReversedTime[game] = 0.0f;
+
+	this->mKinematics[game].SetPosition(0.0f, GRAVITY_POS, 0.0f);
+	this->mKinematics[game].SetMoveSpeed(CAMERA_SPEED_INIT);
+	this->mKinematics[game].StopAnimation();
+
+	// Take back the slices filled beyond the observation, so the game goes on the same whatever the view distance
+	if (this->mGridSize[game] > this->mDims.Z)
+		this->RewindStreams(game, this->mDims.Z);
+
+	this->mBlockId[game] = 0;
+	this->mGridIndexZ[game] = 0;
+	this->mOriginIndexZ[game] = 0;
+	this->mBlockSliceIdx[game] = 0;
+	this->mLevel->CopyBlock(0, &this->mBlockCells[game * this->mBlockSize]);
+	this->mBorderLeft[game] = EMPTY;
+	this->mBorderRight[game] = EMPTY;
+
+	this->mGridHead[game] = 0;
+	this->mGridSize[game] = 0;
+
+	this->GenerateSceneItems(game);
+
+	this->mEvents[game] |= EVENT_RESET;
+}
+
+/* Writes the current observation of a game, with no reward and not done, into the step outputs */
+void GameBatch::ClearOutputs(int game) {
+	this->mRewards[game] = 0.0f;
+	this->mDones[game] = 0;
+	this->GetObservation(game, this->mObservations + game * this->mGridCells);
+}
+
+/* Advances all of the games by the given time step, game i pressing the input keys actions[i] */
+void GameBatch::Step(const unsigned int* actions, double deltaTime) {
+	this->mStepActions = actions;
+	this->mStepDeltaTime = deltaTime;
+
+	// A task capturing a single pointer fits in the function's local storage, so stepping doesn't allocate
+	this->mThreadPool->ParallelFor(this->mGamesCount, [this](int begin, int end) {
+		this->StepRange(begin, end);
+	});
+}
+
+/* Advances a single game by the given time step with the given input keys, writes its step outputs and restarts it if it was lost */
+void GameBatch::Step(int game, unsigned int input, double deltaTime) {
+	int score = this->mScore[game];
+	unsigned int events = this->StepGame(game, input, deltaTime);
+
+	this->mRewards[game] = (float)(this->mScore[game] - score);
+	this->mDones[game] = (events & EVENT_GAME_OVER) ? 1 : 0;
+
+	if (this->mDones[game])
+		this->Reset(game);
+
+	this->GetObservation(game, this->mObservations + game * this->mGridCells);
+}
+
+/* Steps the games in the given range with the arguments of the current step */
+void GameBatch::StepRange(int begin, int end) {
+	for (int i = begin; i < end; ++i) {
+		this->Step(i, this->mStepActions[i], this->mStepDeltaTime);
+	}
+}
+
+/* Advances a single game by the given time step with the given input keys, returns the raised events */
+unsigned int GameBatch::StepGame(int game, unsigned int input, double deltaTime) {
+	switch (this->mGridConfig) {
+	case GRID_DEFAULT:
+		return this->StepGame(DefaultGridDims(), game, input, deltaTime);
+	case GRID_WIDE:
+		return this->StepGame(WideGridDims(), game, input, deltaTime);
+	case GRID_DEEP:
+		return this->StepGame(DeepGridDims(), game, input, deltaTime);
+	default:
+		return this->StepGame(this->mDims, game, input, deltaTime);
+	}
+}
+
+/* Advances a single game by the given time step with the given input keys, returns the raised events */
+template <class Dims>
+unsigned int GameBatch::StepGame(const Dims& dims, int game, unsigned int input, double deltaTime) {
+	this->mEvents[game] = 0;
+
+	this->ProcessInput(game, input);
+
+	// Return if game is not running
+	if (this->mGameState[game] != RUNNING)
+		return this->mEvents[game];
+
+	// Update runnning game time
+	this->mGameTime[game] += deltaTime;
+
+	// Removes the double score effect after certain amount of time
+	if (this->mDoubleScore[game]) {
+		this->mDoubleScoreTime[game] += deltaTime;
+
+		if (this->mDoubleScoreTime[game] >= DOUBLE_SCORE_DURATION) {
+			this->mDoubleScore[game] = false;
+			this->mCoinValue[game] /= 2;
+		}
+	}
+
+	// Removes the increase speed effect after certain amount of time
+	if (this->mIncreaseSpeed[game]) {
+		this->mIncreaseSpeedTime[game] += deltaTime;
+
+		if (this->mIncreaseSpeedTime[game] >= INCREASE_SPEED_DURATION) {
+			this->mIncreaseSpeed[game] = false;
+			this->mKinematics[game].SetMoveSpeed(this->mKinematics[game].GetMoveSpeed() / INCREASE_SPEED_FACTOR);
+		}
+	}
+
+	// Update extra coins time
+	if (this->mExtraScore[game]) {
+		this->mExtraScoreTime[game] += deltaTime;
+
+		if (this->mExtraScoreTime[game] >= EXTRA_SCORE_DURATION) {
+			this->mExtraScore[game] = false;
+		}
+	}
+
+	// Update reversed directions effect
+	if (this->mDirectionsReversed[game]) {
+		this->mDirectionsReversedTime[game] += deltaTime;
+
+		if (this->mDirectionsReversedTime[game] >= DIRECTIONS_REVERSED_DURATION) {
+			this->mDirectionsReversed[game] = false;
+		}
+	}
+
+	// Update camera to give animation effects, in sub-steps that end where a forward or sideways step ends,
+	// so every slice and lane crossed during the time step is tested for collisions in order
+	CameraKinematics& kinematics = this->mKinematics[game];
+	double timeLeft = deltaTime;
+
+	while (timeLeft > 0.0f && this->mGameState[game] == RUNNING) {
+		kinematics.MoveStep(FORWARD, LANE_DEPTH);
+
+		double stepTime = kinematics.GetStepTime(min(timeLeft, SIMULATION_MAX_SUBSTEP_TIME));
+		timeLeft -= stepTime;
+		kinematics.Update(stepTime);
+
+		// Detect collisions
+		this->DetectCollision(dims, game, kinematics.GetPositionX(), kinematics.GetPositionY() - GRAVITY_POS);
+
+		// Update the scene items to be rendered
+		this->GenerateSceneItems(dims, game);
+	}
+
+	return this->mEvents[game];
+}
+
+/* Makes the steps write into the given buffers, null buffers go back to the batch's own buffers */
+void GameBatch::SetBuffers(unsigned char* observations, float* rewards, unsigned char* dones) {
+	this->mObservations = (observations != NULL) ? observations : &this->mObservationsBuffer[0];
+	this->mRewards = (rewards != NULL) ? rewards : &this->mRewardsBuffer[0];
+	this->mDones = (dones != NULL) ? dones : &this->mDonesBuffer[0];
+
+	for (int i = 0; i < this->mGamesCount; ++i) {
+		this->ClearOutputs(i);
+	}
+}
+
+/* Returns the observations of the last step, GetObservationSize() items per game */
+const unsigned char* GameBatch::GetObservations() const {
+	return this->mObservations;
+}
+
+/* Returns the score gained by every game in the last step */
+const float* GameBatch::GetRewards() const {
+	return this->mRewards;
+}
+
+/* Returns whether every game was lost in the last step */
+const unsigned char* GameBatch::GetDones() const {
+	return this->mDones;
+}
+
+/* Writes the items of the lanes ahead of a game, ordered [z][y][x], into the given buffer */
+void GameBatch::GetObservation(int game, unsigned char* observation) const {
+	// Unroll the ring, the slices from the head to the end of the storage then the ones wrapped to its start
+	const unsigned char* grid = &this->mGrids[(size_t)game * this->mRingSlices * this->mSliceCells];
+	int sliceCells = this->mSliceCells;
+	int head = this->mGridHead[game];
+	int size = min(this->mGridSize[game], this->mDims.Z);
+	int first = min(size, this->mRingSlices - head);
+
+	memcpy(observation, grid + head * sliceCells, first * sliceCells);
+	memcpy(observation + first * sliceCells, grid, (size - first) * sliceCells);
+	memset(observation + size * sliceCells, EMPTY, (this->mDims.Z - size) * sliceCells);
+}
+
+/* Returns the current state of a game */
+GameState GameBatch::GetGameState(int game) const {
+	return (GameState)this->mGameState[game];
+}
+
+/* Returns the current score of a game */
+int GameBatch::GetScore(int game) const {
+	return this->mScore[game];
+}
+
+/* Returns a hash of the whole state of a game, used to verify that replays are reproduced exactly */
+unsigned long long GameBatch::GetStateHash(int game) const {
+	const CameraKinematics& kinematics = this->mKinematics[game];
+
+	// FNV-1a over the raw bytes of the state variables
+	unsigned long long hash = 14695981039346656037ULL;
+	double values[] = {
+		kinematics.GetPositionX(), kinematics.GetPositionY(), kinematics.GetPositionZ(),
+		kinematics.GetMoveSpeed(), this->mGameTime[game], (double)this->mScore[game], (double)this->mGameState[game],
+		(double)this->mGridIndexZ[game], (double)this->mOriginIndexZ[game]
+	};
+
+	const unsigned char* bytes = (const unsigned char*)values;
+	for (size_t i = 0; i < sizeof(values); ++i) {
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+
+	// Only the slices of an observation, the rest of the look-ahead depends on the view distance
+	int size = min(this->mGridSize[game], this->mDims.Z);
+
+	for (int y = 0; y < this->mDims.Y; ++y) {
+		for (int x = 0; x < this->mDims.X; ++x) {
+			for (int z = 0; z < size; ++z) {
+				hash = (hash ^ this->GridItem(this->mDims, game, z, y, x)) * 1099511628211ULL;
+			}
+		}
+	}
+
+	return hash;
+}
+
+/* Returns the camera kinematics of a game */
+const CameraKinematics& GameBatch::GetKinematics(int game) const {
+	return this->mKinematics[game];
+}
+
+/* Returns the number of slices a game has run since it started */
+long long GameBatch::GetDistance(int game) const {
+	return this->mOriginIndexZ[game] + this->mGridIndexZ[game];
+}
+
+/* Copies the current state of a game into the given frame snapshot */
+void GameBatch::FillSnapshot(int game, FrameSnapshot& snapshot) const {
+	PROFILE_SCOPE("GameBatch::FillSnapshot");
+	const CameraKinematics& kinematics = this->mKinematics[game];
+
+	// Camera
+	snapshot.CameraX = kinematics.GetPositionX();
+	snapshot.CameraY = kinematics.GetPositionY();
+	snapshot.CameraZ = kinematics.GetPositionZ();
+
+	// Scene items slice by slice, starting a chunk at the first item of each chunk of the world
+	snapshot.Dims = this->mDims;
+	snapshot.ViewSlices = this->mViewSlices;
+	snapshot.GridIndexZ = this->mGridIndexZ[game];
+	snapshot.ItemsCount = 0;
+	snapshot.ChunksCount = 0;
+
+	size_t itemsCapacity = (size_t)this->mDims.X * this->mDims.Y * this->mViewSlices;
+	if (snapshot.Items.size() < itemsCapacity)
+		snapshot.Items.resize(itemsCapacity);
+
+	SceneChunk* chunk = NULL;
+
+	for (int z = 0; z < this->mGridSize[game]; ++z) {
+		const unsigned char* slice = &this->mGrids[(size_t)this->RingSlot(game, z) * this->mSliceCells];
+		int row = this->MaskRow(this->mDims, game, z);
+		int sliceZ = snapshot.GridIndexZ + z;
+
+		// Only the lanes set in the row masks, most of a long look-ahead is empty
+		for (int y = 0; y < this->mDims.Y; ++y) {
+			uint64_t lanes = this->mSolidMasks[row + y] | this->mCoinMasks[row + y] | this->mGemMasks[row + y];
+
+			for (; lanes != 0; lanes &= lanes - 1) {
+				int x = LowestBit(lanes);
+				unsigned char type = slice[y * this->mDims.X + x];
+
+				if (chunk == NULL || chunk->Index != sliceZ / VIEW_CHUNK_SLICES) {
+					chunk = &snapshot.Chunks[snapshot.ChunksCount++];
+					chunk->Index = sliceZ / VIEW_CHUNK_SLICES;
+					chunk->FirstItem = snapshot.ItemsCount;
+					chunk->ItemsCount = 0;
+					chunk->Key = 14695981039346656037ULL;
+					chunk->MinX = chunk->MinY = chunk->MinZ = INT_MAX;
+					chunk->MaxX = chunk->MaxY = chunk->MaxZ = INT_MIN;
+				}
+
+				SceneItem& item = snapshot.Items[snapshot.ItemsCount++];
+				item.Type = (GameItem)type;
+				item.X = x;
+				item.Y = y;
+				item.Z = z;
+
+				// FNV-1a over the items and their slices of the world
+				chunk->ItemsCount++;
+				chunk->Key = (chunk->Key ^ type) * 1099511628211ULL;
+				chunk->Key = (chunk->Key ^ (unsigned long long)((sliceZ * LANES_Y_MAX + y) * LANES_X_MAX + x)) * 1099511628211ULL;
+				chunk->MinX = min(chunk->MinX, x);
+				chunk->MaxX = max(chunk->MaxX, x);
+				chunk->MinY = min(chunk->MinY, y);
+				chunk->MaxY = max(chunk->MaxY, y);
+				chunk->MinZ = min(chunk->MinZ, sliceZ);
+				chunk->MaxZ = max(chunk->MaxZ, sliceZ);
+			}
+		}
+	}
+
+	// HUD values
+	snapshot.State = (GameState)this->mGameState[game];
+	snapshot.Score = this->mScore[game];
+	snapshot.GameTime = this->mGameTime[game];
+	snapshot.DoubleScoreTime = this->mDoubleScoreTime[game];
+	snapshot.IncreaseSpeedTime = this->mIncreaseSpeedTime[game];
+	snapshot.ExtraScoreTime = this->mExtraScoreTime[game];
+	snapshot.DirectionsReversedTime = this->mDirectionsReversedTime[game];
+	snapshot.DoubleScore = this->mDoubleScore[game] != 0;
+	snapshot.IncreaseSpeed = this->mIncreaseSpeed[game] != 0;
+	snapshot.ExtraScore = this->mExtraScore[game] != 0;
+	snapshot.DirectionsReversed = this->mDirectionsReversed[game] != 0;
+}
+
+/* Returns the ring slot of a game's slice */
+inline int GameBatch::RingSlot(int game, int z) const {
+	return game * this->mRingSlices + ((this->mGridHead[game] + z) & this->mRingMask);
+}
+
+/* Returns the index of the first row mask of a game's slice */
+template <class Dims>
+int GameBatch::MaskRow(const Dims& dims, int game, int z) const {
+	return this->RingSlot(game, z) * dims.Y;
+}
+
+/* Returns the grid item of a game at the given slice and lanes */
+template <class Dims>
+unsigned char& GameBatch::GridItem(const Dims& dims, int game, int z, int y, int x) {
+	return this->mGrids[(this->RingSlot(game, z) * dims.Y + y) * dims.X + x];
+}
+
+/* Returns the grid item of a game at the given slice and lanes */
+template <class Dims>
+unsigned char GameBatch::GridItem(const Dims& dims, int game, int z, int y, int x) const {
+	return this->mGrids[(this->RingSlot(game, z) * dims.Y + y) * dims.X + x];
+}
+
+/* Processes the input keys */
+void GameBatch::ProcessInput(int game, unsigned int input) {
+	// Pause/Resume
+	if ((input & INPUT_PAUSE) && this->mEscReleased[game] && this->mGameState[game] != LOST) {
+		this->mGameState[game] = (this->mGameState[game] == PAUSED) ? RUNNING : PAUSED;
+		this->mEscReleased[game] = false;
+	}
+
+	// Detect when ESC is released
+	if (!(input & INPUT_PAUSE))
+		this->mEscReleased[game] = true;
+
+	// Return if game is not running
+	if (this->mGameState[game] != RUNNING) {
+		// Quit
+		if (input & INPUT_QUIT)
+			this->mEvents[game] |= EVENT_QUIT;
+
+		// Replay
+		if (input & INPUT_REPLAY)
+			this->Reset(game);
+
+		return;
+	}
+
+
+	// Game control
+	CameraKinematics& kinematics = this->mKinematics[game];
+	bool reversed = this->mDirectionsReversed[game] != 0;
+
+	if ((input & INPUT_LEFT) && (reversed ? mBorderRight[game] : mBorderLeft[game]) != BLOCK)
+		kinematics.MoveStep(reversed ? RIGHT : LEFT, LANE_WIDTH);
+	if ((input & INPUT_RIGHT) && (reversed ? mBorderLeft[game] : mBorderRight[game]) != BLOCK)
+		kinematics.MoveStep(reversed ? LEFT : RIGHT, LANE_WIDTH);
+
+	// Jump
+	if (input & INPUT_JUMP) {
+		if (!kinematics.JumpingOffset()) {
+			this->mEvents[game] |= EVENT_JUMP;
+		}
+
+		kinematics.Jump(CAMERA_JUMP_OFFSET);
+	}
+}
+
+/* Detects the collision with the character and returns the colliding item */
+template <class Dims>
+void GameBatch::DetectCollision(const Dims& dims, int game, double xpos, double ypos) {
+	PROFILE_SCOPE("GameBatch::DetectCollision");
+	CameraKinematics& kinematics = this->mKinematics[game];
+
+	this->mBorderLeft[game] = this->mBorderRight[game] = EMPTY;
+
+	int x = (xpos) / LANE_WIDTH + (dims.X - 1) / 2;
+	int y = (ypos) / LANE_HEIGHT;
+	int z = CHARACTER_OFFSET / LANE_DEPTH;
+
+	if (x <= 0)
+		this->mBorderLeft[game] = BLOCK;
+	if (x + 1 >= dims.X)
+		this->mBorderRight[game] = BLOCK;
+
+	if (kinematics.IsMovingRight())
+		++x;
+	if (kinematics.IsJumping() && kinematics.JumpingOffset() < LANE_HEIGHT)
+		++y;
+
+	// Check if out of range
+	if (y < 0 || y > dims.Y || x < 0 || x >= dims.X) {
+		return;
+	}
+
+	// An empty grid has no items
+	static const uint64_t emptyRows[LANES_Y_MAX] = {};
+	int row = this->MaskRow(dims, game, z);
+	const uint64_t* solid = (this->mGridSize[game] > 0) ? &this->mSolidMasks[row] : emptyRows;
+	uint64_t bit = 1ULL << x;
+
+	// Set left and right borders
+	if (y < dims.Y) {
+		this->mBorderLeft[game] = (x <= 0 || (solid[y] & (bit >> 1)) != 0) ? BLOCK : EMPTY;
+		this->mBorderRight[game] = (x + 1 >= dims.X || (solid[y] & (bit << 1)) != 0) ? BLOCK : EMPTY;
+	}
+
+	// Set gravity position on top of the highest block below the character
+	uint64_t below = 0;
+	for (int i = 0; i < y && i < dims.Y; ++i) {
+		below |= ((solid[i] >> x) & 1) << i;
+	}
+
+	kinematics.SetGravityPosition((HighestBit(below) + 1) * LANE_HEIGHT + GRAVITY_POS);
+
+	// Detected collision
+	if (y < dims.Y && this->mGridSize[game] > 0) {
+		if ((solid[y] & bit) != 0) {
+			this->Collide(game, BLOCK);
+		}
+		else if (((this->mCoinMasks[row + y] | this->mGemMasks[row + y]) & bit) != 0) {
+			unsigned char& item = this->GridItem(dims, game, z, y, x);
+			this->Collide(game, (GameItem)item);
+
+			item = EMPTY;
+			this->mCoinMasks[row + y] &= ~bit;
+			this->mGemMasks[row + y] &= ~bit;
+		}
+	}
+}
+
+/* Computes the row masks of a game's slice from its items */
+template <class Dims>
+void GameBatch::UpdateMasks(const Dims& dims, int game, int z) {
+	int row = this->MaskRow(dims, game, z);
+
+	for (int y = 0; y < dims.Y; ++y) {
+		uint64_t solid = 0, coin = 0, gem = 0;
+
+		for (int x = 0; x < dims.X; ++x) {
+			unsigned char item = this->GridItem(dims, game, z, y, x);
+			uint64_t bit = 1ULL << x;
+
+			if (item == BLOCK)
+				solid |= bit;
+			else if (item == COIN)
+				coin |= bit;
+			else if (item >= GEM_DOUBLE_SCORE && item <= GEM_REVERSED_MODE)
+				gem |= bit;
+		}
+
+		this->mSolidMasks[row + y] = solid;
+		this->mCoinMasks[row + y] = coin;
+		this->mGemMasks[row + y] = gem;
+	}
+}
+
+/* Executes actions according to different types of collision with game items */
+void GameBatch::Collide(int game, GameItem item) {
+	switch (item)
+	{
+	case BLOCK:
+		this->mGameState[game] = LOST;
+		this->mEvents[game] |= EVENT_GAME_OVER;
+		break;
+	case COIN:
+		this->mScore[game] += this->mCoinValue[game];
+		this->mEvents[game] |= EVENT_COIN;
+		break;
+	case GEM_DOUBLE_SCORE:
+		this->mDoubleScoreTime[game] = 0.0f;
+		if (!mDoubleScore[game]) {
+			this->mCoinValue[game] *= 2;
+			this->mDoubleScore[game] = true;
+		}
+		this->mEvents[game] |= EVENT_GEM;
+		break;
+	case GEM_SPEED:
+		this->mIncreaseSpeedTime[game] = 0.0f;
+		if (!mIncreaseSpeed[game]) {
+			this->mKinematics[game].SetMoveSpeed(this->mKinematics[game].GetMoveSpeed() * INCREASE_SPEED_FACTOR);
+			this->mIncreaseSpeed[game] = true;
+		}
+		this->mEvents[game] |= EVENT_GEM;
+		break;
+	case GEM_EXTRA_SCORE:
+		this->mExtraScoreTime[game] = 0.0f;
+		this->mExtraScore[game] = true;
+		this->mScore[game] += EXTRA_COINS_VALUE;
+		this->mEvents[game] |= EVENT_GEM;
+		break;
+	case GEM_REVERSED_MODE:
+		this->mDirectionsReversedTime[game] = 0.0f;
+		this->mDirectionsReversed[game] = true;
+		this->mEvents[game] |= EVENT_GEM;
+		break;
+	default:
+		break;
+	}
+}
+
+/* Picks a random block that can follow the given one and asks the level to read it ahead, returns its id */
+int GameBatch::PickNextBlock(int game, int previous) {
+	int block = this->mLevel->GetGraph().PickNext(previous, this->mBlockRandom[game]);
+	this->mLevel->Prefetch(block);
+	return block;
+}
+
+/* Generates all of the scene items with the code specialized for the grid dimensions */
+void GameBatch::GenerateSceneItems(int game) {
+	switch (this->mGridConfig) {
+	case GRID_DEFAULT:
+		this->GenerateSceneItems(DefaultGridDims(), game);
+		break;
+	case GRID_WIDE:
+		this->GenerateSceneItems(WideGridDims(), game);
+		break;
+	case GRID_DEEP:
+		this->GenerateSceneItems(DeepGridDims(), game);
+		break;
+	default:
+		this->GenerateSceneItems(this->mDims, game);
+		break;
+	}
+}
+
+/* Generates all of the scene items */
+template <class Dims>
+void GameBatch::GenerateSceneItems(const Dims& dims, int game) {
+	PROFILE_SCOPE("GameBatch::GenerateSceneItems");
+	// Clear the grid's first slice if we exceeded the whole tile
+	ClearGrid(dims, game);
+
+	while (this->mGridSize[game] < this->mViewSlices) {
+		// Keep where the streams are before the slice, a reset takes back the slices beyond the observation
+		if (!this->mFillCursors.empty()) {
+			FillCursor& cursor = this->mFillCursors[this->RingSlot(game, this->mGridSize[game])];
+			cursor.GemRandom = this->mRandom[game];
+			cursor.BlockRandom = this->mBlockRandom[game];
+			memcpy(cursor.NextBlocks, &this->mNextBlocks[game * LEVEL_READ_AHEAD_BLOCKS], sizeof(cursor.NextBlocks));
+			cursor.NextBlockHead = this->mNextBlockHead[game];
+			cursor.GeneratedBlock = (this->mGenerator != NULL) ? this->mGenerator->GetNextIndex(game) : 0;
+		}
+
+		// If we consumed the whole block then get a new one
+		if (mBlockSliceIdx[game] >= dims.Z) {
+			this->mBlockSliceIdx[game] = 0;
+
+			if (this->mGenerator != NULL) {
+				// Take the next generated block, which isn't one of the level's
+				this->mBlockId[game] = -1;
+				this->mGenerator->NextBlock(game, &this->mBlockCells[game * this->mBlockSize]);
+			}
+			else {
+				// Take the next game block and randomlly pick the one after the known ones, which is the last one of the ring
+				int* next = &this->mNextBlocks[game * LEVEL_READ_AHEAD_BLOCKS + this->mNextBlockHead[game]];
+				int last = this->mNextBlocks[game * LEVEL_READ_AHEAD_BLOCKS + (this->mNextBlockHead[game] + LEVEL_READ_AHEAD_BLOCKS - 1) % LEVEL_READ_AHEAD_BLOCKS];
+				this->mBlockId[game] = *next;
+				*next = this->PickNextBlock(game, last);
+				this->mNextBlockHead[game] = (this->mNextBlockHead[game] + 1) % LEVEL_READ_AHEAD_BLOCKS;
+
+				this->mLevel->CopyBlock(this->mBlockId[game], &this->mBlockCells[game * this->mBlockSize]);
+			}
+		}
+
+		// Fills the ring's next slice with the slice items
+		int z = this->mGridSize[game]++;
+		unsigned char* slice = &this->GridItem(dims, game, z, 0, 0);
+
+		Level::UnpackSlice(dims, &this->mBlockCells[game * this->mBlockSize], mBlockSliceIdx[game], slice);
+
+		for (int i = 0; i < dims.Y * dims.X; ++i) {
+			unsigned char item = slice[i];
+
+			// Don't always spawn the gem but some times spawn it and sometimes no (for more rarity)
+			if (item >= GEM_DOUBLE_SCORE && item <= GEM_REVERSED_MODE) {
+				int random = this->mRandom[game].NextInt(10);
+
+				if (random == 0) {
+					if (item == GEM_EXTRA_SCORE || item == GEM_REVERSED_MODE) {
+						if (this->mRandom[game].NextInt(2) == 0)
+							item = GEM_EXTRA_SCORE;
+						else
+							item = GEM_REVERSED_MODE;
+					}
+				}
+				else {
+					item = COIN;
+				}
+
+				slice[i] = item;
+			}
+		}
+
+		this->UpdateMasks(dims, game, z);
+
+		this->mBlockSliceIdx[game]++;
+	}
+}
+
+/* Moves the random streams of a game back to where they were before its given slice was filled */
+void GameBatch::RewindStreams(int game, int z) {
+	const FillCursor& cursor = this->mFillCursors[this->RingSlot(game, z)];
+
+	this->mRandom[game] = cursor.GemRandom;
+	this->mBlockRandom[game] = cursor.BlockRandom;
+	memcpy(&this->mNextBlocks[game * LEVEL_READ_AHEAD_BLOCKS], cursor.NextBlocks, sizeof(cursor.NextBlocks));
+	this->mNextBlockHead[game] = cursor.NextBlockHead;
+
+	if (this->mGenerator != NULL)
+		this->mGenerator->Rewind(game, cursor.GeneratedBlock);
+}
+
+/* Clears the passed scene items from the grid */
+template <class Dims>
+void GameBatch::ClearGrid(const Dims& dims, int game) {
+	if (this->mGridSize[game] == 0)
+		return;
+
+	int idx = abs(this->mKinematics[game].GetPositionZ() / LANE_DEPTH);
+
+	if (this->mGridIndexZ[game] < idx) {
+		this->mGridIndexZ[game] = idx;
+
+		// Drop the ring's first slice
+		this->mGridHead[game] = (this->mGridHead[game] + 1) & this->mRingMask;
+		this->mGridSize[game]--;
+
+		// Increase camera speed every new block, when its first slice enters the observation
+		if ((this->GetDistance(game) - 1) % dims.Z == 0)
+			this->mKinematics[game].AccelerateSpeed();
+
+		if (this->mGridIndexZ[game] >= WORLD_REBASE_SLICES)
+			this->RebaseWorld(game);
+	}
+}
+
+/*
+	Moves the world origin of a game forward by WORLD_REBASE_SLICES slices, back near the camera.
+	The grid slices are relative to the ring head so only the camera and the grid index move,
+	and the offset is a whole number of slices so the camera position stays exact
+*/
+void GameBatch::RebaseWorld(int game) {
+	this->mKinematics[game].Translate(0.0f, 0.0f, WORLD_REBASE_SLICES * LANE_DEPTH);
+	this->mGridIndexZ[game] -= WORLD_REBASE_SLICES;
+	this->mOriginIndexZ[game] += WORLD_REBASE_SLICES;
+}
+
+// The grid code is also called by the micro-benchmarks, outside of this file, for every grid configuration
+#define GAME_BATCH_INSTANTIATE_GRID_CODE(Dims) \
+	template unsigned char& GameBatch::GridItem(const Dims& dims, int game, int z, int y, int x); \
+	template void GameBatch::DetectCollision(const Dims& dims, int game, double xpos, double ypos); \
+	template void GameBatch::UpdateMasks(const Dims& dims, int game, int z); \
+	template void GameBatch::GenerateSceneItems(const Dims& dims, int game); \
+	template void GameBatch::ClearGrid(const Dims& dims, int game);
+
+GAME_BATCH_INSTANTIATE_GRID_CODE(DefaultGridDims)
+GAME_BATCH_INSTANTIATE_GRID_CODE(WideGridDims)
+GAME_BATCH_INSTANTIATE_GRID_CODE(DeepGridDims)
+GAME_BATCH_INSTANTIATE_GRID_CODE(GridDims)
@@ -0,0 +1,304 @@
+#pragma once
+
+// STL Includes
+#include <vector>
+#include <cstring>
+#include <climits>
+using namespace std;
+
+// Other includes
+#include "../Utils/ThreadPool.h"
+#include "../Utils/Bits.h"
+#include "../Utils/Profiler.h"
+#include "GameLogic.h"
+#include "BlockGenerator.h"
+#include "BlockGraph.h"
+
+
+// Observation constants of the default tunnel, the observations of a batch are GetObservationSize() items
+const int OBSERVATION_SLICE_SIZE = LANES_Y_COUNT * LANES_X_COUNT;
+const int OBSERVATION_SIZE = LANES_Z_COUNT * OBSERVATION_SLICE_SIZE;	// Items of the lanes ahead of a player, ordered [z][y][x]
+
+static_assert(LANES_X_MAX <= 64, "The X lanes of a row must fit a 64-bit row mask");
+
+// Grid dimensions with code specialized for them, the levels of other dimensions run the code sized at runtime
+typedef FixedGridDims<LANES_X_COUNT, LANES_Y_COUNT, LANES_Z_COUNT> DefaultGridDims;
+typedef FixedGridDims<5, LANES_Y_COUNT, LANES_Z_COUNT> WideGridDims;
+typedef FixedGridDims<LANES_X_COUNT, LANES_Y_COUNT, 2 * LANES_Z_COUNT> DeepGridDims;
+
+
+/*
+	Defines the grid dimensions the batch has specialized code for
+*/
+enum GridConfig {
+	GRID_RUNTIME,
+	GRID_DEFAULT,
+	GRID_WIDE,
+	GRID_DEEP,
+};
+
+
+/*
+	Class holding many independent games in structure-of-arrays form and stepping them together.
+	Every game state variable is a column with one entry per game, and the grids are fixed rings
+	of slices, so stepping a game touches only its own entries and never allocates.
+	The grid code is templated on the grid dimensions: the levels of the dimensions listed in GridConfig
+	run code with constant loop bounds, the other ones run the same code sized at runtime.
+	The rings hold the view distance ahead of the games, which can be longer than a block: the observations,
+	the collisions and the state hash only see the first block length of it, so the view distance changes
+	what is drawn but never how a game plays.
+	It has no dependency on OpenGL, GLFW or the sound engine so it can be stepped headless
+*/
+class GameBatch
+{
+	// Times the private grid code in isolation
+	friend class GameBatchBenchmark;
+
+private:
+	/*
+		Positions of the random streams of a game before one of its slices was filled
+	*/
+	struct FillCursor {
+		Random GemRandom;
+		Random BlockRandom;
+		int NextBlocks[LEVEL_READ_AHEAD_BLOCKS];
+		int NextBlockHead;
+		unsigned int GeneratedBlock;
+	};
+
+	// Level
+	const Level* mLevel;
+	int mGamesCount;
+
+	// Grid dimensions of the level
+	GridDims mDims;
+	GridConfig mGridConfig;
+	int mSliceCells;						// Items of a slice
+	int mGridCells;							// Items of a grid, and of an observation
+	int mBlockSize;							// Bytes of a packed block
+
+	// Look-ahead of the games
+	int mViewSlices;						// Slices kept filled ahead of a game
+	int mRingSlices;						// Slices of a ring, the power of two fitting the view slices
+	int mRingMask;
+
+	// Random generators used for gem rarity and for block selection
+	vector<Random> mRandom;
+	vector<Random> mBlockRandom;
+
+	// Camera kinematics
+	vector<CameraKinematics> mKinematics;
+
+	// Scene variables, the grid of a game is a ring of slices of [y][x] items
+	vector<unsigned char> mGrids;
+
+	// Row masks of every slice of the rings, one per y with the bit x set where there is a block, a coin or a gem
+	vector<uint64_t> mSolidMasks;
+	vector<uint64_t> mCoinMasks;
+	vector<uint64_t> mGemMasks;
+
+	// Stream positions before every slice of the rings was filled, kept when the view is longer than an observation
+	// so the slices filled beyond the observation can be taken back when a game is reset
+	vector<FillCursor> mFillCursors;
+	vector<int> mGridHead;
+	vector<int> mGridSize;
+	vector<unsigned char> mBorderLeft;
+	vector<unsigned char> mBorderRight;
+	vector<int> mBlockId;
+	vector<int> mGridIndexZ;
+	vector<long long> mOriginIndexZ;		// Slices the world origin was moved forward by since the game started
+	vector<int> mBlockSliceIdx;
+
+	// Current block of a game copied from the level, and a ring of the next LEVEL_READ_AHEAD_BLOCKS block ids
+	vector<unsigned char> mBlockCells;
+	vector<int> mNextBlocks;
+	vector<int> mNextBlockHead;
+
+	// Generator of the blocks after the initial one, or null to pick them from the level
+	BlockGenerator* mGenerator;
+
+	// Game properties and variables
+	vector<unsigned char> mGameState;
+	vector<int> mScore;
+	vector<int> mCoinValue;
+	vector<double> mGameTime;
+	vector<double> mDoubleScoreTime;
+	vector<double> mIncreaseSpeedTime;
+	vector<double> mExtraScoreTime;
+	vector<double> mDirectionsReversedTime;
+	vector<unsigned char> mDoubleScore;
+	vector<unsigned char> mIncreaseSpeed;
+	vector<unsigned char> mExtraScore;
+	vector<unsigned char> mDirectionsReversed;
+	vector<unsigned char> mEscReleased;
+
+	// Events raised during the current step
+	vector<unsigned int> mEvents;
+
+	// Step outputs, one entry per game, written either into the batch's buffers or into buffers owned by the caller
+	vector<unsigned char> mObservationsBuffer;
+	vector<float> mRewardsBuffer;
+	vector<unsigned char> mDonesBuffer;
+	unsigned char* mObservations;
+	float* mRewards;
+	unsigned char* mDones;
+
+	// Arguments of the current step, kept here so the parallel task captures nothing but the batch
+	const unsigned int* mStepActions;
+	double mStepDeltaTime;
+
+	// Threads stepping the games
+	ThreadPool* mThreadPool;
+
+public:
+	/*
+		Constructs the given number of games playing the given level, game i is seeded with seed + i.
+		The games keep the given number of slices ahead of them filled, or a block length if 0
+	*/
+	GameBatch(const Level* level, int gamesCount, unsigned int seed, int threadsCount = 1, int viewSlices = 0);
+
+	/* Destructs the games */
+	~GameBatch();
+
+	/* Returns the number of games */
+	int GetGamesCount() const;
+
+	/* Returns the number of threads stepping the games */
+	int GetThreadsCount() const;
+
+	/* Returns the grid dimensions of the games */
+	const GridDims& GetDims() const;
+
+	/* Returns the number of items of an observation */
+	int GetObservationSize() const;
+
+	/* Returns the number of slices kept ahead of the games */
+	int GetViewSlices() const;
+
+	/*
+		Makes the games play the blocks of the given generator, game i on its channel i, after the level's initial block.
+		Null goes back to picking the level's blocks. The games must be seeded again afterwards.
+		Generated blocks have the default dimensions, so a generator is refused for levels of other dimensions,
+		and so is a generator with fewer channels than games or with rings sized for a shorter view
+	*/
+	void SetGenerator(BlockGenerator* generator);
+
+	/* Restarts the random sequences, game i from seed + i, and resets all of the games */
+	void Seed(unsigned int seed);
+
+	/* Restarts the random sequence of a game from the given seed and resets it */
+	void Seed(int game, unsigned int seed);
+
+	/* Resets a game initial values */
+	void Reset(int game);
+
+	/* Writes the current observation of a game, with no reward and not done, into the step outputs */
+	void ClearOutputs(int game);
+
+	/*
+		Advances all of the games by the given time step, game i pressing the input keys actions[i].
+		Writes the observations, the score gained and whether the game was lost into the step outputs,
+		and restarts the lost games right away
+	*/
+	void Step(const unsigned int* actions, double deltaTime);
+
+	/* Advances a single game by the given time step with the given input keys, writes its step outputs and restarts it if it was lost */
+	void Step(int game, unsigned int input, double deltaTime);
+
+	/* Advances a single game by the given time step with the given input keys, returns the raised events */
+	unsigned int StepGame(int game, unsigned int input, double deltaTime);
+
+	/*
+		Makes the steps write into the given buffers of gamesCount * GetObservationSize() observations, gamesCount rewards
+		and gamesCount dones, which must outlive the batch or be replaced. Null buffers go back to the batch's own buffers.
+		The current observations are written into the new buffers
+	*/
+	void SetBuffers(unsigned char* observations, float* rewards, unsigned char* dones);
+
+	/* Returns the observations of the last step, GetObservationSize() items per game */
+	const unsigned char* GetObservations() const;
+
+	/* Returns the score gained by every game in the last step */
+	const float* GetRewards() const;
+
+	/* Returns whether every game was lost in the last step */
+	const unsigned char* GetDones() const;
+
+	/* Writes the items of the lanes ahead of a game, ordered [z][y][x], into the given buffer */
+	void GetObservation(int game, unsigned char* observation) const;
+
+	/* Returns the current state of a game */
+	GameState GetGameState(int game) const;
+
+	/* Returns the current score of a game */
+	int GetScore(int game) const;
+
+	/* Returns a hash of the whole state of a game, used to verify that replays are reproduced exactly */
+	unsigned long long GetStateHash(int game) const;
+
+	/* Returns the camera kinematics of a game */
+	const CameraKinematics& GetKinematics(int game) const;
+
+	/* Returns the number of slices a game has run since it started */
+	long long GetDistance(int game) const;
+
+	/* Copies the current state of a game into the given frame snapshot, with the items of its whole look-ahead */
+	void FillSnapshot(int game, FrameSnapshot& snapshot) const;
+
+private:
+	/* Steps the games in the given range with the arguments of the current step */
+	void StepRange(int begin, int end);
+
+	/* Advances a single game by the given time step with the given input keys, returns the raised events */
+	template <class Dims>
+	unsigned int StepGame(const Dims& dims, int game, unsigned int input, double deltaTime);
+
+	/* Returns the ring slot of a game's slice */
+	int RingSlot(int game, int z) const;
+
+	/* Returns the index of the first row mask of a game's slice */
+	template <class Dims>
+	int MaskRow(const Dims& dims, int game, int z) const;
+
+	/* Returns the grid item of a game at the given slice and lanes */
+	template <class Dims>
+	unsigned char& GridItem(const Dims& dims, int game, int z, int y, int x);
+
+	/* Returns the grid item of a game at the given slice and lanes */
+	template <class Dims>
+	unsigned char GridItem(const Dims& dims, int game, int z, int y, int x) const;
+
+	/* Processes the input keys */
+	void ProcessInput(int game, unsigned int input);
+
+	/* Detects the collision with the character and returns the colliding item */
+	template <class Dims>
+	void DetectCollision(const Dims& dims, int game, double xpos, double ypos);
+
+	/* Computes the row masks of a game's slice from its items */
+	template <class Dims>
+	void UpdateMasks(const Dims& dims, int game, int z);
+
+	/* Executes actions according to different types of collision with game items */
+	void Collide(int game, GameItem item);
+
+	/* Picks a random block that can follow the given one and asks the level to read it ahead, returns its id */
+	int PickNextBlock(int game, int previous);
+
+	/* Generates all of the scene items with the code specialized for the grid dimensions */
+	void GenerateSceneItems(int game);
+
+	/* Generates all of the scene items */
+	template <class Dims>
+	void GenerateSceneItems(const Dims& dims, int game);
+
+	/* Moves the random streams of a game back to where they were before its given slice was filled */
+	void RewindStreams(int game, int z);
+
+	/* Clears the passed scene items from the grid */
+	template <class Dims>
+	void ClearGrid(const Dims& dims, int game);
+
+	/* Moves the world origin of a game forward by WORLD_REBASE_SLICES slices, back near the camera */
+	void RebaseWorld(int game);
+};
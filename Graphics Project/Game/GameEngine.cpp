@@ -1,57 +1,289 @@
 #include "GameEngine.h"
 
-/* Constructs a new game engine with all related objects and components */
-GameEngine::GameEngine(int width, int height, bool fullscreen) {
+/* Constructs a new game engine with all related objects and components, drawing into a window or into an offscreen target */
+GameEngine::GameEngine(int width, int height, bool fullscreen, bool offscreen) {
 	this->mGame = NULL;
 	this->mTimer = new FrameTimer();
-	InitWindow(width, height, "", fullscreen);
+	this->mRunning = false;
+	this->mWind = NULL;
+	this->mOffscreen = NULL;
+	this->mTarget = NULL;
+	this->mWidth = width;
+	this->mHeight = height;
+
+	if (offscreen)
+		InitOffscreen(width, height);
+	else
+		InitWindow(width, height, "", fullscreen);
+
+	this->mGpuTimer = new GpuTimer();
+	this->mScene = (this->mWind != NULL || this->mTarget != NULL) ? new SceneTarget(width, height, DEFAULT_ANTI_ALIASING) : NULL;
+	this->mResolution = NULL;
+
+	if (!offscreen)
+		this->SetDynamicResolution(RESOLUTION_DEFAULT_BUDGET);
+
+	this->mFrameHitches = NULL;
+	this->mTickHitches = NULL;
+	this->mCapture = NULL;
+	this->mScreenshot = NULL;
+	this->mScreenshotsCount = 0;
 }
 
 /* Destructs the game engine and free resources */
 GameEngine::~GameEngine() {
+	delete this->mGpuTimer;
+	delete this->mFrameHitches;
+	delete this->mTickHitches;
+
+	// The captures free their buffers while the context is still alive
+	delete this->mCapture;
+	delete this->mScreenshot;
+	delete this->mScene;
+	delete this->mResolution;
+
 	// Destroy window
-	glfwDestroyWindow(this->mWind);
-	glfwTerminate();
+	if (this->mWind != NULL) {
+		glfwDestroyWindow(this->mWind);
+		glfwTerminate();
+	}
+
+	// Destroy the offscreen target and its context
+	delete this->mTarget;
+	delete this->mOffscreen;
 }
 
 /* Registers the game that the engine is going to run */
 void GameEngine::RegisterGame(Game* game, const char* title) {
 	this->mGame = game;
-	glfwSetWindowTitle(this->mWind, title);
+
+	if (this->mWind != NULL)
+		glfwSetWindowTitle(this->mWind, title);
+}
+
+/* Writes a trace of the profiled frames before any frame or simulation tick taking longer than
+   the given multiple of the median, into files starting with the given prefix */
+void GameEngine::SetHitchDetection(double factor, const string& pathPrefix) {
+	delete this->mFrameHitches;
+	delete this->mTickHitches;
+
+	// A tick longer than its time step makes the simulation fall behind
+	this->mFrameHitches = new HitchDetector("Frame", factor, HITCH_MIN_FRAME_TIME, pathPrefix);
+	this->mTickHitches = new HitchDetector("Tick", factor, SIMULATION_TICK_TIME, pathPrefix);
+}
+
+/* Scales the resolution of the scene every frame so that drawing it takes the given GPU time, in seconds, or fixes it back to the frame's if 0.
+   A window holds RESOLUTION_DEFAULT_BUDGET by default, an offscreen engine draws at a fixed scale so its frames are reproducible */
+void GameEngine::SetDynamicResolution(double budget) {
+	delete this->mResolution;
+	this->mResolution = (budget > 0) ? new ResolutionController(budget) : NULL;
+
+	if (this->mScene != NULL)
+		this->mScene->SetScale(1.0);
+}
+
+/* Draws the scene at the given fixed scale of the frame's resolution, stopping its dynamic scaling */
+void GameEngine::SetResolutionScale(double scale) {
+	delete this->mResolution;
+	this->mResolution = NULL;
+
+	if (this->mScene != NULL)
+		this->mScene->SetScale(scale);
+}
+
+/* Returns the scale of the scene's resolution */
+double GameEngine::GetResolutionScale() const {
+	return (this->mScene != NULL) ? this->mScene->GetScale() : 1.0;
+}
+
+/* Changes the anti-aliasing of the scene, from the next frame on (rendering thread) */
+void GameEngine::SetAntiAliasing(AntiAliasing antiAliasing) {
+	if (this->mScene != NULL)
+		this->mScene->SetAntiAliasing(antiAliasing);
+}
+
+/* Returns the anti-aliasing of the scene */
+AntiAliasing GameEngine::GetAntiAliasing() const {
+	return (this->mScene != NULL) ? this->mScene->GetAntiAliasing() : DEFAULT_ANTI_ALIASING;
+}
+
+/* Records the frames into the given path, as a Y4M video if it ends with .y4m or else as numbered PNG images,
+   returns false if the frames are already recorded (rendering thread) */
+bool GameEngine::StartCapture(const string& path, int frameRate) {
+	if (this->mCapture != NULL)
+		return false;
+
+	this->mCapture = new FrameCapture(path, FrameCapture::GetFormat(path), this->mWidth, this->mHeight, frameRate);
+	return true;
+}
+
+/* Stops recording the frames, once the frames in flight are written (rendering thread) */
+void GameEngine::StopCapture() {
+	delete this->mCapture;
+	this->mCapture = NULL;
+}
+
+/* Saves the next frame into screenshot_N.png, unless the previous screenshot is still being saved (rendering thread) */
+void GameEngine::TakeScreenshot() {
+	if (this->mScreenshot != NULL)
+		return;
+
+	string path = "screenshot_" + to_string(this->mScreenshotsCount++) + ".png";
+	this->mScreenshot = new FrameCapture(path, CAPTURE_PNG, this->mWidth, this->mHeight, CAPTURE_DEFAULT_FRAME_RATE, 1);
 }
 
 /* Starts the main game loop */
 void GameEngine::Run() {
-	if (this->mGame == NULL)
+	if (this->mGame == NULL || this->mWind == NULL)
 		return;
 
 	this->mTimer->FramesCount = 0;
 	this->mTimer->LastTime = this->mTimer->LastFrameTime = glfwGetTime();
 
+	// Game logic runs on its own thread, this thread only polls input and draws the published snapshots
+	this->mRunning = true;
+	thread simulation(&GameEngine::Simulate, this);
+	Profiler::SetThreadName("Render");
+
 	while (glfwWindowShouldClose(this->mWind) == GL_FALSE) {
 		this->mTimer->ProcessFrameTime(glfwGetTime());
+
+		// The previous frame is over and its events collected by the profiler
+		if (this->mFrameHitches != NULL && this->mFrameHitches->AddSample(this->mTimer->ElapsedFramesTime)) {
+			vector<pair<string, string>> state;
+			this->mGame->DescribeState(state);
+			this->mFrameHitches->Dump(this->mTimer->ElapsedFramesTime, state);
+		}
+
 		this->ProcessInput();
-		this->Update();
 		this->Render();
+		Profiler::EndFrame();
+	}
+
+	this->mRunning = false;
+	simulation.join();
+}
+
+/* Draws a frame at the given time, in seconds, without polling any input (rendering thread) */
+void GameEngine::RenderFrame(double time) {
+	if (this->mGame == NULL)
+		return;
+
+	this->mTimer->ProcessFrameTime(time);
+	this->Render();
+	Profiler::EndFrame();
+}
+
+/* Returns whether the engine draws into an offscreen target instead of a window */
+bool GameEngine::IsOffscreen() const {
+	return this->mWind == NULL;
+}
+
+/* Returns the offscreen target, or null when drawing into a window */
+Framebuffer* GameEngine::GetTarget() const {
+	return this->mTarget;
+}
+
+/* Returns the width of the frames */
+int GameEngine::GetWidth() const {
+	return this->mWidth;
+}
+
+/* Returns the height of the frames */
+int GameEngine::GetHeight() const {
+	return this->mHeight;
+}
+
+/* Runs the game logic with a fixed time step on the simulation thread */
+void GameEngine::Simulate() {
+	double nextTickTime = glfwGetTime();
+	Profiler::SetThreadName("Simulation");
+
+	while (this->mRunning) {
+		double tickBegin = glfwGetTime();
+
+		{
+			PROFILE_SCOPE("GameEngine::Update");
+			this->mGame->Update(SIMULATION_TICK_TIME);
+		}
+
+		double tickTime = glfwGetTime() - tickBegin;
+
+		if (this->mTickHitches != NULL && this->mTickHitches->AddSample(tickTime)) {
+			vector<pair<string, string>> state;
+			this->mGame->DescribeState(state);
+			this->mTickHitches->Dump(tickTime, state);
+		}
+
+		nextTickTime += SIMULATION_TICK_TIME;
+
+		double time = glfwGetTime();
+
+		// Skip the ticks we can't catch up with instead of spiraling behind
+		if (time - nextTickTime > SIMULATION_MAX_LAG) {
+			nextTickTime = time;
+		}
+		else if (nextTickTime > time) {
+			this_thread::sleep_for(chrono::duration<double>(nextTickTime - time));
+		}
 	}
 }
 
 /* Receives user input and processes it for the next frame */
 void GameEngine::ProcessInput() {
+	PROFILE_SCOPE("GameEngine::ProcessInput");
 	glfwPollEvents();
 	this->mGame->ProcessInput();
 }
 
-/* Updates the game for the next frame  */
-void GameEngine::Update() {
-	this->mGame->Update();
-}
-
 /* Clears the screen and draws the new frame */
 void GameEngine::Render() {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	this->mGame->Render();
-	glfwSwapBuffers(mWind);
+	PROFILE_SCOPE("GameEngine::Render");
+	this->mGpuTimer->BeginFrame();
+
+	// The scene is drawn at the scaled resolution, then the HUD over it at the frame's one
+	this->mScene->Begin();
+	this->mGame->RenderScene();
+
+	{
+		PROFILE_GPU_SCOPE(this->mGpuTimer, "GPU::Upscale");
+		this->mScene->End(this->mTarget != NULL ? this->mTarget->GetID() : 0);
+	}
+
+	glClear(GL_DEPTH_BUFFER_BIT);
+	this->mGame->RenderHud();
+
+	// The frame is read back before it is presented, and mapped frames later
+	if (this->mCapture != NULL)
+		this->mCapture->Capture(this->mTarget);
+
+	if (this->mScreenshot != NULL) {
+		this->mScreenshot->Capture(this->mTarget);
+
+		if (this->mScreenshot->IsDone()) {
+			delete this->mScreenshot;
+			this->mScreenshot = NULL;
+		}
+	}
+
+	{
+		PROFILE_SCOPE("SwapBuffers");
+		PROFILE_GPU_SCOPE(this->mGpuTimer, "GPU::SwapBuffers");
+
+		// Without a window to present to, the frame is over once the GPU is done with it
+		if (this->mWind != NULL)
+			glfwSwapBuffers(mWind);
+		else
+			glFinish();
+	}
+
+	this->mGpuTimer->EndFrame();
+	RenderStats::EndFrame();
+
+	// Scale the next frames from the time the GPU took to draw the scene a few frames ago
+	double sceneTime, sceneScale;
+	if (this->mScene->ReadTime(sceneTime, sceneScale) && this->mResolution != NULL)
+		this->mScene->SetScale(this->mResolution->Update(sceneTime, sceneScale));
 }
 
 /* Initializes the game window */
@@ -66,7 +298,7 @@ void GameEngine::InitWindow(int width, int height, const char* title, bool fulls
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	glfwWindowHint(GLFW_SAMPLES, 4);
+	glfwWindowHint(GLFW_SAMPLES, 0);			// The scene is multisampled in its own target
 	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
 	// Create a GLFWwindow object that we can use for GLFW's functions
@@ -89,15 +321,49 @@ void GameEngine::InitWindow(int width, int height, const char* title, bool fulls
 		return;
 	}
 
+	this->InitGLState(width, height);
+
+	// Disable the mouse cursor
+	glfwSetInputMode(this->mWind, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+}
+
+/* Initializes a context without window and the target it draws into */
+void GameEngine::InitOffscreen(int width, int height) {
+	this->mOffscreen = new OffscreenContext();
+
+	if (!this->mOffscreen->Create())
+		return;
+
+	glewExperimental = GL_TRUE;
+	GLenum error = glewInit();
+
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	// GLEW built for GLX finds no X display, the GL functions are loaded nonetheless
+	if (error == GLEW_ERROR_NO_GLX_DISPLAY)
+		error = GLEW_OK;
+#endif
+
+	if (error != GLEW_OK) {
+		std::cout << "GAME::ERROR: Failed to initialize GLEW on the offscreen context" << std::endl;
+		return;
+	}
+
+	// The frames are composed in the target, the scene drawn into its own target and scaled into it
+	this->mTarget = new Framebuffer(width, height);
+	this->mTarget->Bind();
+
+	this->InitGLState(width, height);
+}
+
+/* Sets the OpenGL options the game is drawn with */
+void GameEngine::InitGLState(int width, int height) {
 	// Define viewport's dimensions as Window's size
 	glViewport(0, 0, width, height);
 
 	// Cull triangles which normal is not towards the camera
 	glEnable(GL_CULL_FACE);
 
-	// Setup OpenGL options
-	glEnable(GL_MULTISAMPLE);
-	glEnable(GL_DEPTH_TEST);
+	// Setup OpenGL options, multisampling only applies to the scene's target when its anti-aliasing is MSAA
 	glEnable(GL_MULTISAMPLE);
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);		// Accept fragment if it closer to the camera than the former one
@@ -109,7 +375,4 @@ void GameEngine::InitWindow(int width, int height, const char* title, bool fulls
 
 	// Set the color used when clearing the screen
 	glClearColor(0.1f, 0.4f, 0.6f, 1.0f);
-
-	// Disable the mouse cursor
-	glfwSetInputMode(this->mWind, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 }
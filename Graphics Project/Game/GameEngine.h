@@ -1,5 +1,11 @@
 #pragma once
 
+// STL Includes
+#include <atomic>
+#include <thread>
+#include <chrono>
+using namespace std;
+
 // GL Includes
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -7,7 +13,27 @@
 // Other includes
 #include "../Game/Game.h"
 #include "../Utils/FrameTimer.h"
+#include "../Utils/Profiler.h"
+#include "../Utils/GpuTimer.h"
+#include "../Utils/HitchDetector.h"
+#include "../Utils/OffscreenContext.h"
+#include "../Utils/FrameCapture.h"
+#include "../Utils/ResolutionController.h"
+#include "../Components/Framebuffer.h"
+#include "../Components/SceneTarget.h"
+
+// Simulation constants
+const double SIMULATION_MAX_LAG = 0.25;				// Maximum time the simulation may fall behind before skipping ticks
+
+// Scene constants
+const AntiAliasing DEFAULT_ANTI_ALIASING = AA_MSAA_4X;	// The HUD drawn over the scene is never anti-aliased
+const double RESOLUTION_DEFAULT_BUDGET = 0.012;		// GPU time of the scene a window holds, leaving the rest of a 60 Hz frame to the HUD
 
+// Hitch constants
+const double HITCH_MIN_FRAME_TIME = 0.010;			// Shorter frames are never hitches, whatever the median
+
+// Forward class declaration
+class Game;
 
 /*
 	Game engine responsible of running the given game
@@ -18,12 +44,25 @@ class GameEngine
 
 private:
 	GLFWwindow* mWind;
+	OffscreenContext* mOffscreen;		// Context of an engine without window
+	Framebuffer* mTarget;				// Where an engine without window draws
+	SceneTarget* mScene;				// Where the 3D scene is drawn before being scaled into the frame
+	ResolutionController* mResolution;	// Scale of the scene, null when it is fixed
+	int mWidth;
+	int mHeight;
 	Game* mGame;
 	FrameTimer* mTimer;
+	GpuTimer* mGpuTimer;
+	HitchDetector* mFrameHitches;
+	HitchDetector* mTickHitches;
+	FrameCapture* mCapture;				// Recording of the frames, null when not recording
+	FrameCapture* mScreenshot;			// Screenshot being read back, null when none
+	int mScreenshotsCount;
+	atomic<bool> mRunning;
 
 public:
-	/* Constructs a new game engine with all related objects and components */
-	GameEngine(int width, int height, bool fullscreen = false);
+	/* Constructs a new game engine with all related objects and components, drawing into a window or into an offscreen target */
+	GameEngine(int width, int height, bool fullscreen = false, bool offscreen = false);
 
 	/* Destructs the game engine and free resources */
 	~GameEngine();
@@ -31,19 +70,70 @@ public:
 	/* Registers the game that the engine is going to run */
 	void RegisterGame(Game* game, const char* title);
 
+	/* Writes a trace of the profiled frames before any frame or simulation tick taking longer than
+	   the given multiple of the median, into files starting with the given prefix */
+	void SetHitchDetection(double factor, const string& pathPrefix);
+
+	/* Scales the resolution of the scene every frame so that drawing it takes the given GPU time, in seconds, or fixes it back to the frame's if 0.
+	   A window holds RESOLUTION_DEFAULT_BUDGET by default, an offscreen engine draws at a fixed scale so its frames are reproducible */
+	void SetDynamicResolution(double budget);
+
+	/* Draws the scene at the given fixed scale of the frame's resolution, stopping its dynamic scaling */
+	void SetResolutionScale(double scale);
+
+	/* Returns the scale of the scene's resolution */
+	double GetResolutionScale() const;
+
+	/* Changes the anti-aliasing of the scene, from the next frame on (rendering thread) */
+	void SetAntiAliasing(AntiAliasing antiAliasing);
+
+	/* Returns the anti-aliasing of the scene */
+	AntiAliasing GetAntiAliasing() const;
+
+	/* Records the frames into the given path, as a Y4M video if it ends with .y4m or else as numbered PNG images,
+	   returns false if the frames are already recorded (rendering thread) */
+	bool StartCapture(const string& path, int frameRate = CAPTURE_DEFAULT_FRAME_RATE);
+
+	/* Stops recording the frames, once the frames in flight are written (rendering thread) */
+	void StopCapture();
+
+	/* Saves the next frame into screenshot_N.png, unless the previous screenshot is still being saved (rendering thread) */
+	void TakeScreenshot();
+
 	/* Starts the main game loop */
 	void Run();
 
+	/* Draws a frame at the given time, in seconds, without polling any input (rendering thread) */
+	void RenderFrame(double time);
+
+	/* Returns whether the engine draws into an offscreen target instead of a window */
+	bool IsOffscreen() const;
+
+	/* Returns the offscreen target, or null when drawing into a window */
+	Framebuffer* GetTarget() const;
+
+	/* Returns the width of the frames */
+	int GetWidth() const;
+
+	/* Returns the height of the frames */
+	int GetHeight() const;
+
 private:
+	/* Runs the game logic with a fixed time step on the simulation thread */
+	void Simulate();
+
 	/* Receives user input and processes it for the next frame */
 	void ProcessInput();
 
-	/* Updates the game for the next frame  */
-	void Update();
-
 	/* Clears the screen and draws the new frame */
 	void Render();
 
 	/* Initializes the game window */
 	void InitWindow(int width, int height, const char* title, bool fullscreen);
+
+	/* Initializes a context without window and the target it draws into */
+	void InitOffscreen(int width, int height);
+
+	/* Sets the OpenGL options the game is drawn with */
+	void InitGLState(int width, int height);
 };
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "GameLogic.h"
+#include "GameBatch.h"
+
+/* Constructs a new game logic playing the given level, seeing the given number of slices ahead or a block if 0 */
+GameLogic::GameLogic(const Level* level, unsigned int seed, int viewSlices) {
+	this->mBatch = new GameBatch(level, 1, seed, 1, viewSlices);
+}
+
+/* Destructs the game logic */
+GameLogic::~GameLogic() {
+	delete this->mBatch;
+}
+
+/* Makes the game play the blocks of the given generator, or the level's blocks if null */
+void GameLogic::SetGenerator(BlockGenerator* generator) {
+	this->mBatch->SetGenerator(generator);
+}
+
+/* Restarts the random sequence from the given seed and resets the game */
+void GameLogic::Seed(unsigned int seed) {
+	this->mBatch->Seed(0, seed);
+}
+
+/* Resets the game initial values */
+void GameLogic::Reset() {
+	this->mBatch->Reset(0);
+}
+
+/* Advances the game by the given time step with the given input keys, returns the raised events */
+unsigned int GameLogic::Step(unsigned int input, double deltaTime) {
+	return this->mBatch->StepGame(0, input, deltaTime);
+}
+
+/* Returns the current game state */
+GameState GameLogic::GetGameState() const {
+	return this->mBatch->GetGameState(0);
+}
+
+/* Returns the current score */
+int GameLogic::GetScore() const {
+	return this->mBatch->GetScore(0);
+}
+
+/* Returns a hash of the whole game state, used to verify that replays are reproduced exactly */
+unsigned long long GameLogic::GetStateHash() const {
+	return this->mBatch->GetStateHash(0);
+}
+
+/* Returns the camera kinematics */
+const CameraKinematics& GameLogic::GetKinematics() const {
+	return this->mBatch->GetKinematics(0);
+}
+
+/* Returns the number of slices run since the game started */
+long long GameLogic::GetDistance() const {
+	return this->mBatch->GetDistance(0);
+}
+
+/* Returns the number of slices kept ahead of the game */
+int GameLogic::GetViewSlices() const {
+	return this->mBatch->GetViewSlices();
+}
+
+/* Copies the current game state into the given frame snapshot */
+void GameLogic::FillSnapshot(FrameSnapshot& snapshot) const {
+	this->mBatch->FillSnapshot(0, snapshot);
+}
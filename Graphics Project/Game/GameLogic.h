@@ -0,0 +1,205 @@
+#pragma once
+
+// STL Includes
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+using namespace std;
+
+// Other includes
+#include "../Components/CameraKinematics.h"
+#include "../Utils/Random.h"
+#include "Level.h"
+
+
+/*
+	Defines several game states
+*/
+enum GameState {
+	RUNNING,
+	PAUSED,
+	LOST
+};
+
+
+/*
+	Defines the input keys consumed by the game logic,
+	each key is a single bit in the input state
+*/
+enum InputKey {
+	INPUT_LEFT = 1 << 0,
+	INPUT_RIGHT = 1 << 1,
+	INPUT_JUMP = 1 << 2,
+	INPUT_PAUSE = 1 << 3,
+	INPUT_QUIT = 1 << 4,
+	INPUT_REPLAY = 1 << 5
+};
+
+
+/*
+	Defines the events raised by a game logic step, each event is a single bit.
+	Used to trigger sounds and other side effects outside of the game logic
+*/
+enum GameEvent {
+	EVENT_JUMP = 1 << 0,
+	EVENT_COIN = 1 << 1,
+	EVENT_GEM = 1 << 2,
+	EVENT_GAME_OVER = 1 << 3,
+	EVENT_RESET = 1 << 4,
+	EVENT_QUIT = 1 << 5
+};
+
+
+// Simulation constants
+const int SIMULATION_TICK_RATE = 120;	// Fixed ticks per second of the game logic
+const double SIMULATION_TICK_TIME = 1.0 / SIMULATION_TICK_RATE;
+const double SIMULATION_MAX_SUBSTEP_TIME = SIMULATION_TICK_TIME;	// Longest camera update between two collision tests
+const int WORLD_REBASE_SLICES = 1024;	// Slices run before the world origin is moved back to the camera
+
+// View constants
+const int VIEW_SLICES_MAX = 512;		// Longest look-ahead of a game, in slices
+const int VIEW_CHUNK_SLICES = 16;		// Slices of the world grouped into a render chunk
+const int VIEW_CHUNKS_MAX = VIEW_SLICES_MAX / VIEW_CHUNK_SLICES + 1;	// Chunks a look-ahead can overlap
+
+// Lane constants
+const double LANE_WIDTH = 1.5f;
+const double LANE_HEIGHT = 1.0f;
+const double LANE_DEPTH = 1.5f;
+
+// Camera constants
+const double GRAVITY_POS = LANE_HEIGHT;
+const double CHARACTER_OFFSET = LANE_DEPTH * 1.5;
+const double CAMERA_SPEED_INIT = 4;
+const double CAMERA_JUMP_OFFSET = LANE_HEIGHT;
+const double CAMERA_ACCELERATION = 0.5f;
+
+// Game constants
+const int COIN_VALUE = 1;
+const int EXTRA_COINS_VALUE = 100;
+const double DOUBLE_SCORE_DURATION = 10.0f;
+const double INCREASE_SPEED_DURATION = 10.0f;
+const double INCREASE_SPEED_FACTOR = 1.25f;
+const double EXTRA_SCORE_DURATION = 2.0f;
+const double DIRECTIONS_REVERSED_DURATION = 10.0f;
+
+
+/*
+	A visible game item positioned by its lane indices in the grid
+*/
+struct SceneItem {
+	GameItem Type;
+	int X;
+	int Y;
+	int Z;
+};
+
+
+/*
+	Items of a frame snapshot in a chunk of VIEW_CHUNK_SLICES slices of the world, with their bounds in lanes.
+	The key changes whenever the items of the chunk or their positions change, so the renderer can keep
+	what it built from a chunk until then
+*/
+struct SceneChunk {
+	int Index;					// Index of the chunk in the world, its first slice is Index * VIEW_CHUNK_SLICES
+	int FirstItem;
+	int ItemsCount;
+	unsigned long long Key;
+	int MinX, MaxX;
+	int MinY, MaxY;
+	int MinZ, MaxZ;				// Slices of the world, as GridIndexZ + item Z
+};
+
+
+/*
+	Immutable copy of the game state needed to draw a single frame.
+	Filled by the simulation thread and consumed by the rendering thread
+*/
+struct FrameSnapshot {
+	// Camera
+	double CameraX;
+	double CameraY;
+	double CameraZ;
+
+	// Scene items of the look-ahead, ordered by slice and grouped by chunk.
+	// The items are sized for the grid and look-ahead of the game filling the snapshot on its first fill,
+	// and only grow when the look-ahead does
+	GridDims Dims;
+	int ViewSlices;
+	int GridIndexZ;
+	int ItemsCount;
+	vector<SceneItem> Items;
+	int ChunksCount;
+	SceneChunk Chunks[VIEW_CHUNKS_MAX];
+
+	// HUD values
+	GameState State;
+	int Score;
+	int HighScore;
+	double GameTime;
+	double DoubleScoreTime;
+	double IncreaseSpeedTime;
+	double ExtraScoreTime;
+	double DirectionsReversedTime;
+	bool DoubleScore;
+	bool IncreaseSpeed;
+	bool ExtraScore;
+	bool DirectionsReversed;
+};
+
+
+class GameBatch;
+class BlockGenerator;
+
+
+/*
+	Class containing the game state and rules of a single game.
+	It is a batch of one game, so it plays exactly like the games stepped by GameBatch.
+	It has no dependency on OpenGL, GLFW or the sound engine so it can be stepped headless
+*/
+class GameLogic
+{
+private:
+	// The single game
+	GameBatch* mBatch;
+
+public:
+	/* Constructs a new game logic playing the given level with the given random seed, seeing the given number of slices ahead or a block if 0 */
+	GameLogic(const Level* level, unsigned int seed, int viewSlices = 0);
+
+	/* Destructs the game logic */
+	~GameLogic();
+
+	/* Makes the game play the blocks of the given generator, or the level's blocks if null. The game must be seeded again afterwards */
+	void SetGenerator(BlockGenerator* generator);
+
+	/* Restarts the random sequence from the given seed and resets the game */
+	void Seed(unsigned int seed);
+
+	/* Resets the game initial values */
+	void Reset();
+
+	/* Advances the game by the given time step with the given input keys, returns the raised events */
+	unsigned int Step(unsigned int input, double deltaTime);
+
+	/* Returns the current game state */
+	GameState GetGameState() const;
+
+	/* Returns the current score */
+	int GetScore() const;
+
+	/* Returns a hash of the whole game state, used to verify that replays are reproduced exactly */
+	unsigned long long GetStateHash() const;
+
+	/* Returns the camera kinematics */
+	const CameraKinematics& GetKinematics() const;
+
+	/* Returns the number of slices run since the game started */
+	long long GetDistance() const;
+
+	/* Returns the number of slices kept ahead of the game */
+	int GetViewSlices() const;
+
+	/* Copies the current game state into the given frame snapshot */
+	void FillSnapshot(FrameSnapshot& snapshot) const;
+};
@@ -0,0 +1,399 @@
+#include "Level.h"
+#include "BlockGraph.h"
+#include <sys/stat.h>
+
+/* Writes an unsigned value in little endian byte order */
+static void WriteValue(ofstream& fout, unsigned int value) {
+	for (int i = 0; i < 4; ++i) {
+		fout.put((char)((value >> (i * 8)) & 0xFF));
+	}
+}
+
+/* Reads an unsigned value in little endian byte order */
+static unsigned int ReadValue(const unsigned char* data) {
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+/* Reads the next line that is neither empty nor a comment, returns false at the end of the file */
+static bool ReadContentLine(ifstream& fin, string& line, int& lineNumber) {
+	while (getline(fin, line)) {
+		lineNumber++;
+
+		if (line.size() > 0 && line[0] != '#')
+			return true;
+	}
+
+	return false;
+}
+
+/* Parses a line holding a single count, returns false if it holds anything else */
+static bool ParseCount(const string& line, int& count) {
+	istringstream fin(line);
+	string rest;
+
+	return (fin >> count) && !(fin >> rest);
+}
+
+/* Constructs an empty level */
+Level::Level() {
+	this->mBlocks = NULL;
+	this->mStream = NULL;
+	this->mGraph = new BlockGraph();
+	this->mDims = DEFAULT_GRID_DIMS;
+	this->mBlockSize = LEVEL_BLOCK_SIZE;
+	this->mBlocksCount = 0;
+}
+
+/* Destructs the level */
+Level::~Level() {
+	this->Close();
+	delete this->mGraph;
+}
+
+/* Loads the level blocks from the given level pack or text file, returns false on failure */
+bool Level::Load(const string& path) {
+	ifstream fin;
+	fin.open(path, ios::binary);
+	if (!fin.is_open()) {
+		std::cout << "GAME::ERROR: Could not load file " << path << std::endl;
+		return false;
+	}
+
+	// Level packs start with the magic number, text files with a comment or the blocks count
+	unsigned char magic[4] = { 0, 0, 0, 0 };
+	fin.read((char*)magic, 4);
+	fin.close();
+
+	if (ReadValue(magic) == LEVEL_PACK_MAGIC)
+		return this->LoadPack(path);
+	else
+		return this->LoadText(path);
+}
+
+/* Loads the level pack, or the text level it is compiled from when the pack is missing or older, returns false on failure */
+bool Level::LoadLatest(const string& packPath, const string& textPath) {
+	struct stat packStat, textStat;
+	if (stat(packPath.c_str(), &packStat) != 0)
+		return this->Load(textPath);
+
+	if (stat(textPath.c_str(), &textStat) == 0 && textStat.st_mtime > packStat.st_mtime) {
+		std::cout << "GAME::WARNING: Level pack " << packPath << " is older than " << textPath << ", loading the text level, rebuild the pack with LevelCompiler" << std::endl;
+		return this->Load(textPath);
+	}
+
+	return this->Load(packPath);
+}
+
+/* Streams the level blocks from the given level pack keeping at most the given number of blocks in memory, returns false on failure */
+bool Level::Stream(const string& path, int cacheBlocks) {
+	ifstream fin;
+	fin.open(path, ios::binary | ios::ate);
+	if (!fin.is_open()) {
+		std::cout << "GAME::ERROR: Could not load file " << path << std::endl;
+		return false;
+	}
+
+	size_t size = (size_t)fin.tellg();
+	unsigned char header[LEVEL_PACK_HEADER_SIZE] = {};
+	fin.seekg(0);
+	fin.read((char*)header, LEVEL_PACK_HEADER_SIZE);
+	fin.close();
+
+	GridDims dims;
+	int blocksCount = ReadPackHeader(path, header, size, dims);
+	if (blocksCount == 0)
+		return false;
+
+	this->Close();
+	this->SetDims(path, dims);
+	this->mStream = new LevelStream();
+
+	if (!this->mStream->Open(path, LEVEL_PACK_HEADER_SIZE, this->mBlockSize, blocksCount, cacheBlocks)) {
+		this->Close();
+		return false;
+	}
+
+	this->mBlocksCount = blocksCount;
+	this->mGraph->Build(*this);
+	return true;
+}
+
+/* Returns the stream of a streamed level, or null if its blocks are in memory */
+const LevelStream* Level::GetStream() const {
+	return this->mStream;
+}
+
+/* Returns the graph of the blocks that can follow each block */
+const BlockGraph& Level::GetGraph() const {
+	return *this->mGraph;
+}
+
+/* Saves the level blocks into the given level pack file, returns false on failure */
+bool Level::Save(const string& path) const {
+	if (this->mBlocks == NULL) {
+		std::cout << "GAME::ERROR: Only levels held in memory can be saved" << std::endl;
+		return false;
+	}
+
+	// The pack would be refused when loaded
+	if (this->mBlocksCount < LEVEL_MIN_BLOCKS) {
+		std::cout << "GAME::ERROR: Level pack " << path << " not saved, a level needs at least " << LEVEL_MIN_BLOCKS << " blocks" << std::endl;
+		return false;
+	}
+
+	ofstream fout;
+	fout.open(path, ios::binary);
+	if (!fout.is_open()) {
+		std::cout << "GAME::ERROR: Could not save file " << path << std::endl;
+		return false;
+	}
+
+	WriteValue(fout, LEVEL_PACK_MAGIC);
+	WriteValue(fout, LEVEL_PACK_VERSION);
+	WriteValue(fout, this->mDims.X);
+	WriteValue(fout, this->mDims.Y);
+	WriteValue(fout, this->mDims.Z);
+	WriteValue(fout, this->mBlocksCount);
+	WriteValue(fout, this->mBlockSize);
+	WriteValue(fout, 0);
+
+	fout.write((const char*)this->mBlocks, (streamsize)this->mBlocksCount * this->mBlockSize);
+
+	fout.close();
+	return !fout.fail();
+}
+
+/* Returns the number of blocks in the level */
+int Level::GetBlocksCount() const {
+	return this->mBlocksCount;
+}
+
+/* Returns the dimensions of the level blocks */
+const GridDims& Level::GetDims() const {
+	return this->mDims;
+}
+
+/* Returns the number of bytes of a packed block */
+int Level::GetBlockSize() const {
+	return this->mBlockSize;
+}
+
+/* Returns the item of a block at the given lanes */
+GameItem Level::GetItem(int block, int z, int y, int x) const {
+	unsigned char streamed[LEVEL_BLOCK_MAX_SIZE];
+	const unsigned char* cells = this->mBlocks + (size_t)block * this->mBlockSize;
+
+	if (this->mStream != NULL) {
+		this->mStream->CopyBlock(block, streamed);
+		cells = streamed;
+	}
+
+	int cell = (z * this->mDims.Y + y) * this->mDims.X + x;
+	return (GameItem)((cells[cell >> 1] >> ((cell & 1) << 2)) & 0xF);
+}
+
+/* Tells that the given block will be used soon, so a streamed level reads it ahead of time */
+void Level::Prefetch(int block) const {
+	if (this->mStream != NULL)
+		this->mStream->Prefetch(block);
+}
+
+/* Copies the GetBlockSize() bytes of a packed block into the given buffer */
+void Level::CopyBlock(int block, unsigned char* cells) const {
+	if (this->mStream != NULL)
+		this->mStream->CopyBlock(block, cells);
+	else
+		memcpy(cells, this->mBlocks + (size_t)block * this->mBlockSize, this->mBlockSize);
+}
+
+/* Copies the given number of consecutive packed blocks starting at the given one into the given buffer, bypassing the stream cache */
+void Level::CopyBlocks(int first, int count, unsigned char* cells) const {
+	if (this->mStream != NULL)
+		this->mStream->ReadBlocks(first, count, cells);
+	else
+		memcpy(cells, this->mBlocks + (size_t)first * this->mBlockSize, (size_t)count * this->mBlockSize);
+}
+
+/* Checks the header of the given level pack and returns its blocks count and dimensions, or 0 if it is invalid */
+int Level::ReadPackHeader(const string& path, const unsigned char* header, size_t size, GridDims& dims) {
+	if (size < LEVEL_PACK_HEADER_SIZE || ReadValue(header) != LEVEL_PACK_MAGIC || ReadValue(header + 4) != LEVEL_PACK_VERSION) {
+		std::cout << "GAME::ERROR: Unsupported level pack version in " << path << std::endl;
+		return 0;
+	}
+
+	dims.X = (int)min(ReadValue(header + 8), (unsigned int)LANES_X_MAX + 1);
+	dims.Y = (int)min(ReadValue(header + 12), (unsigned int)LANES_Y_MAX + 1);
+	dims.Z = (int)min(ReadValue(header + 16), (unsigned int)LANES_Z_MAX + 1);
+	int blockSize = (dims.X * dims.Y * dims.Z + 1) / 2;
+
+	if (dims.X < 1 || dims.X > LANES_X_MAX || dims.Y < 1 || dims.Y > LANES_Y_MAX || dims.Z < 1 || dims.Z > LANES_Z_MAX ||
+		ReadValue(header + 24) != (unsigned int)blockSize) {
+		std::cout << "GAME::ERROR: Level pack " << path << " has unsupported lanes counts" << std::endl;
+		return 0;
+	}
+
+	unsigned int blocksCount = ReadValue(header + 20);
+
+	if (blocksCount < (unsigned int)LEVEL_MIN_BLOCKS || blocksCount > INT_MAX) {
+		std::cout << "GAME::ERROR: Level pack " << path << " has " << blocksCount << " blocks, a level needs at least " << LEVEL_MIN_BLOCKS << " blocks" << std::endl;
+		return 0;
+	}
+
+	if (size < LEVEL_PACK_HEADER_SIZE + (size_t)blocksCount * blockSize) {
+		std::cout << "GAME::ERROR: Level pack " << path << " is truncated" << std::endl;
+		return 0;
+	}
+
+	return (int)blocksCount;
+}
+
+/* Maps the given level pack file, or streams it if it is too large, returns false on failure */
+bool Level::LoadPack(const string& path) {
+	this->Close();
+
+	if (!this->mFile.Open(path))
+		return false;
+
+	GridDims dims;
+	int blocksCount = ReadPackHeader(path, this->mFile.GetData(), this->mFile.GetSize(), dims);
+
+	if (blocksCount == 0) {
+		this->mFile.Close();
+		return false;
+	}
+
+	this->SetDims(path, dims);
+
+	if (blocksCount > LEVEL_STREAM_MIN_BLOCKS) {
+		this->mFile.Close();
+		return this->Stream(path);
+	}
+
+	this->mBlocks = this->mFile.GetData() + LEVEL_PACK_HEADER_SIZE;
+	this->mBlocksCount = blocksCount;
+	this->mGraph->Build(*this);
+	return true;
+}
+
+/* Closes the current level blocks */
+void Level::Close() {
+	delete this->mStream;
+	this->mStream = NULL;
+	this->mFile.Close();
+	this->mPackBuffer.clear();
+	this->mBlocks = NULL;
+	this->mBlocksCount = 0;
+	this->mGraph->Clear();
+}
+
+/* Sets the dimensions of the level blocks, returns false if they are not supported */
+bool Level::SetDims(const string& path, const GridDims& dims) {
+	if (dims.X < 1 || dims.X > LANES_X_MAX || dims.Y < 1 || dims.Y > LANES_Y_MAX || dims.Z < 1 || dims.Z > LANES_Z_MAX) {
+		std::cout << "GAME::ERROR: Level " << path << " has unsupported lanes counts, at most "
+			<< LANES_X_MAX << " x " << LANES_Y_MAX << " x " << LANES_Z_MAX << std::endl;
+		return false;
+	}
+
+	this->mDims = dims;
+	this->mBlockSize = (dims.X * dims.Y * dims.Z + 1) / 2;
+	return true;
+}
+
+/* Parses the given text level file, returns false on failure */
+bool Level::LoadText(const string& path) {
+	ifstream fin;
+	fin.open(path, ios::ate);
+	if (!fin.is_open()) {
+		std::cout << "GAME::ERROR: Could not load file " << path << std::endl;
+		return false;
+	}
+
+	long long fileSize = (long long)fin.tellg();
+	fin.seekg(0);
+
+	int lineNumber = 0;
+	string line;
+	if (!ReadContentLine(fin, line, lineNumber)) {
+		std::cout << "GAME::ERROR: Level file " << path << " has no blocks count" << std::endl;
+		return false;
+	}
+
+	// The dimensions, when declared, come before the blocks count
+	GridDims dims = DEFAULT_GRID_DIMS;
+	istringstream header(line);
+
+	if (header >> dims.X >> dims.Y >> dims.Z) {
+		if (!ReadContentLine(fin, line, lineNumber)) {
+			std::cout << "GAME::ERROR: Level file " << path << " has no blocks count" << std::endl;
+			return false;
+		}
+	}
+	else {
+		dims = DEFAULT_GRID_DIMS;
+	}
+
+	int blocksCount = 0;
+	if (!ParseCount(line, blocksCount)) {
+		std::cout << "GAME::ERROR: Invalid blocks count '" << line << "' at line " << lineNumber << " of " << path << std::endl;
+		return false;
+	}
+
+	if (blocksCount < LEVEL_MIN_BLOCKS) {
+		std::cout << "GAME::ERROR: Blocks count " << blocksCount << " at line " << lineNumber << " of " << path << ", a level needs at least " << LEVEL_MIN_BLOCKS << " blocks" << std::endl;
+		return false;
+	}
+
+	this->Close();
+	if (!this->SetDims(path, dims))
+		return false;
+
+	// Every row of a block is a line, so a count the file can't hold is refused before its blocks are allocated
+	if ((long long)blocksCount * dims.Y * dims.X > fileSize) {
+		std::cout << "GAME::ERROR: Level file " << path << " ends before its " << blocksCount << " blocks" << std::endl;
+		return false;
+	}
+
+	this->mPackBuffer.assign((size_t)blocksCount * this->mBlockSize, 0);
+
+	for (int b = 0; b < blocksCount; ++b) {
+		unsigned char* cells = &this->mPackBuffer[(size_t)b * this->mBlockSize];
+
+		for (int y = 0; y < dims.Y; ++y) {
+			for (int x = 0; x < dims.X; ++x) {
+				if (!getline(fin, line)) {
+					std::cout << "GAME::ERROR: Level file " << path << " ends before block " << b << std::endl;
+					this->mPackBuffer.clear();
+					return false;
+				}
+				lineNumber++;
+
+				// Line is empty or a comment
+				if (line.size() == 0 || line[0] == '#') {
+					x--;
+					continue;
+				}
+
+				// Items missing at the end of the line are empty
+				for (int z = 0; z < dims.Z && z < (int)line.size(); ++z) {
+					int item = line[z] - '0';
+
+					if (item < 0 || item >= ITEMS_COUNT) {
+						std::cout << "GAME::ERROR: Invalid item '" << line[z] << "' at line " << lineNumber << " of " << path << std::endl;
+						this->mPackBuffer.clear();
+						return false;
+					}
+
+					int cell = (z * dims.Y + y) * dims.X + x;
+					cells[cell >> 1] |= item << ((cell & 1) << 2);
+				}
+			}
+		}
+	}
+
+	fin.close();
+
+	this->mBlocks = &this->mPackBuffer[0];
+	this->mBlocksCount = blocksCount;
+	this->mGraph->Build(*this);
+	return true;
+}
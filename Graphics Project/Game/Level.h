@@ -0,0 +1,200 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+using namespace std;
+
+// Other includes
+#include "../Utils/MappedFile.h"
+#include "LevelStream.h"
+
+class BlockGraph;
+
+
+/*
+	Defines several game items used in filling the game grid
+*/
+enum GameItem {
+	EMPTY,
+	BLOCK,
+	COIN,
+	GEM_DOUBLE_SCORE,
+	GEM_SPEED,
+	GEM_EXTRA_SCORE,
+	GEM_REVERSED_MODE,
+	ITEMS_COUNT
+};
+
+
+// Grid constants of the default tunnel, used by the levels that don't declare their dimensions
+const int LANES_X_COUNT = 3;
+const int LANES_Y_COUNT = 4;
+const int LANES_Z_COUNT = 20;
+
+// Largest dimensions a level can declare
+const int LANES_X_MAX = 64;
+const int LANES_Y_MAX = 8;
+const int LANES_Z_MAX = 64;
+
+// Level pack constants
+const unsigned int LEVEL_PACK_MAGIC = 0x564C5254;	// "TRLV"
+const unsigned int LEVEL_PACK_VERSION = 1;
+const int LEVEL_PACK_HEADER_SIZE = 32;
+const int LEVEL_MIN_BLOCKS = 2;					// The initial block and at least one block to generate
+const int LEVEL_SLICE_CELLS = LANES_Y_COUNT * LANES_X_COUNT;
+const int LEVEL_BLOCK_CELLS = LANES_Z_COUNT * LEVEL_SLICE_CELLS;
+const int LEVEL_BLOCK_SIZE = (LEVEL_BLOCK_CELLS + 1) / 2;	// Bytes of a packed block of the default tunnel, 4 bits per cell
+const int LEVEL_BLOCK_MAX_SIZE = (LANES_X_MAX * LANES_Y_MAX * LANES_Z_MAX + 1) / 2;
+
+
+/*
+	Dimensions of a grid known only at runtime, for the levels whose dimensions have no specialized code
+*/
+struct GridDims {
+	int X;
+	int Y;
+	int Z;
+
+	/* Returns whether both dimensions are the same */
+	bool operator==(const GridDims& other) const { return X == other.X && Y == other.Y && Z == other.Z; }
+};
+
+/*
+	Dimensions of a grid known at compile time, with the same members as GridDims.
+	Code templated on the dimensions reads dims.X, dims.Y and dims.Z either way,
+	so it gets constant loop bounds and ring sizes for the configurations it is instantiated with
+*/
+template <int LanesX, int LanesY, int LanesZ>
+struct FixedGridDims {
+	static const int X = LanesX;
+	static const int Y = LanesY;
+	static const int Z = LanesZ;
+};
+
+template <int LanesX, int LanesY, int LanesZ> const int FixedGridDims<LanesX, LanesY, LanesZ>::X;
+template <int LanesX, int LanesY, int LanesZ> const int FixedGridDims<LanesX, LanesY, LanesZ>::Y;
+template <int LanesX, int LanesY, int LanesZ> const int FixedGridDims<LanesX, LanesY, LanesZ>::Z;
+
+const GridDims DEFAULT_GRID_DIMS = { LANES_X_COUNT, LANES_Y_COUNT, LANES_Z_COUNT };
+
+// Level streaming constants
+const int LEVEL_STREAM_MIN_BLOCKS = 1 << 14;	// Level packs with more blocks are streamed from disk instead of mapped
+const int LEVEL_STREAM_CACHE_BLOCKS = 4096;		// Blocks kept in memory by a streamed level
+const int LEVEL_READ_AHEAD_BLOCKS = 4;			// Upcoming blocks known and read ahead by each game
+
+
+/*
+	Class holding the game blocks of a level,
+	each block is Z slices of Y x X items. The level files declare their dimensions, up to LANES_*_MAX,
+	and the text files that don't are LANES_Z_COUNT slices of LANES_Y_COUNT x LANES_X_COUNT items.
+
+	Every loaded level is analyzed into a block graph telling which blocks can follow each other.
+
+	The blocks are kept in the level pack layout: block after block, each one ordered [z][y][x]
+	with 4 bits per item, the first item of a byte in its low bits.
+	A compiled level pack file is a 32 bytes little endian header (magic, version, lanes X, Y and Z counts,
+	blocks count, packed block size, reserved) followed by the blocks, and is mapped into memory as is.
+	A text level file is parsed and packed in memory, its first line may declare its X, Y and Z dimensions before the blocks count.
+	Level packs too large to keep in memory are streamed from disk, the games copy their current block
+	and ask for their next blocks ahead of time, so the stream can read them in the background
+*/
+class Level
+{
+private:
+	MappedFile mFile;						// Mapped level pack
+	vector<unsigned char> mPackBuffer;		// Level pack of a parsed text level
+	const unsigned char* mBlocks;			// Packed blocks, in either of the above
+	LevelStream* mStream;					// Streamed level pack, when the blocks aren't in memory
+	BlockGraph* mGraph;						// Blocks that can follow each block
+	GridDims mDims;
+	int mBlockSize;							// Bytes of a packed block
+	int mBlocksCount;
+
+public:
+	/* Constructs an empty level */
+	Level();
+
+	/* Destructs the level */
+	~Level();
+
+	/* Loads the level blocks from the given level pack or text file, returns false on failure */
+	bool Load(const string& path);
+
+	/* Loads the level pack, or the text level it is compiled from when the pack is missing or older, returns false on failure */
+	bool LoadLatest(const string& packPath, const string& textPath);
+
+	/* Streams the level blocks from the given level pack keeping at most the given number of blocks in memory, returns false on failure */
+	bool Stream(const string& path, int cacheBlocks = LEVEL_STREAM_CACHE_BLOCKS);
+
+	/* Returns the stream of a streamed level, or null if its blocks are in memory */
+	const LevelStream* GetStream() const;
+
+	/* Returns the graph of the blocks that can follow each block */
+	const BlockGraph& GetGraph() const;
+
+	/* Saves the level blocks into the given level pack file, returns false on failure */
+	bool Save(const string& path) const;
+
+	/* Returns the number of blocks in the level */
+	int GetBlocksCount() const;
+
+	/* Returns the dimensions of the level blocks */
+	const GridDims& GetDims() const;
+
+	/* Returns the number of bytes of a packed block */
+	int GetBlockSize() const;
+
+	/* Returns the item of a block at the given lanes */
+	GameItem GetItem(int block, int z, int y, int x) const;
+
+	/* Tells that the given block will be used soon, so a streamed level reads it ahead of time */
+	void Prefetch(int block) const;
+
+	/* Copies the GetBlockSize() bytes of a packed block into the given buffer */
+	void CopyBlock(int block, unsigned char* cells) const;
+
+	/* Copies the given number of consecutive packed blocks starting at the given one into the given buffer, bypassing the stream cache */
+	void CopyBlocks(int first, int count, unsigned char* cells) const;
+
+	/* Unpacks the items of a packed block slice of the given dimensions into the given Y x X items, ordered [y][x] */
+	template <class Dims>
+	static void UnpackSlice(const Dims& dims, const unsigned char* cells, int z, unsigned char* items);
+
+private:
+	/* Checks the header of the given level pack and returns its blocks count and dimensions, or 0 if it is invalid */
+	static int ReadPackHeader(const string& path, const unsigned char* header, size_t size, GridDims& dims);
+
+	/* Sets the dimensions of the level blocks, returns false if they are not supported */
+	bool SetDims(const string& path, const GridDims& dims);
+
+	/* Maps the given level pack file, or streams it if it is too large, returns false on failure */
+	bool LoadPack(const string& path);
+
+	/* Closes the current level blocks */
+	void Close();
+
+	/* Parses the given text level file, returns false on failure */
+	bool LoadText(const string& path);
+
+	Level(const Level&) = delete;
+	Level& operator=(const Level&) = delete;
+};
+
+
+/* Unpacks the items of a packed block slice of the given dimensions into the given Y x X items, ordered [y][x] */
+template <class Dims>
+void Level::UnpackSlice(const Dims& dims, const unsigned char* cells, int z, unsigned char* items) {
+	int sliceCells = dims.Y * dims.X;
+	int cell = z * sliceCells;
+
+	for (int i = 0; i < sliceCells; ++i, ++cell) {
+		items[i] = (cells[cell >> 1] >> ((cell & 1) << 2)) & 0xF;
+	}
+}
@@ -0,0 +1,255 @@
+#include "LevelStream.h"
+
+/* Constructs a closed stream */
+LevelStream::LevelStream() {
+	this->mBlocksOffset = 0;
+	this->mBlockSize = 0;
+	this->mBlocksCount = 0;
+	this->mCacheIndexMask = 0;
+	this->mCacheCapacity = 0;
+	this->mRequestsFirst = 0;
+	this->mRequestsCount = 0;
+	this->mStopping = false;
+	this->mHits = 0;
+	this->mMisses = 0;
+}
+
+/* Stops the reader thread and closes the stream */
+LevelStream::~LevelStream() {
+	{
+		lock_guard<mutex> lock(this->mCacheMutex);
+		this->mStopping = true;
+	}
+
+	this->mRequestsAvailable.notify_all();
+
+	if (this->mReader.joinable())
+		this->mReader.join();
+}
+
+/* Opens the given level pack keeping at most the given number of blocks in memory, returns false on failure */
+bool LevelStream::Open(const string& path, unsigned long long blocksOffset, int blockSize, int blocksCount, int cacheCapacity) {
+	this->mPath = path;
+	this->mFile.open(path, ios::binary);
+	if (!this->mFile.is_open()) {
+		std::cout << "GAME::ERROR: Could not load file " << path << std::endl;
+		return false;
+	}
+
+	this->mBlocksOffset = blocksOffset;
+	this->mBlockSize = blockSize;
+	this->mBlocksCount = blocksCount;
+	this->mCacheCapacity = (size_t)max(1, cacheCapacity);
+
+	// All of the memory is taken up front so it stays flat while playing
+	this->mCache.assign(this->mCacheCapacity * blockSize, 0);
+	this->mSlotEntries.resize(this->mCacheCapacity);
+
+	for (size_t i = 0; i < this->mCacheCapacity; ++i) {
+		CacheEntry entry;
+		entry.Block = -1;
+		entry.Slot = (int)i;
+		this->mSlotEntries[i] = this->mCacheEntries.insert(this->mCacheEntries.end(), entry);
+	}
+
+	// The index is kept at most half full so the probes stay short
+	size_t buckets = 1;
+	while (buckets < this->mCacheCapacity * 2) {
+		buckets <<= 1;
+	}
+
+	this->mCacheIndex.assign(buckets, -1);
+	this->mCacheIndexMask = buckets - 1;
+	this->mRequests.assign(this->mCacheCapacity, 0);
+
+	this->mInitialBlock.resize(blockSize);
+	if (!this->ReadBlock(0, &this->mInitialBlock[0]))
+		return false;
+
+	this->mReader = thread(&LevelStream::ReaderLoop, this);
+	return true;
+}
+
+/* Asks the reader thread to read the given block into the cache if it isn't there yet */
+void LevelStream::Prefetch(int block) {
+	if (block == 0)
+		return;
+
+	{
+		lock_guard<mutex> lock(this->mCacheMutex);
+
+		// Drop the request if the reader is too far behind to keep the block cached until it is used anyway
+		if (this->FindSlot(block) >= 0 || this->mRequestsCount >= this->mCacheCapacity)
+			return;
+
+		this->mRequests[(this->mRequestsFirst + this->mRequestsCount) % this->mCacheCapacity] = block;
+		this->mRequestsCount++;
+	}
+
+	this->mRequestsAvailable.notify_one();
+}
+
+/* Copies the packed items of the given block into the given buffer */
+void LevelStream::CopyBlock(int block, unsigned char* cells) {
+	if (block == 0) {
+		memcpy(cells, &this->mInitialBlock[0], this->mBlockSize);
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(this->mCacheMutex);
+		int slot = this->FindSlot(block);
+
+		if (slot >= 0) {
+			// Move the block to the front of the cache
+			this->mCacheEntries.splice(this->mCacheEntries.begin(), this->mCacheEntries, this->mSlotEntries[slot]);
+			memcpy(cells, &this->mCache[(size_t)slot * this->mBlockSize], this->mBlockSize);
+			this->mHits++;
+			return;
+		}
+
+		this->mMisses++;
+	}
+
+	// A block that couldn't be read is left out of the cache, so it is read again next time
+	if (!this->ReadBlock(block, cells))
+		return;
+
+	lock_guard<mutex> lock(this->mCacheMutex);
+	this->InsertBlock(block, cells);
+}
+
+/* Reads the given number of consecutive blocks starting at the given one straight from the level pack into the given buffer */
+bool LevelStream::ReadBlocks(int first, int count, unsigned char* cells) {
+	lock_guard<mutex> lock(this->mFileMutex);
+	streamsize bytes = (streamsize)count * this->mBlockSize;
+
+	// A failed read leaves the stream failed, which would make every later read fail as well
+	this->mFile.clear();
+	this->mFile.seekg(this->mBlocksOffset + (unsigned long long)first * this->mBlockSize);
+	this->mFile.read((char*)cells, bytes);
+
+	if (this->mFile.gcount() != bytes) {
+		std::cout << "GAME::ERROR: Could not read blocks " << first << " to " << first + count - 1
+			<< " of level pack " << this->mPath << ", it may be truncated" << std::endl;
+		memset(cells, 0, (size_t)bytes);
+		return false;
+	}
+
+	return true;
+}
+
+/* Returns the number of copied blocks that were already in memory */
+unsigned long long LevelStream::GetHits() const {
+	lock_guard<mutex> lock(this->mCacheMutex);
+	return this->mHits;
+}
+
+/* Returns the number of copied blocks that had to be read right away */
+unsigned long long LevelStream::GetMisses() const {
+	lock_guard<mutex> lock(this->mCacheMutex);
+	return this->mMisses;
+}
+
+/* Reads the requested blocks until the stream is closed */
+void LevelStream::ReaderLoop() {
+	vector<unsigned char> cells(this->mBlockSize);
+
+	while (true) {
+		int block;
+
+		{
+			unique_lock<mutex> lock(this->mCacheMutex);
+			this->mRequestsAvailable.wait(lock, [this] { return this->mStopping || this->mRequestsCount > 0; });
+
+			if (this->mStopping)
+				return;
+
+			block = this->mRequests[this->mRequestsFirst];
+			this->mRequestsFirst = (this->mRequestsFirst + 1) % this->mCacheCapacity;
+			this->mRequestsCount--;
+
+			// Already read by an earlier request or right away
+			if (this->FindSlot(block) >= 0)
+				continue;
+		}
+
+		if (!this->ReadBlock(block, &cells[0]))
+			continue;
+
+		lock_guard<mutex> lock(this->mCacheMutex);
+		this->InsertBlock(block, &cells[0]);
+	}
+}
+
+/* Reads a block from the level pack into the given buffer */
+bool LevelStream::ReadBlock(int block, unsigned char* cells) {
+	return this->ReadBlocks(block, 1, cells);
+}
+
+/* Copies a block into the cache, dropping the least recently used one if it is full. Must hold the cache lock */
+void LevelStream::InsertBlock(int block, const unsigned char* cells) {
+	if (this->FindSlot(block) >= 0)
+		return;
+
+	// The unused slots are at the back until the cache is full, then the least recently used block is
+	list<CacheEntry>::iterator entry = prev(this->mCacheEntries.end());
+
+	if (entry->Block >= 0)
+		this->UnindexSlot(entry->Slot);
+
+	entry->Block = block;
+	memcpy(&this->mCache[(size_t)entry->Slot * this->mBlockSize], cells, this->mBlockSize);
+	this->mCacheEntries.splice(this->mCacheEntries.begin(), this->mCacheEntries, entry);
+	this->IndexSlot(entry->Slot);
+}
+
+/* Returns the index bucket the given block is looked up from */
+size_t LevelStream::GetHomeBucket(int block) const {
+	return ((unsigned int)block * 2654435761u) & this->mCacheIndexMask;
+}
+
+/* Returns the slot of the given block, or -1 if it isn't cached. Must hold the cache lock */
+int LevelStream::FindSlot(int block) const {
+	for (size_t bucket = this->GetHomeBucket(block); this->mCacheIndex[bucket] >= 0; bucket = (bucket + 1) & this->mCacheIndexMask) {
+		int slot = this->mCacheIndex[bucket];
+
+		if (this->mSlotEntries[slot]->Block == block)
+			return slot;
+	}
+
+	return -1;
+}
+
+/* Adds a used slot to the index. Must hold the cache lock */
+void LevelStream::IndexSlot(int slot) {
+	size_t bucket = this->GetHomeBucket(this->mSlotEntries[slot]->Block);
+
+	while (this->mCacheIndex[bucket] >= 0) {
+		bucket = (bucket + 1) & this->mCacheIndexMask;
+	}
+
+	this->mCacheIndex[bucket] = slot;
+}
+
+/* Removes a used slot from the index, moving back the slots probed past it. Must hold the cache lock */
+void LevelStream::UnindexSlot(int slot) {
+	size_t hole = this->GetHomeBucket(this->mSlotEntries[slot]->Block);
+
+	while (this->mCacheIndex[hole] != slot) {
+		hole = (hole + 1) & this->mCacheIndexMask;
+	}
+
+	// A later slot moves into the hole unless its home bucket lies after the hole, up to the slot itself
+	for (size_t bucket = (hole + 1) & this->mCacheIndexMask; this->mCacheIndex[bucket] >= 0; bucket = (bucket + 1) & this->mCacheIndexMask) {
+		size_t home = this->GetHomeBucket(this->mSlotEntries[this->mCacheIndex[bucket]]->Block);
+		bool reachable = (hole <= bucket) ? (hole < home && home <= bucket) : (hole < home || home <= bucket);
+
+		if (!reachable) {
+			this->mCacheIndex[hole] = this->mCacheIndex[bucket];
+			hole = bucket;
+		}
+	}
+
+	this->mCacheIndex[hole] = -1;
+}
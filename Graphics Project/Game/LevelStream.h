@@ -0,0 +1,128 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <iterator>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+
+/*
+	Blocks of a level pack streamed from disk instead of being held in memory.
+	The blocks are fixed size, so the offset of a block in the pack is its index times the block size.
+	A background thread reads the requested blocks ahead of time into a bounded cache
+	that drops the least recently used blocks, so the memory used doesn't depend on the level size.
+	The cache entries, its index and the requests queue are all allocated when the stream opens,
+	so copying and requesting blocks never allocates memory, even when a block has to be read right away.
+	The initial block is always kept in memory
+*/
+class LevelStream
+{
+private:
+	/*
+		A cached block and its slot in the cache storage, the block is -1 while the slot is unused
+	*/
+	struct CacheEntry {
+		int Block;
+		int Slot;
+	};
+
+	// Level pack file
+	string mPath;
+	ifstream mFile;
+	mutex mFileMutex;
+	unsigned long long mBlocksOffset;
+	int mBlockSize;
+	int mBlocksCount;
+
+	// Initial block
+	vector<unsigned char> mInitialBlock;
+
+	// Cache of blocks, the most recently used first, the entries are moved around and never allocated again
+	vector<unsigned char> mCache;
+	list<CacheEntry> mCacheEntries;
+	vector<list<CacheEntry>::iterator> mSlotEntries;	// Entry of each slot
+	vector<int> mCacheIndex;							// Open addressing table of the used slots by block, -1 for an empty bucket
+	size_t mCacheIndexMask;
+	size_t mCacheCapacity;
+	mutable mutex mCacheMutex;
+
+	// Read-ahead requests, a ring of at most mCacheCapacity blocks
+	vector<int> mRequests;
+	size_t mRequestsFirst;
+	size_t mRequestsCount;
+	condition_variable mRequestsAvailable;
+	thread mReader;
+	bool mStopping;
+
+	// Statistics
+	unsigned long long mHits;
+	unsigned long long mMisses;
+
+public:
+	/* Constructs a closed stream */
+	LevelStream();
+
+	/* Stops the reader thread and closes the stream */
+	~LevelStream();
+
+	/*
+		Opens the given level pack, whose blocks of the given size start at the given offset,
+		keeping at most the given number of blocks in memory. Returns false on failure
+	*/
+	bool Open(const string& path, unsigned long long blocksOffset, int blockSize, int blocksCount, int cacheCapacity);
+
+	/* Asks the reader thread to read the given block into the cache if it isn't there yet */
+	void Prefetch(int block);
+
+	/*
+		Copies the packed items of the given block into the given buffer.
+		Reads the block right away if it wasn't read ahead yet, which only happens when the game outruns the disk
+	*/
+	void CopyBlock(int block, unsigned char* cells);
+
+	/*
+		Reads the given number of consecutive blocks starting at the given one straight from the level pack into the given buffer.
+		Returns false and zeroes the buffer if the pack can't be read
+	*/
+	bool ReadBlocks(int first, int count, unsigned char* cells);
+
+	/* Returns the number of copied blocks that were already in memory */
+	unsigned long long GetHits() const;
+
+	/* Returns the number of copied blocks that had to be read right away */
+	unsigned long long GetMisses() const;
+
+private:
+	/* Reads the requested blocks until the stream is closed */
+	void ReaderLoop();
+
+	/* Reads a block from the level pack into the given buffer, returns false and zeroes the buffer on failure */
+	bool ReadBlock(int block, unsigned char* cells);
+
+	/* Copies a block into the cache, dropping the least recently used one if it is full. Must hold the cache lock */
+	void InsertBlock(int block, const unsigned char* cells);
+
+	/* Returns the index bucket the given block is looked up from */
+	size_t GetHomeBucket(int block) const;
+
+	/* Returns the slot of the given block, or -1 if it isn't cached. Must hold the cache lock */
+	int FindSlot(int block) const;
+
+	/* Adds a used slot to the index. Must hold the cache lock */
+	void IndexSlot(int slot);
+
+	/* Removes a used slot from the index, moving back the slots probed past it. Must hold the cache lock */
+	void UnindexSlot(int slot);
+
+	LevelStream(const LevelStream&) = delete;
+	LevelStream& operator=(const LevelStream&) = delete;
+};
@@ -0,0 +1,141 @@
+#include "Replay.h"
+
+/* Writes an unsigned value in little endian byte order */
+static void WriteValue(ofstream& fout, unsigned long long value, int bytes) {
+	for (int i = 0; i < bytes; ++i) {
+		fout.put((char)((value >> (i * 8)) & 0xFF));
+	}
+}
+
+/* Reads an unsigned value in little endian byte order */
+static unsigned long long ReadValue(ifstream& fin, int bytes) {
+	unsigned long long value = 0;
+
+	for (int i = 0; i < bytes; ++i) {
+		value |= (unsigned long long)(unsigned char)fin.get() << (i * 8);
+	}
+
+	return value;
+}
+
+/* Constructs an empty replay of the given seed, tick rate and flags */
+Replay::Replay(unsigned int seed, unsigned int tickRate, unsigned int flags) {
+	this->mSeed = seed;
+	this->mTickRate = tickRate;
+	this->mFlags = flags;
+	this->mTicksCount = 0;
+}
+
+/* Destructs the replay */
+Replay::~Replay() {
+
+}
+
+/* Appends the input keys of the next tick */
+void Replay::Record(unsigned int input) {
+	unsigned long long bit = this->mTicksCount * REPLAY_INPUT_BITS;
+
+	for (int i = 0; i < REPLAY_INPUT_BITS; ++i, ++bit) {
+		if ((bit >> 3) >= this->mBits.size())
+			this->mBits.push_back(0);
+
+		if (input & (1 << i))
+			this->mBits[bit >> 3] |= 1 << (bit & 7);
+	}
+
+	this->mTicksCount++;
+}
+
+/* Returns the input keys of the given tick */
+unsigned int Replay::GetInput(unsigned long long tick) const {
+	unsigned int input = 0;
+	unsigned long long bit = tick * REPLAY_INPUT_BITS;
+
+	for (int i = 0; i < REPLAY_INPUT_BITS; ++i, ++bit) {
+		if (this->mBits[bit >> 3] & (1 << (bit & 7)))
+			input |= 1 << i;
+	}
+
+	return input;
+}
+
+/* Returns the number of recorded ticks */
+unsigned long long Replay::GetTicksCount() const {
+	return this->mTicksCount;
+}
+
+/* Returns the random seed of the session */
+unsigned int Replay::GetSeed() const {
+	return this->mSeed;
+}
+
+/* Returns the number of ticks per second of the session */
+unsigned int Replay::GetTickRate() const {
+	return this->mTickRate;
+}
+
+/* Returns the flags of the game mode */
+unsigned int Replay::GetFlags() const {
+	return this->mFlags;
+}
+
+/* Sets the flags of the game mode */
+void Replay::SetFlags(unsigned int flags) {
+	this->mFlags = flags;
+}
+
+/* Returns the time step of a single tick in seconds */
+double Replay::GetTickTime() const {
+	return 1.0 / this->mTickRate;
+}
+
+/* Saves the replay into the given file, returns false on failure */
+bool Replay::Save(const string& path) const {
+	ofstream fout(path, ios::binary);
+
+	if (!fout.is_open()) {
+		std::cout << "REPLAY::ERROR: Unable to save replay " << path << std::endl;
+		return false;
+	}
+
+	WriteValue(fout, REPLAY_MAGIC, 4);
+	WriteValue(fout, REPLAY_VERSION, 4);
+	WriteValue(fout, this->mSeed, 4);
+	WriteValue(fout, this->mTickRate, 4);
+	WriteValue(fout, this->mFlags, 4);
+	WriteValue(fout, this->mTicksCount, 8);
+	fout.write((const char*)this->mBits.data(), this->mBits.size());
+	fout.close();
+
+	return true;
+}
+
+/* Loads the replay from the given file, returns false on failure */
+bool Replay::Load(const string& path) {
+	ifstream fin(path, ios::binary);
+
+	if (!fin.is_open()) {
+		std::cout << "REPLAY::ERROR: Unable to load replay " << path << std::endl;
+		return false;
+	}
+
+	if (ReadValue(fin, 4) != REPLAY_MAGIC || ReadValue(fin, 4) != REPLAY_VERSION) {
+		std::cout << "REPLAY::ERROR: Invalid replay file " << path << std::endl;
+		return false;
+	}
+
+	this->mSeed = (unsigned int)ReadValue(fin, 4);
+	this->mTickRate = (unsigned int)ReadValue(fin, 4);
+	this->mFlags = (unsigned int)ReadValue(fin, 4);
+	this->mTicksCount = ReadValue(fin, 8);
+	this->mBits.assign((this->mTicksCount * REPLAY_INPUT_BITS + 7) / 8, 0);
+	fin.read((char*)this->mBits.data(), this->mBits.size());
+
+	if (!fin || this->mTickRate == 0) {
+		std::cout << "REPLAY::ERROR: Truncated replay file " << path << std::endl;
+		return false;
+	}
+
+	fin.close();
+	return true;
+}
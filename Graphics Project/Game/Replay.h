@@ -0,0 +1,70 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+// Replay file constants
+const unsigned int REPLAY_MAGIC = 0x50525254;	// "TRRP"
+const unsigned int REPLAY_VERSION = 6;	// Bumped whenever the game rules change the outcome of the same inputs
+const int REPLAY_INPUT_BITS = 6;				// Bits stored per tick, one per input key
+
+// Replay flags
+const unsigned int REPLAY_FLAG_PROCEDURAL = 1 << 0;	// The session played procedurally generated blocks
+
+
+/*
+	Class holding a recorded game session: the random seed, the fixed tick rate, the flags of the game mode
+	and the input keys of every tick packed in a bitstream.
+	Stepping a game logic seeded with the same seed with the recorded inputs reproduces the session exactly
+*/
+class Replay
+{
+private:
+	unsigned int mSeed;
+	unsigned int mTickRate;
+	unsigned int mFlags;
+	unsigned long long mTicksCount;
+	vector<unsigned char> mBits;
+
+public:
+	/* Constructs an empty replay of the given seed, tick rate and flags */
+	Replay(unsigned int seed = 0, unsigned int tickRate = 0, unsigned int flags = 0);
+
+	/* Destructs the replay */
+	~Replay();
+
+	/* Appends the input keys of the next tick */
+	void Record(unsigned int input);
+
+	/* Returns the input keys of the given tick */
+	unsigned int GetInput(unsigned long long tick) const;
+
+	/* Returns the number of recorded ticks */
+	unsigned long long GetTicksCount() const;
+
+	/* Returns the random seed of the session */
+	unsigned int GetSeed() const;
+
+	/* Returns the number of ticks per second of the session */
+	unsigned int GetTickRate() const;
+
+	/* Returns the flags of the game mode */
+	unsigned int GetFlags() const;
+
+	/* Sets the flags of the game mode */
+	void SetFlags(unsigned int flags);
+
+	/* Returns the time step of a single tick in seconds */
+	double GetTickTime() const;
+
+	/* Saves the replay into the given file, returns false on failure */
+	bool Save(const string& path) const;
+
+	/* Loads the replay from the given file, returns false on failure */
+	bool Load(const string& path);
+};
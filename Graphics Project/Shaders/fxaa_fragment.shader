@@ -0,0 +1,48 @@
+#version 330 core
+
+in vec2 TexCoords;
+
+out vec4 color;
+
+uniform sampler2D source;
+uniform vec2 source_texel;		// Size of a texel of the source
+uniform vec2 source_max;		// Last texel center of the part covered by the scene, nothing past it is sampled
+
+// Edge detection constants
+const float REDUCE_MIN = 1.0 / 128.0;	// Smallest blur reduction, keeps flat areas from being blurred
+const float REDUCE_MUL = 1.0 / 8.0;		// Share of the local luma the blur reduction grows with
+const float SPAN_MAX = 8.0;				// Longest blur along an edge, in texels
+
+vec3 Fetch(vec2 coords) {
+	return texture(source, min(coords, source_max)).rgb;
+}
+
+float Luma(vec3 rgb) {
+	return dot(rgb, vec3(0.299, 0.587, 0.114));
+}
+
+void main() {
+	// Luma of the corners around the pixel
+	vec3 rgbM = Fetch(TexCoords);
+	float lumaNW = Luma(Fetch(TexCoords + vec2(-1.0, -1.0) * source_texel));
+	float lumaNE = Luma(Fetch(TexCoords + vec2(1.0, -1.0) * source_texel));
+	float lumaSW = Luma(Fetch(TexCoords + vec2(-1.0, 1.0) * source_texel));
+	float lumaSE = Luma(Fetch(TexCoords + vec2(1.0, 1.0) * source_texel));
+	float lumaM = Luma(rgbM);
+
+	float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+	// Direction along the edge, across the luma gradient
+	vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+	float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+	float scale = 1.0 / (min(abs(dir.x), abs(dir.y)) + reduce);
+	dir = clamp(dir * scale, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * source_texel;
+
+	// Blend along the edge, with two taps then four, keeping the four unless they cross another edge
+	vec3 rgbA = 0.5 * (Fetch(TexCoords + dir * (1.0 / 3.0 - 0.5)) + Fetch(TexCoords + dir * (2.0 / 3.0 - 0.5)));
+	vec3 rgbB = rgbA * 0.5 + 0.25 * (Fetch(TexCoords - dir * 0.5) + Fetch(TexCoords + dir * 0.5));
+	float lumaB = Luma(rgbB);
+
+	color = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+out vec2 TexCoords;
+
+// Part of the source covered by the scene
+uniform vec2 source_scale;
+
+void main() {
+	// A single triangle covering the screen, its corners at (0, 0), (2, 0) and (0, 2)
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+	TexCoords = corner * source_scale;
+}
@@ -0,0 +1,9 @@
+#version 330 core
+
+out vec4 color;
+
+uniform vec3 graph_color;
+
+void main() {
+	color = vec4(graph_color, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+
+layout(location = 0) in float value; // Sample of the graph
+
+// Transformation matrices
+uniform mat4 projection;
+
+// Graph placement, in pixels (x, y, width, height)
+uniform vec4 graph_rect;
+uniform int graph_first;		// Vertex of the first sample drawn
+uniform int graph_samples;		// Samples across the width of the graph
+uniform float graph_max;		// Value at the top of the graph
+
+void main() {
+	// The samples are spread across the graph in the order they are drawn, as many times as the samples count
+	float x = float((gl_VertexID - graph_first) % graph_samples) / float(graph_samples - 1);
+	float y = min(value / graph_max, 1.0);
+
+	gl_Position = projection * vec4(graph_rect.x + x * graph_rect.z, graph_rect.y + y * graph_rect.w, 0.0, 1.0);
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoords;
+layout(location = 3) in mat4 instance_model;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -13,10 +14,16 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Instanced draws place every instance by its own matrix, after the local matrix shared by all of them
+uniform bool instanced;
+uniform mat4 local_model;
+
 void main() {
-	gl_Position = projection * view * model * vec4(position, 1.0f);
+	mat4 world = instanced ? instance_model * local_model : model;
+
+	gl_Position = projection * view * world * vec4(position, 1.0f);
 
-	FragPos = vec3(model * vec4(position, 1.0f));
-	Normal = mat3(transpose(inverse(model))) * normal;
+	FragPos = vec3(world * vec4(position, 1.0f));
+	Normal = mat3(transpose(inverse(world))) * normal;
 	TexCoords = texCoords;
 }
\ No newline at end of file
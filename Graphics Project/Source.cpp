@@ -2,9 +2,71 @@
 #include "Game/Game.h"
 
 
-int main() {
+/*
+	Usage: TunnelRunner [-procedural] [-view slices] [-record replay_path] [-replay replay_path] [-profile trace_path] [-overlay] [-hitches factor] [-capture path] [-budget ms] [-aa mode]
+		-procedural	Plays procedurally generated blocks after the level's initial block
+		-view		Number of slices seen ahead, up to VIEW_SLICES_MAX (default a block length)
+		-record		Records the session inputs into the given file
+		-replay		Plays the session saved in the given file
+		-profile	Profiles the frames on the CPU and the GPU, prints their statistics on exit and writes their Chrome trace into the given file
+		-overlay	Shows the performance overlay from the start (toggled with F3)
+		-hitches	Writes a trace of the last frames into hitch_Frame_N.json or hitch_Tick_N.json whenever a frame or
+					a simulation tick takes longer than the given multiple of the median (HITCH_DEFAULT_FACTOR if 0)
+		-budget		GPU time per frame the resolution of the scene is scaled to hold, 0 for the native resolution (default RESOLUTION_DEFAULT_BUDGET)
+		-aa			Anti-aliasing of the scene among none, msaa2, msaa4, msaa8 and fxaa (default msaa4, cycled with F4)
+		-capture	Records the frames into the given path, a Y4M video if it ends with .y4m or else numbered PNG images (F12 takes a screenshot)
+*/
+int main(int argc, char** argv) {
 	GameEngine MyGameEngine(1920, 1080, true);
 	Game MyGame(&MyGameEngine, "Tunnel Runner");
+	string profilePath;
+	double hitchFactor = -1;
+
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-procedural")
+			MyGame.SetProceduralBlocks(true);
+		else if (arg == "-view" && i + 1 < argc)
+			MyGame.SetViewSlices(atoi(argv[++i]));
+		else if (arg == "-replay" && i + 1 < argc)
+			MyGame.StartReplay(argv[++i]);
+		else if (arg == "-record" && i + 1 < argc)
+			MyGame.StartRecording(argv[++i]);
+		else if (arg == "-profile" && i + 1 < argc)
+			profilePath = argv[++i];
+		else if (arg == "-overlay")
+			MyGame.SetOverlayVisible(true);
+		else if (arg == "-hitches" && i + 1 < argc)
+			hitchFactor = atof(argv[++i]);
+		else if (arg == "-budget" && i + 1 < argc)
+			MyGameEngine.SetDynamicResolution(atof(argv[++i]) / 1e3);
+		else if (arg == "-aa" && i + 1 < argc) {
+			AntiAliasing antiAliasing;
+			if (SceneTarget::ParseAntiAliasing(argv[++i], antiAliasing))
+				MyGameEngine.SetAntiAliasing(antiAliasing);
+		}
+		else if (arg == "-capture" && i + 1 < argc)
+			MyGameEngine.StartCapture(argv[++i]);
+	}
+
+	// The hitch traces only need the recent events
+	if (hitchFactor >= 0) {
+		MyGameEngine.SetHitchDetection(hitchFactor > 0 ? hitchFactor : HITCH_DEFAULT_FACTOR, "hitch_");
+		Profiler::SetTraceKept(!profilePath.empty());
+	}
+
+	if (!profilePath.empty() || hitchFactor >= 0)
+		Profiler::SetEnabled(true);
+
 	MyGameEngine.Run();
+	MyGameEngine.StopCapture();
+	Profiler::SetEnabled(false);
+
+	if (!profilePath.empty()) {
+		Profiler::WriteReport(cout);
+		Profiler::WriteTrace(profilePath);
+	}
+
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,131 @@
+// STL Includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/GameBatch.h"
+#include "../Game/BlockGenerator.h"
+#include "../Utils/Random.h"
+
+
+/*
+	Batched game driver.
+	Steps many games at once on all of the cores, each one driven by a random bot,
+	and reports the throughput, used for bot training and balancing runs.
+
+	Usage: Batch [-n games] [-t steps] [-j threads] [-l level_path] [-p] [-s seed]
+		-n	Number of games (default 4096)
+		-t	Number of steps of every game (default 10000)
+		-j	Number of threads (default all of the cores)
+		-l	Path of the level file (default Levels/Level.txt)
+		-p	Plays procedurally generated blocks after the level's initial block
+		-s	Seed of the games and the bot (default current time)
+*/
+int main(int argc, char** argv) {
+	int gamesCount = 4096;
+	long long steps = 10000;
+	int threadsCount = 0;
+	string levelPath = "Levels/Level.txt";
+	unsigned int seed = (unsigned int)time(NULL);
+	bool procedural = false;
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-n" && i + 1 < argc)
+			gamesCount = atoi(argv[++i]);
+		else if (arg == "-t" && i + 1 < argc)
+			steps = atoll(argv[++i]);
+		else if (arg == "-j" && i + 1 < argc)
+			threadsCount = atoi(argv[++i]);
+		else if (arg == "-l" && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (arg == "-p")
+			procedural = true;
+		else if (arg == "-s" && i + 1 < argc)
+			seed = (unsigned int)atoll(argv[++i]);
+		else {
+			cout << "Usage: " << argv[0] << " [-n games] [-t steps] [-j threads] [-l level_path] [-p] [-s seed]" << endl;
+			return 1;
+		}
+	}
+
+	if (gamesCount <= 0) {
+		cout << "GAME::ERROR: The number of games must be positive" << endl;
+		return 1;
+	}
+
+	Level level;
+	if (!level.Load(levelPath))
+		return 1;
+
+	GameBatch batch(&level, gamesCount, seed, threadsCount);
+	BlockGenerator* generator = NULL;
+	if (procedural) {
+		generator = new BlockGenerator(gamesCount, batch.GetViewSlices());
+		batch.SetGenerator(generator);
+		batch.Seed(seed);
+	}
+
+	Random bot(seed + gamesCount);
+	vector<unsigned int> actions(gamesCount);
+
+	long long episodes = 0;
+	double totalReward = 0;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (long long t = 0; t < steps; ++t) {
+		for (int i = 0; i < gamesCount; ++i) {
+			actions[i] = bot.Next() & (INPUT_LEFT | INPUT_RIGHT | INPUT_JUMP);
+		}
+
+		batch.Step(&actions[0], SIMULATION_TICK_TIME);
+
+		const float* rewards = batch.GetRewards();
+		const unsigned char* dones = batch.GetDones();
+
+		for (int i = 0; i < gamesCount; ++i) {
+			totalReward += rewards[i];
+			episodes += dones[i];
+		}
+	}
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	// Combined hash of all of the games
+	unsigned long long hash = 0;
+	for (int i = 0; i < gamesCount; ++i) {
+		hash = hash * 1099511628211ULL + batch.GetStateHash(i);
+	}
+
+	cout << "Games: " << gamesCount << endl;
+	cout << "Threads: " << batch.GetThreadsCount() << endl;
+	cout << "Steps: " << steps << endl;
+	cout << "Seed: " << seed << endl;
+	cout << "Elapsed: " << elapsed << " s" << endl;
+	cout << "Game steps/s: " << (long long)(gamesCount * steps / elapsed) << endl;
+	cout << "Episodes: " << episodes << endl;
+	cout << "Average episode score: " << (episodes > 0 ? totalReward / episodes : 0.0) << endl;
+	cout << "State hash: " << hex << hash << dec << endl;
+
+	if (generator != NULL) {
+		unsigned long long misses = 0;
+		for (int i = 0; i < gamesCount; ++i) {
+			misses += generator->GetMisses(i);
+		}
+
+		cout << "Generated blocks not ready in time: " << misses << endl;
+		batch.SetGenerator(NULL);
+		delete generator;
+	}
+
+	return 0;
+}
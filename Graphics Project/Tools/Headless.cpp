@@ -0,0 +1,173 @@
+// STL Includes
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/GameLogic.h"
+#include "../Game/Replay.h"
+#include "../Game/BlockGenerator.h"
+#include "../Utils/Random.h"
+#include "../Utils/Profiler.h"
+
+
+/*
+	Headless game driver.
+	Steps the game logic as fast as possible without a window, a GL context or sound,
+	either driven by a bot that replays the game whenever it is lost, or by a recorded session.
+
+	Usage: Headless [-t ticks] [-l level_path] [-m cache_blocks] [-p] [-v view_slices] [-s seed] [-i] [-o replay_path] [-r replay_path] [-f trace_path]
+		-t	Number of ticks to simulate (default 10000000)
+		-l	Path of the level file (default Levels/Level.txt)
+		-m	Streams the level pack keeping the given number of blocks in memory
+		-p	Plays procedurally generated blocks after the level's initial block
+		-v	Number of slices kept ahead of the game (default a block length)
+		-s	Seed of the game and the bot (default current time)
+		-i	Idle bot that never presses any key (default random keys)
+		-o	Records the bot session into the given replay file
+		-r	Plays the given replay file instead of the bot
+		-f	Profiles every tick as a frame, prints their statistics and writes their Chrome trace into the given file
+*/
+int main(int argc, char** argv) {
+	long long ticks = 10000000;
+	string levelPath = "Levels/Level.txt";
+	int cacheBlocks = 0;
+	bool procedural = false;
+	int viewSlices = 0;
+	unsigned int seed = (unsigned int)time(NULL);
+	bool idle = false;
+	string recordPath;
+	string replayPath;
+	string profilePath;
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-t" && i + 1 < argc)
+			ticks = atoll(argv[++i]);
+		else if (arg == "-l" && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (arg == "-m" && i + 1 < argc)
+			cacheBlocks = atoi(argv[++i]);
+		else if (arg == "-p")
+			procedural = true;
+		else if (arg == "-v" && i + 1 < argc)
+			viewSlices = atoi(argv[++i]);
+		else if (arg == "-s" && i + 1 < argc)
+			seed = (unsigned int)atoll(argv[++i]);
+		else if (arg == "-i")
+			idle = true;
+		else if (arg == "-o" && i + 1 < argc)
+			recordPath = argv[++i];
+		else if (arg == "-r" && i + 1 < argc)
+			replayPath = argv[++i];
+		else if (arg == "-f" && i + 1 < argc)
+			profilePath = argv[++i];
+		else {
+			cout << "Usage: " << argv[0] << " [-t ticks] [-l level_path] [-m cache_blocks] [-p] [-v view_slices] [-s seed] [-i] [-o replay_path] [-r replay_path] [-f trace_path]" << endl;
+			return 1;
+		}
+	}
+
+	Level level;
+	if (cacheBlocks > 0 ? !level.Stream(levelPath, cacheBlocks) : !level.Load(levelPath))
+		return 1;
+
+	// The replay dictates the seed, the time step and the number of ticks
+	Replay replay(seed, SIMULATION_TICK_RATE);
+	bool replaying = !replayPath.empty();
+	if (replaying) {
+		if (!replay.Load(replayPath))
+			return 1;
+
+		seed = replay.GetSeed();
+		ticks = replay.GetTicksCount();
+		procedural = (replay.GetFlags() & REPLAY_FLAG_PROCEDURAL) != 0;
+	}
+
+	replay.SetFlags(procedural ? REPLAY_FLAG_PROCEDURAL : 0);
+
+	GameLogic logic(&level, seed, viewSlices);
+	BlockGenerator* generator = NULL;
+	if (procedural) {
+		generator = new BlockGenerator(1, viewSlices);
+		logic.SetGenerator(generator);
+		logic.Seed(seed);
+	}
+
+	Random bot(seed + 1);
+	double tickTime = replaying ? replay.GetTickTime() : SIMULATION_TICK_TIME;
+
+	long long games = 0;
+	long long totalScore = 0;
+	int bestScore = 0;
+
+	if (!profilePath.empty()) {
+		Profiler::SetThreadName("Simulation");
+		Profiler::SetEnabled(true);
+	}
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (long long t = 0; t < ticks; ++t) {
+		unsigned int input;
+
+		if (replaying)
+			input = replay.GetInput(t);
+		else if (logic.GetGameState() == LOST)
+			input = INPUT_REPLAY;
+		else
+			input = idle ? 0 : (bot.Next() & (INPUT_LEFT | INPUT_RIGHT | INPUT_JUMP));
+
+		if (!replaying && !recordPath.empty())
+			replay.Record(input);
+
+		if (logic.Step(input, tickTime) & EVENT_GAME_OVER) {
+			games++;
+			totalScore += logic.GetScore();
+			bestScore = max(bestScore, logic.GetScore());
+		}
+
+		Profiler::EndFrame();
+	}
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << "Ticks: " << ticks << endl;
+	cout << "Seed: " << seed << endl;
+	cout << "Elapsed: " << elapsed << " s" << endl;
+	cout << "Ticks/s: " << (long long)(ticks / elapsed) << endl;
+	cout << "Games: " << games << endl;
+	cout << "Average score: " << (games > 0 ? (double)totalScore / games : 0.0) << endl;
+	cout << "Best score: " << bestScore << endl;
+	cout << "Final score: " << logic.GetScore() << endl;
+	cout << "State hash: " << hex << logic.GetStateHash() << dec << endl;
+
+	if (generator != NULL) {
+		cout << "Generated blocks not ready in time: " << generator->GetMisses(0) << endl;
+		logic.SetGenerator(NULL);
+		delete generator;
+	}
+
+	if (!profilePath.empty()) {
+		Profiler::SetEnabled(false);
+		Profiler::WriteReport(cout);
+		Profiler::WriteTrace(profilePath);
+	}
+
+	if (level.GetStream() != NULL) {
+		cout << "Streamed blocks read ahead: " << level.GetStream()->GetHits() << endl;
+		cout << "Streamed blocks read right away: " << level.GetStream()->GetMisses() << endl;
+	}
+
+	if (!replaying && !recordPath.empty() && !replay.Save(recordPath))
+		return 1;
+
+	return 0;
+}
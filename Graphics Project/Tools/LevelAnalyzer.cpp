@@ -0,0 +1,402 @@
+// STL Includes
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/BlockGraph.h"
+#include "../Game/GameLogic.h"
+
+
+// Analyzer constants
+const int ANALYZER_DEAD = -1;
+
+
+/*
+	Analysis of a block
+*/
+struct BlockAnalysis {
+	bool Valid;					// All of the items are known game items
+	bool Passable;				// The character can get through the block from some state of its first slice
+	bool GroundPassable;		// The character can get through the block from every ground lane
+	int EntryStates;			// Number of states of the first slice the block can be passed from
+	int ReactionSlices;			// Most slices the character can get before or between key presses while passing the block
+	int MaxCoins;				// Most coins and gems collected while passing the block
+	vector<int> Path;			// Lanes (y * X + x) of every slice of the path collecting the most coins
+};
+
+/*
+	Per slice dynamic programming tables of the analyzer, sized for the level's dimensions and the jump at the analyzed speed.
+	The rows are the lane states of the block graph, and the moves between them are the block graph's
+*/
+struct AnalyzerTables {
+	GridDims Dims;
+	int JumpSlices;
+	int StatesCount;
+	int NoInput;					// Reaction slices of a block passed without pressing any key, one more than the block length
+	vector<LaneMove> Moves;			// Moves of every state of every slice, GRAPH_MAX_MOVES per state, ordered [z][state]
+	vector<int> MovesCount;			// Ordered [z][state]
+	vector<int> Coins;				// Most coins collected from a state to the end of the block, ordered [z][state]
+	vector<int> Reaction[2];		// Best reaction slices reaching a state by the slices since the last key press, ordered [state][slices],
+									// the last column of a state being for no key pressed yet
+};
+
+
+/* Returns whether the item at the lanes of a state of a slice is collected as a coin, gems mostly spawn as coins */
+static bool IsCoin(const GridDims& dims, const unsigned char* slice, int state) {
+	int lanes = BlockGraph::GetStateLanes(dims, state);
+	return lanes < dims.Y * dims.X && slice[lanes] >= COIN && slice[lanes] <= GEM_REVERSED_MODE;
+}
+
+/* Sizes the tables for the given dimensions and jump slices */
+static void InitTables(const GridDims& dims, int jumpSlices, AnalyzerTables& tables) {
+	tables.Dims = dims;
+	tables.JumpSlices = jumpSlices;
+	tables.StatesCount = BlockGraph::GetStatesCount(dims, jumpSlices);
+	tables.NoInput = dims.Z + 1;
+
+	size_t rows = (size_t)dims.Z * tables.StatesCount;
+	tables.Moves.resize(rows * GRAPH_MAX_MOVES);
+	tables.MovesCount.resize(rows);
+	tables.Coins.resize(rows);
+	tables.Reaction[0].resize((size_t)tables.StatesCount * (dims.Z + 2));
+	tables.Reaction[1].resize((size_t)tables.StatesCount * (dims.Z + 2));
+}
+
+/* Fills the moves of every free state of every slice of a block, ordered [z][y][x], that land on a free state of the next slice */
+static void BuildMoves(const unsigned char* items, AnalyzerTables& tables) {
+	const GridDims& dims = tables.Dims;
+	int sliceCells = dims.Y * dims.X;
+
+	for (int z = 0; z + 1 < dims.Z; ++z) {
+		const unsigned char* slice = items + z * sliceCells;
+
+		for (int s = 0; s < tables.StatesCount; ++s) {
+			size_t row = (size_t)z * tables.StatesCount + s;
+			LaneMove* moves = &tables.Moves[row * GRAPH_MAX_MOVES];
+			int count = 0;
+
+			if (BlockGraph::IsFree(dims, slice, s)) {
+				LaneMove candidates[GRAPH_MAX_MOVES];
+				int candidatesCount = BlockGraph::GetMoves(dims, slice, s, tables.JumpSlices, candidates);
+
+				for (int m = 0; m < candidatesCount; ++m) {
+					if (BlockGraph::IsFree(dims, slice + sliceCells, candidates[m].State))
+						moves[count++] = candidates[m];
+				}
+			}
+
+			tables.MovesCount[row] = count;
+		}
+	}
+}
+
+/* Analyzes a block, ordered [z][y][x], with the given tables */
+static void AnalyzeBlock(const unsigned char* items, AnalyzerTables& tables, BlockAnalysis& analysis) {
+	const GridDims& dims = tables.Dims;
+	int n = tables.StatesCount;
+	int sliceCells = dims.Y * dims.X;
+	int width = dims.Z + 2;
+	int noPress = dims.Z + 1;
+	BuildMoves(items, tables);
+
+	// Most coins from every state to the end of the block, walking back from the last slice
+	const unsigned char* last = items + (dims.Z - 1) * sliceCells;
+	int* coins = &tables.Coins[(size_t)(dims.Z - 1) * n];
+
+	for (int s = 0; s < n; ++s) {
+		coins[s] = BlockGraph::IsFree(dims, last, s) ? IsCoin(dims, last, s) : ANALYZER_DEAD;
+	}
+
+	for (int z = dims.Z - 2; z >= 0; --z) {
+		const int* nextCoins = &tables.Coins[(size_t)(z + 1) * n];
+		coins = &tables.Coins[(size_t)z * n];
+
+		for (int s = 0; s < n; ++s) {
+			size_t row = (size_t)z * n + s;
+			const LaneMove* moves = &tables.Moves[row * GRAPH_MAX_MOVES];
+			int best = ANALYZER_DEAD;
+
+			for (int m = 0; m < tables.MovesCount[row]; ++m) {
+				best = max(best, nextCoins[moves[m].State]);
+			}
+
+			if (best != ANALYZER_DEAD)
+				best += IsCoin(dims, items + z * sliceCells, s);
+
+			coins[s] = best;
+		}
+	}
+
+	// Entry states, the ground states are the first ones
+	int start = -1;
+	analysis.EntryStates = 0;
+	analysis.MaxCoins = ANALYZER_DEAD;
+	analysis.GroundPassable = true;
+
+	for (int s = 0; s < n; ++s) {
+		if (tables.Coins[s] == ANALYZER_DEAD) {
+			if (s < dims.X)
+				analysis.GroundPassable = false;
+			continue;
+		}
+
+		analysis.EntryStates++;
+
+		if (tables.Coins[s] > analysis.MaxCoins) {
+			analysis.MaxCoins = tables.Coins[s];
+			start = s;
+		}
+	}
+
+	analysis.Passable = (start >= 0);
+	analysis.Path.clear();
+	analysis.ReactionSlices = 0;
+
+	if (!analysis.Passable) {
+		analysis.MaxCoins = 0;
+		return;
+	}
+
+	// Path collecting the most coins
+	analysis.Path.reserve(dims.Z);
+
+	for (int z = 0, s = start; z < dims.Z; ++z) {
+		analysis.Path.push_back(BlockGraph::GetStateLanes(dims, s));
+
+		if (z + 1 == dims.Z)
+			break;
+
+		size_t row = (size_t)z * n + s;
+		const LaneMove* moves = &tables.Moves[row * GRAPH_MAX_MOVES];
+		const int* nextCoins = &tables.Coins[(size_t)(z + 1) * n];
+		int next = -1;
+
+		for (int m = 0; m < tables.MovesCount[row]; ++m) {
+			if (next < 0 || nextCoins[moves[m].State] > nextCoins[next])
+				next = moves[m].State;
+		}
+
+		s = next;
+	}
+
+	// Most slices before the first key press and between two key presses, going forward through the states that lead to the end.
+	// The row of a state holds the best reaction slices by the slices since the last key press, capped at the block length,
+	// and in its last column the paths without any key pressed yet, which the slices since the start of the block are known for
+	int* current = &tables.Reaction[0][0];
+	int* next = &tables.Reaction[1][0];
+
+	for (int s = 0; s < n; ++s) {
+		fill(current + s * width, current + (s + 1) * width, ANALYZER_DEAD);
+
+		if (tables.Coins[s] != ANALYZER_DEAD)
+			current[s * width + noPress] = tables.NoInput;
+	}
+
+	for (int z = 0; z + 1 < dims.Z; ++z) {
+		const int* nextCoins = &tables.Coins[(size_t)(z + 1) * n];
+		fill(next, next + n * width, ANALYZER_DEAD);
+
+		for (int s = 0; s < n; ++s) {
+			size_t row = (size_t)z * n + s;
+			const LaneMove* moves = &tables.Moves[row * GRAPH_MAX_MOVES];
+
+			// Only the states leading to the end of the block are ever reached
+			if (tables.Coins[row] == ANALYZER_DEAD)
+				continue;
+
+			for (int g = 0; g < width; ++g) {
+				int reaction = current[s * width + g];
+				if (reaction == ANALYZER_DEAD)
+					continue;
+
+				// The first key press comes after every slice so far
+				int slices = (g == noPress) ? z + 1 : g + 1;
+
+				for (int m = 0; m < tables.MovesCount[row]; ++m) {
+					const LaneMove& move = moves[m];
+					if (nextCoins[move.State] == ANALYZER_DEAD)
+						continue;
+
+					int& target = move.Input ? next[move.State * width] : next[move.State * width + ((g == noPress) ? noPress : min(g + 1, dims.Z))];
+					target = max(target, move.Input ? min(reaction, slices) : reaction);
+				}
+			}
+		}
+
+		swap(current, next);
+	}
+
+	for (int s = 0; s < n * width; ++s) {
+		analysis.ReactionSlices = max(analysis.ReactionSlices, current[s]);
+	}
+}
+
+/* Returns the text of a reaction time in seconds at the given camera speed */
+static string ReactionText(int slices, const AnalyzerTables& tables, double speed) {
+	if (slices == tables.NoInput)
+		return "no input";
+
+	ostringstream text;
+	text << slices * LANE_DEPTH / speed << " s";
+	return text.str();
+}
+
+
+/*
+	Offline level analyzer.
+	Checks every item of a level and runs a dynamic programming pass over the (slice, lane, height, air) states of every block
+	at the given camera speed, with the lane moves of the block graph and the jump the camera kinematics give at that speed. Reports whether each block can be passed,
+	the most time the character can get between two key presses while passing it, and the path collecting the most coins.
+	Exits with an error if the level has invalid items or blocks that can't be passed, so it can run in the content pipeline.
+
+	Usage: LevelAnalyzer level_path [-v camera_speed] [-q] [-p]
+		-v	Camera speed in units per second (default the initial camera speed)
+		-q	Only prints the blocks with problems and the summary
+		-p	Prints the path collecting the most coins of every block, as the x,y lanes of every slice
+*/
+int main(int argc, char** argv) {
+	string levelPath;
+	double speed = CAMERA_SPEED_INIT;
+	bool quiet = false;
+	bool printPaths = false;
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-v" && i + 1 < argc)
+			speed = atof(argv[++i]);
+		else if (arg == "-q")
+			quiet = true;
+		else if (arg == "-p")
+			printPaths = true;
+		else if (levelPath.empty() && arg[0] != '-')
+			levelPath = arg;
+		else {
+			levelPath.clear();
+			break;
+		}
+	}
+
+	if (levelPath.empty()) {
+		cout << "Usage: " << argv[0] << " level_path [-v camera_speed] [-q] [-p]" << endl;
+		return 1;
+	}
+
+	if (speed <= 0) {
+		cout << "GAME::ERROR: The camera speed must be positive" << endl;
+		return 1;
+	}
+
+	Level level;
+	if (!level.Load(levelPath))
+		return 1;
+
+	const GridDims& dims = level.GetDims();
+	int sliceCells = dims.Y * dims.X;
+	int blockSize = level.GetBlockSize();
+
+	AnalyzerTables* tables = new AnalyzerTables();
+	InitTables(dims, BlockGraph::GetJumpSlices(speed), *tables);
+
+	int blocksCount = level.GetBlocksCount();
+	int invalidBlocks = 0;
+	int unpassableBlocks = 0;
+	int groundBlocks = 0;
+	int minReaction = tables->NoInput;
+	int minReactionBlock = -1;
+	long long totalCoins = 0;
+
+	vector<unsigned char> cells((size_t)GRAPH_READ_BLOCKS * blockSize);
+	vector<unsigned char> items((size_t)dims.Z * sliceCells);
+	BlockAnalysis analysis;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (int first = 0; first < blocksCount; first += GRAPH_READ_BLOCKS) {
+		int count = min(GRAPH_READ_BLOCKS, blocksCount - first);
+		level.CopyBlocks(first, count, &cells[0]);
+
+		for (int i = 0; i < count; ++i) {
+			int b = first + i;
+			analysis.Valid = true;
+
+			for (int z = 0; z < dims.Z; ++z) {
+				unsigned char* slice = &items[z * sliceCells];
+				Level::UnpackSlice(dims, &cells[(size_t)i * blockSize], z, slice);
+
+				for (int c = 0; c < sliceCells; ++c) {
+					if (slice[c] >= ITEMS_COUNT) {
+						if (analysis.Valid)
+							cout << "GAME::ERROR: Block " << b << " has an invalid item " << (int)slice[c] << " in slice " << z << endl;
+						analysis.Valid = false;
+					}
+				}
+			}
+
+			if (!analysis.Valid) {
+				invalidBlocks++;
+				continue;
+			}
+
+			AnalyzeBlock(&items[0], *tables, analysis);
+
+			if (!analysis.Passable) {
+				unpassableBlocks++;
+				cout << "GAME::ERROR: Block " << b << " can't be passed" << endl;
+				continue;
+			}
+
+			groundBlocks += analysis.GroundPassable;
+			totalCoins += analysis.MaxCoins;
+
+			if (analysis.ReactionSlices < minReaction) {
+				minReaction = analysis.ReactionSlices;
+				minReactionBlock = b;
+			}
+
+			if (!quiet) {
+				cout << "Block " << b << ": entry states " << analysis.EntryStates
+					<< (analysis.GroundPassable ? ", passable from the ground" : ", passable from some lanes only")
+					<< ", reaction " << ReactionText(analysis.ReactionSlices, *tables, speed)
+					<< ", max coins " << analysis.MaxCoins << endl;
+			}
+
+			if (printPaths) {
+				cout << "Block " << b << " path:";
+				for (size_t z = 0; z < analysis.Path.size(); ++z) {
+					cout << " " << analysis.Path[z] % dims.X << "," << analysis.Path[z] / dims.X;
+				}
+				cout << endl;
+			}
+		}
+	}
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	int passableBlocks = blocksCount - invalidBlocks - unpassableBlocks;
+
+	cout << "Blocks: " << blocksCount << endl;
+	cout << "Lanes: " << dims.X << " x " << dims.Y << " x " << dims.Z << endl;
+	cout << "Camera speed: " << speed << " (jump " << tables->JumpSlices << " slices)" << endl;
+	cout << "Invalid blocks: " << invalidBlocks << endl;
+	cout << "Blocks that can't be passed: " << unpassableBlocks << endl;
+	cout << "Blocks passable from every ground lane: " << groundBlocks << endl;
+	cout << "Blocks without a legal successor: " << level.GetGraph().GetDeadEnds() << endl;
+
+	if (minReactionBlock >= 0)
+		cout << "Shortest reaction time: " << ReactionText(minReaction, *tables, speed) << " (block " << minReactionBlock << ")" << endl;
+
+	cout << "Average max coins: " << (passableBlocks > 0 ? (double)totalCoins / passableBlocks : 0.0) << endl;
+	cout << "Blocks/s: " << (long long)(blocksCount / max(elapsed, 1e-9)) << endl;
+
+	delete tables;
+
+	return (invalidBlocks > 0 || unpassableBlocks > 0) ? 1 : 0;
+}
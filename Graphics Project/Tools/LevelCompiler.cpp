@@ -0,0 +1,67 @@
+// STL Includes
+#include <iostream>
+#include <string>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/BlockGraph.h"
+
+
+/*
+	Offline level compiler.
+	Turns a text level file into a level pack that the game maps into memory at startup,
+	then loads the written pack back and checks that every item matches the text level.
+	Reports the blocks that can't be passed and the blocks that no block can follow.
+
+	Usage: LevelCompiler input_path output_path
+*/
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		cout << "Usage: " << argv[0] << " input_path output_path" << endl;
+		return 1;
+	}
+
+	Level level;
+	if (!level.Load(argv[1]) || !level.Save(argv[2]))
+		return 1;
+
+	// Verify the written pack
+	Level pack;
+	if (!pack.Load(argv[2]))
+		return 1;
+
+	const GridDims& dims = level.GetDims();
+
+	if (pack.GetBlocksCount() != level.GetBlocksCount() || !(pack.GetDims() == dims)) {
+		cout << "GAME::ERROR: Level pack " << argv[2] << " has a different blocks count or lanes counts" << endl;
+		return 1;
+	}
+
+	for (int b = 0; b < level.GetBlocksCount(); ++b) {
+		for (int z = 0; z < dims.Z; ++z) {
+			for (int y = 0; y < dims.Y; ++y) {
+				for (int x = 0; x < dims.X; ++x) {
+					if (pack.GetItem(b, z, y, x) != level.GetItem(b, z, y, x)) {
+						cout << "GAME::ERROR: Level pack " << argv[2] << " differs at block " << b << endl;
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	cout << "Lanes: " << dims.X << " x " << dims.Y << " x " << dims.Z << endl;
+	cout << "Blocks: " << level.GetBlocksCount() << endl;
+	cout << "Block size: " << level.GetBlockSize() << " bytes" << endl;
+	cout << "Pack size: " << LEVEL_PACK_HEADER_SIZE + (long long)level.GetBlocksCount() * level.GetBlockSize() << " bytes" << endl;
+
+	cout << "Blocks without a legal successor: " << pack.GetGraph().GetDeadEnds() << endl;
+
+	for (int b = 0; b < level.GetBlocksCount(); ++b) {
+		if (!pack.GetGraph().IsPassable(b))
+			cout << "GAME::WARNING: Block " << b << " can't be passed" << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,356 @@
+// STL Includes
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/GameBatch.h"
+#include "../Components/CameraKinematics.h"
+#include "../Utils/Random.h"
+
+
+// Micro-benchmark constants
+const double MICROBENCH_MIN_BATCH_TIME = 0.02;		// Seconds a timed batch of operations lasts at least
+const int MICROBENCH_BATCHES = 7;					// Batches timed per benchmark, the median one is reported
+const int MICROBENCH_SYNTHETIC_BLOCKS = 64;			// Blocks of the synthetic levels
+const string MICROBENCH_SYNTHETIC_PATH = "MicroBench_synthetic.txt";
+
+
+// Allocations made by the whole program, counted by the global operator new
+static atomic<long long> sAllocations(0);
+
+/* Counts an allocation and allocates the given number of bytes */
+void* operator new(size_t size) {
+	sAllocations.fetch_add(1, memory_order_relaxed);
+
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL)
+		throw bad_alloc();
+
+	return memory;
+}
+
+/* Frees memory allocated by the counting operator new */
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+// Keeps the results of the timed operations alive
+static volatile unsigned long long sSink = 0;
+
+
+/*
+	Measure of a benchmark
+*/
+struct MicroResult {
+	string Grid;
+	string Name;
+	double NsPerOp;
+	double AllocsPerOp;
+};
+
+
+/*
+	Times the per-tick code of the games, which is private to GameBatch, on a single game of a batch.
+	Every operation is a single call on the game's live grid, so the grid keeps the shapes the game plays with
+*/
+class GameBatchBenchmark
+{
+public:
+	/* Runs all of the benchmarks on a batch of one game with the code specialized for its grid dimensions */
+	static void Run(GameBatch& batch, const string& grid, vector<MicroResult>& results) {
+		switch (batch.mGridConfig) {
+		case GRID_DEFAULT:
+			Run(DefaultGridDims(), batch, grid, results);
+			break;
+		case GRID_WIDE:
+			Run(WideGridDims(), batch, grid, results);
+			break;
+		case GRID_DEEP:
+			Run(DeepGridDims(), batch, grid, results);
+			break;
+		default:
+			Run(batch.mDims, batch, grid, results);
+			break;
+		}
+	}
+
+private:
+	/* Runs all of the benchmarks on a batch of one game */
+	template <class Dims>
+	static void Run(const Dims& dims, GameBatch& batch, const string& grid, vector<MicroResult>& results) {
+		const Level& level = *batch.mLevel;
+		vector<unsigned char> cells(level.GetBlockSize());
+		vector<unsigned char> items(dims.Y * dims.X);
+		int blocksCount = level.GetBlocksCount();
+
+		// Unpacks a slice of a level block, as the grid is filled
+		results.push_back(Measure(grid, "GetSlice", [&](long long ops) {
+			unsigned long long sum = 0;
+
+			for (long long i = 0; i < ops; ++i) {
+				int z = (int)(i % dims.Z);
+
+				if (z == 0)
+					level.CopyBlock((int)((i / dims.Z) % blocksCount), &cells[0]);
+
+				Level::UnpackSlice(dims, &cells[0], z, &items[0]);
+				sum += items[(size_t)i % items.size()];
+			}
+
+			sSink += sum;
+		}));
+
+		// Writes the items of a slice of the grid and computes its row masks
+		results.push_back(Measure(grid, "EditSlice", [&](long long ops) {
+			int slices = max(batch.mGridSize[0], 1);
+
+			for (long long i = 0; i < ops; ++i) {
+				int z = (int)(i % slices);
+				unsigned char* slice = &batch.GridItem(dims, 0, z, 0, 0);
+
+				for (int j = 0; j < dims.Y * dims.X; ++j) {
+					slice[j] = items[j];
+				}
+
+				batch.UpdateMasks(dims, 0, z);
+			}
+		}));
+
+		// Moves the camera a slice forward and drops the passed slice, the dropped slices are put back every turn of the grid
+		results.push_back(Measure(grid, "ClearGrid", [&](long long ops) {
+			CameraKinematics& kinematics = batch.mKinematics[0];
+			int viewSlices = batch.mViewSlices;
+
+			for (long long i = 0; i < ops; ++i) {
+				if (batch.mGridSize[0] <= 1)
+					batch.mGridSize[0] = viewSlices;
+
+				kinematics.Translate(0.0f, 0.0f, -LANE_DEPTH);
+				batch.ClearGrid(dims, 0);
+			}
+		}));
+
+		// Fills the last slice of the view again, picking and copying a new block every block length
+		results.push_back(Measure(grid, "GenerateSceneItems", [&](long long ops) {
+			for (long long i = 0; i < ops; ++i) {
+				batch.mGridSize[0]--;
+				batch.GenerateSceneItems(dims, 0);
+			}
+		}));
+
+		// Tests the character against the grid on every lane in turn
+		results.push_back(Measure(grid, "DetectCollision", [&](long long ops) {
+			for (long long i = 0; i < ops; ++i) {
+				int x = (int)(i % dims.X);
+				int y = (int)((i / dims.X) % dims.Y);
+
+				batch.mGameState[0] = RUNNING;
+				batch.DetectCollision(dims, 0, (x - (dims.X - 1) / 2) * LANE_WIDTH, y * LANE_HEIGHT);
+			}
+
+			sSink += batch.mBorderLeft[0] + batch.mBorderRight[0];
+		}));
+
+		// A whole tick of a game, restarted whenever it is lost, from a clean game since the other benchmarks edit it freely
+		Random bot(1);
+		batch.Reset(0);
+
+		results.push_back(Measure(grid, "Step", [&](long long ops) {
+			for (long long i = 0; i < ops; ++i) {
+				batch.Step(0, bot.Next() & (INPUT_LEFT | INPUT_RIGHT | INPUT_JUMP), SIMULATION_TICK_TIME);
+			}
+		}));
+	}
+
+public:
+	/* Times the given operation, called with the number of operations to run, and counts the allocations it makes */
+	template <class Operation>
+	static MicroResult Measure(const string& grid, const string& name, Operation operation) {
+		// Grow the batches until they are long enough for the clock
+		long long ops = 16;
+
+		for (;;) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			operation(ops);
+
+			if (chrono::duration<double>(chrono::steady_clock::now() - start).count() >= MICROBENCH_MIN_BATCH_TIME)
+				break;
+
+			ops *= 2;
+		}
+
+		vector<double> times;
+		times.reserve(MICROBENCH_BATCHES);
+		long long allocations = sAllocations.load(memory_order_relaxed);
+
+		for (int i = 0; i < MICROBENCH_BATCHES; ++i) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			operation(ops);
+			times.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / ops);
+		}
+
+		allocations = sAllocations.load(memory_order_relaxed) - allocations;
+		sort(times.begin(), times.end());
+
+		MicroResult result;
+		result.Grid = grid;
+		result.Name = name;
+		result.NsPerOp = times[times.size() / 2];
+		result.AllocsPerOp = (double)allocations / ((double)ops * MICROBENCH_BATCHES);
+		return result;
+	}
+};
+
+
+/* Writes a text level of random blocks of the given dimensions, returns false on failure */
+static bool WriteSyntheticLevel(const string& path, const GridDims& dims, unsigned int seed) {
+	ofstream fout(path.c_str());
+	if (!fout.is_open()) {
+		cout << "GAME::ERROR: Could not write file " << path << endl;
+		return false;
+	}
+
+	Random random(seed);
+	fout << dims.X << " " << dims.Y << " " << dims.Z << "\n" << MICROBENCH_SYNTHETIC_BLOCKS << "\n";
+
+	for (int b = 0; b < MICROBENCH_SYNTHETIC_BLOCKS; ++b) {
+		for (int y = 0; y < dims.Y; ++y) {
+			for (int x = 0; x < dims.X; ++x) {
+				string line(dims.Z, '0');
+
+				// The initial block is empty, the other ones have a block and a coin every ten items and a gem every thirty
+				for (int z = 0; z < dims.Z && b > 0; ++z) {
+					int roll = random.NextInt(30);
+
+					if (roll < 3)
+						line[z] = '0' + BLOCK;
+					else if (roll < 6)
+						line[z] = '0' + COIN;
+					else if (roll < 7)
+						line[z] = '0' + GEM_DOUBLE_SCORE + random.NextInt(GEM_REVERSED_MODE - GEM_DOUBLE_SCORE + 1);
+				}
+
+				fout << line << "\n";
+			}
+
+			fout << "\n";
+		}
+	}
+
+	return true;
+}
+
+/* Runs the benchmarks on the given level, named after its grid */
+static bool RunLevel(const string& path, const string& grid, unsigned int seed, int viewSlices, vector<MicroResult>& results) {
+	Level level;
+	if (!level.Load(path))
+		return false;
+
+	GameBatch batch(&level, 1, seed, 1, viewSlices);
+	GameBatchBenchmark::Run(batch, grid, results);
+
+	// A camera moving forward and jumping, as Camera::Update animates it
+	CameraKinematics kinematics;
+	kinematics.SetPosition(0.0f, GRAVITY_POS, 0.0f);
+	kinematics.SetMoveSpeed(CAMERA_SPEED_INIT);
+
+	results.push_back(GameBatchBenchmark::Measure(grid, "Camera::Update", [&](long long ops) {
+		for (long long i = 0; i < ops; ++i) {
+			if ((i & 63) == 0) {
+				kinematics.SetPosition(0.0f, GRAVITY_POS, 0.0f);
+				kinematics.Jump(CAMERA_JUMP_OFFSET);
+			}
+
+			kinematics.MoveStep(FORWARD, LANE_DEPTH);
+			kinematics.Update(SIMULATION_TICK_TIME);
+		}
+
+		sSink += (unsigned long long)kinematics.GetPositionY();
+	}));
+
+	return true;
+}
+
+/*
+	Micro-benchmarks of the per-tick game code.
+	Times the grid, generation and collision code of a game and the camera animation in isolation, on the game's level
+	and on synthetic levels of several grid dimensions, each one run with the code the game runs for its dimensions.
+	Prints the median time of an operation and the allocations made per operation, which should be none.
+	Must be run from the game directory, next to its Levels.
+
+	Usage: MicroBench [-l level_path] [-v view_slices] [-s seed] [-q]
+		-l	Path of the level file (default Levels/Level.txt)
+		-v	Number of slices kept ahead of the game (default a block length)
+		-s	Seed of the game and of the synthetic levels (default 0)
+		-q	Only benchmarks the level file, without the synthetic levels
+*/
+int main(int argc, char** argv) {
+	string levelPath = "Levels/Level.txt";
+	int viewSlices = 0;
+	unsigned int seed = 0;
+	bool quick = false;
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-l" && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (arg == "-v" && i + 1 < argc)
+			viewSlices = atoi(argv[++i]);
+		else if (arg == "-s" && i + 1 < argc)
+			seed = (unsigned int)atoll(argv[++i]);
+		else if (arg == "-q")
+			quick = true;
+		else {
+			cout << "Usage: " << argv[0] << " [-l level_path] [-v view_slices] [-s seed] [-q]" << endl;
+			return 1;
+		}
+	}
+
+	vector<MicroResult> results;
+	if (!RunLevel(levelPath, "level", seed, viewSlices, results))
+		return 1;
+
+	// Grids of the specialized configurations and the largest grid, which runs the code sized at runtime
+	const GridDims synthetic[] = {
+		DEFAULT_GRID_DIMS,
+		{ WideGridDims::X, WideGridDims::Y, WideGridDims::Z },
+		{ DeepGridDims::X, DeepGridDims::Y, DeepGridDims::Z },
+		{ LANES_X_MAX, LANES_Y_MAX, LANES_Z_MAX },
+	};
+
+	for (int i = 0; i < (quick ? 0 : (int)(sizeof(synthetic) / sizeof(synthetic[0]))); ++i) {
+		const GridDims& dims = synthetic[i];
+		string grid = to_string(dims.X) + "x" + to_string(dims.Y) + "x" + to_string(dims.Z);
+
+		bool written = WriteSyntheticLevel(MICROBENCH_SYNTHETIC_PATH, dims, seed + i);
+		bool run = written && RunLevel(MICROBENCH_SYNTHETIC_PATH, grid, seed, viewSlices, results);
+		remove(MICROBENCH_SYNTHETIC_PATH.c_str());
+
+		if (!run)
+			return 1;
+	}
+
+	cout << left << setw(10) << "Grid" << setw(22) << "Benchmark" << right << setw(12) << "ns/op" << setw(14) << "allocs/op" << endl;
+	cout << fixed;
+
+	for (unsigned int i = 0; i < results.size(); ++i) {
+		cout << left << setw(10) << results[i].Grid << setw(22) << results[i].Name << right
+			<< setw(12) << setprecision(1) << results[i].NsPerOp
+			<< setw(14) << setprecision(3) << results[i].AllocsPerOp << endl;
+	}
+
+	return 0;
+}
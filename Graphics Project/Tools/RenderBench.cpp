@@ -0,0 +1,410 @@
+// STL Includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Game/GameEngine.h"
+#include "../Game/Game.h"
+#include "../Game/Level.h"
+#include "../Game/GameLogic.h"
+#include "../Game/Replay.h"
+#include "../Game/BlockGenerator.h"
+#include "../Utils/OffscreenContext.h"
+#include "../Utils/RenderStats.h"
+#include "../Utils/Random.h"
+#include "../Utils/Profiler.h"
+
+// Benchmark constants
+const double BENCH_FRAME_STEP = 1.0 / 60.0;		// Game time between two frames, whatever the time they take to draw
+const int BENCH_DEFAULT_FRAMES = 600;
+const int BENCH_DEFAULT_WARMUP = 60;
+const string BENCH_DEFAULT_RESOLUTIONS = "640x360,1280x720,1920x1080";
+const string BENCH_DEFAULT_VIEW_SLICES = "0,256";
+const string BENCH_DEFAULT_ANTI_ALIASING = "msaa4";
+
+
+/*
+	Frame values of a scenario, summarized into percentiles
+*/
+struct BenchSeries {
+	string Name;
+	vector<double> Values;
+};
+
+
+/*
+	Size of the frames, items density and anti-aliasing a run is measured at
+*/
+struct BenchScenario {
+	int Width;
+	int Height;
+	int ViewSlices;
+	AntiAliasing AA;
+};
+
+
+/* Splits the given comma separated list */
+static vector<string> SplitList(const string& list) {
+	vector<string> items;
+	stringstream ss(list);
+	string item;
+
+	while (getline(ss, item, ',')) {
+		if (!item.empty())
+			items.push_back(item);
+	}
+
+	return items;
+}
+
+/* Returns the value at the given percentile of the sorted values */
+static double Percentile(const vector<double>& sorted, double percentile) {
+	if (sorted.empty())
+		return 0;
+
+	size_t index = (size_t)(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[min(index, sorted.size() - 1)];
+}
+
+/* Writes the distribution of the given series as a JSON object */
+static void WriteSeries(ostream& out, const BenchSeries& series) {
+	vector<double> sorted = series.Values;
+	sort(sorted.begin(), sorted.end());
+
+	double mean = 0;
+	for (unsigned int i = 0; i < sorted.size(); ++i) {
+		mean += sorted[i];
+	}
+
+	if (!sorted.empty())
+		mean /= sorted.size();
+
+	out << "\"" << series.Name << "\": {"
+		<< "\"mean\": " << mean
+		<< ", \"min\": " << (sorted.empty() ? 0 : sorted.front())
+		<< ", \"p50\": " << Percentile(sorted, 50)
+		<< ", \"p90\": " << Percentile(sorted, 90)
+		<< ", \"p95\": " << Percentile(sorted, 95)
+		<< ", \"p99\": " << Percentile(sorted, 99)
+		<< ", \"max\": " << (sorted.empty() ? 0 : sorted.back())
+		<< "}";
+}
+
+/* Returns the time of the given scope in the last profiled frame, in milliseconds */
+static double GetScopeTime(const vector<pair<string, float>>& times, const string& name) {
+	for (unsigned int i = 0; i < times.size(); ++i) {
+		if (times[i].first == name)
+			return times[i].second;
+	}
+
+	return 0;
+}
+
+/* Records a bot session of the given number of ticks, restarting the game whenever it is lost */
+static Replay* RecordBot(unsigned int seed, bool procedural, long long ticks) {
+	Level level;
+	if (!level.LoadLatest(LEVEL_PACK_PATH, LEVEL_PATH))
+		return NULL;
+
+	Replay* replay = new Replay(seed, SIMULATION_TICK_RATE, procedural ? REPLAY_FLAG_PROCEDURAL : 0);
+	GameLogic logic(&level, seed);
+	BlockGenerator* generator = NULL;
+
+	if (procedural) {
+		generator = new BlockGenerator(1);
+		logic.SetGenerator(generator);
+		logic.Seed(seed);
+	}
+
+	Random bot(seed + 1);
+
+	for (long long t = 0; t < ticks; ++t) {
+		unsigned int input = logic.GetGameState() == LOST ? INPUT_REPLAY : (bot.Next() & (INPUT_LEFT | INPUT_RIGHT | INPUT_JUMP));
+		replay->Record(input);
+		logic.Step(input, SIMULATION_TICK_TIME);
+	}
+
+	logic.SetGenerator(NULL);
+	delete generator;
+
+	return replay;
+}
+
+/* Returns the given capture path with the scenario inserted before its extension */
+static string GetCapturePath(const string& path, const BenchScenario& scenario) {
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+
+	if (dot == string::npos || (slash != string::npos && dot < slash))
+		dot = path.size();
+
+	return path.substr(0, dot) + "_" + to_string(scenario.Width) + "x" + to_string(scenario.Height) + "_" + to_string(scenario.ViewSlices)
+		+ "_" + AA_NAMES[scenario.AA] + path.substr(dot);
+}
+
+/* Plays the session through the real renderer at the given scenario and writes its measures as a JSON object,
+   the resolution of the scene is scaled to the given budget in seconds unless 0,
+   the frames are recorded into the given path unless empty, returns false on failure */
+static bool RunScenario(const BenchScenario& scenario, const Replay& session, int warmup, int frames, double budget, const string& capturePath,
+	ostream& out, string& renderer) {
+	GameEngine* engine = new GameEngine(scenario.Width, scenario.Height, false, true);
+
+	if (engine->GetTarget() == NULL || !engine->GetTarget()->IsComplete()) {
+		delete engine;
+		return false;
+	}
+
+	renderer = OffscreenContext::GetRenderer();
+
+	Game* game = new Game(engine, "Tunnel Runner");
+	game->SetViewSlices(scenario.ViewSlices);
+	engine->SetAntiAliasing(scenario.AA);
+	game->StartReplay(new Replay(session));
+
+	engine->SetDynamicResolution(budget);
+
+	// The recording is part of the measured frames
+	if (!capturePath.empty())
+		engine->StartCapture(GetCapturePath(capturePath, scenario), (int)(1.0 / BENCH_FRAME_STEP + 0.5));
+
+	BenchSeries frameTimes = { "frame_ms" };
+	BenchSeries cpuTimes = { "cpu_ms" };
+	BenchSeries gpuTimes = { "gpu_ms" };
+	BenchSeries drawCalls = { "draw_calls" };
+	BenchSeries triangles = { "triangles" };
+	BenchSeries stateChanges = { "state_changes" };
+	BenchSeries streamedBytes = { "streamed_bytes" };
+	BenchSeries visibleItems = { "visible_items" };
+	BenchSeries culledItems = { "culled_items" };
+	BenchSeries sceneScales = { "scene_scale" };
+
+	vector<pair<string, float>> times;
+	double time = 0, simulationTime = 0;
+	Profiler::SetEnabled(true);
+
+	for (int frame = 0; frame < warmup + frames; ++frame) {
+		// Step the game up to the frame's time, as the simulation thread would
+		time += BENCH_FRAME_STEP;
+
+		while (simulationTime + SIMULATION_TICK_TIME <= time) {
+			game->Update(SIMULATION_TICK_TIME);
+			simulationTime += SIMULATION_TICK_TIME;
+		}
+
+		uint64_t begin = Profiler::Now();
+		engine->RenderFrame(time);
+		double frameTime = (Profiler::Now() - begin) / 1e6;
+
+		if (frame < warmup)
+			continue;
+
+		// The frame waits for the GPU instead of swapping, so the CPU time excludes it
+		Profiler::GetLastFrame(times);
+		const RenderCounters& counters = RenderStats::GetLastFrame();
+
+		frameTimes.Values.push_back(frameTime);
+		cpuTimes.Values.push_back(GetScopeTime(times, "GameEngine::Render") - GetScopeTime(times, "SwapBuffers"));
+		gpuTimes.Values.push_back(GetScopeTime(times, "GPU::Frame"));
+		drawCalls.Values.push_back((double)counters.DrawCalls);
+		triangles.Values.push_back((double)counters.Triangles);
+		stateChanges.Values.push_back((double)counters.StateChanges);
+		streamedBytes.Values.push_back((double)counters.StreamedBytes);
+		visibleItems.Values.push_back((double)counters.VisibleItems);
+		culledItems.Values.push_back((double)counters.CulledItems);
+		sceneScales.Values.push_back((double)counters.SceneWidth / scenario.Width);
+	}
+
+	Profiler::SetEnabled(false);
+	engine->StopCapture();
+
+	long long gpuMemory = 0;
+	for (int i = 0; i < GPU_MEMORY_TYPES; ++i) {
+		gpuMemory += RenderStats::GetGpuMemory((GpuMemoryType)i);
+	}
+
+	const BenchSeries* series[] = { &frameTimes, &cpuTimes, &gpuTimes, &drawCalls, &triangles, &stateChanges, &streamedBytes, &visibleItems, &culledItems, &sceneScales };
+
+	out << "    {\"width\": " << scenario.Width << ", \"height\": " << scenario.Height << ", \"view_slices\": " << scenario.ViewSlices
+		<< ", \"anti_aliasing\": \"" << AA_NAMES[engine->GetAntiAliasing()] << "\""
+		<< ", \"frames\": " << frames << ", \"budget_ms\": " << budget * 1e3 << ", \"gpu_memory_bytes\": " << gpuMemory;
+
+	for (unsigned int i = 0; i < sizeof(series) / sizeof(series[0]); ++i) {
+		out << ",\n      ";
+		WriteSeries(out, *series[i]);
+	}
+
+	out << "}";
+
+	// Progress on the error stream, the results may be written to the standard output
+	sort(frameTimes.Values.begin(), frameTimes.Values.end());
+	cerr << scenario.Width << "x" << scenario.Height << ", " << scenario.ViewSlices << " view slices, " << AA_NAMES[engine->GetAntiAliasing()] << ": frame p50 "
+		<< Percentile(frameTimes.Values, 50) << " ms, p99 " << Percentile(frameTimes.Values, 99) << " ms" << endl;
+
+	// The game frees its GL resources while the context is still current
+	delete game;
+	delete engine;
+
+	return true;
+}
+
+/*
+	Headless rendering benchmark.
+	Plays a deterministic session through the real renderer on an offscreen context, such as llvmpipe on a machine without display,
+	at several frame sizes, items densities and anti-aliasing modes, and writes the distribution of the frame times, the CPU/GPU split
+	and the rendering counters as JSON for regression tracking.
+	The game is stepped by a fixed time between frames so every run draws the same frames, however long they take.
+	Must be run from the game directory, next to its Models, Shaders and Levels.
+
+	Usage: RenderBench [-d resolutions] [-v view_slices] [-a anti_aliasing] [-n frames] [-w warmup_frames] [-s seed] [-p] [-r replay_path] [-b budget_ms] [-c capture_path] [-o json_path]
+		-d	Comma separated frame sizes, such as 1280x720 (default 640x360,1280x720,1920x1080)
+		-v	Comma separated numbers of slices seen ahead, 0 for a block length (default 0,256)
+		-a	Comma separated anti-aliasing modes among none, msaa2, msaa4, msaa8 and fxaa (default msaa4)
+		-n	Number of measured frames per scenario (default 600)
+		-w	Number of frames drawn before measuring (default 60)
+		-s	Seed of the bot session (default 1)
+		-p	Plays procedurally generated blocks after the level's initial block
+		-r	Plays the given replay file instead of a bot session
+		-b	Scales the resolution of the scene every frame so that drawing it takes the given GPU time (default fixed at the frame's)
+		-c	Records the frames of each scenario into the given path suffixed with the scenario, as a Y4M video if it ends with .y4m
+			or else as numbered PNG images
+		-o	Writes the JSON results into the given file (default standard output)
+*/
+int main(int argc, char** argv) {
+	string resolutions = BENCH_DEFAULT_RESOLUTIONS;
+	string viewSlices = BENCH_DEFAULT_VIEW_SLICES;
+	string antiAliasing = BENCH_DEFAULT_ANTI_ALIASING;
+	int frames = BENCH_DEFAULT_FRAMES;
+	int warmup = BENCH_DEFAULT_WARMUP;
+	unsigned int seed = 1;
+	bool procedural = false;
+	string replayPath;
+	double budget = 0;
+	string capturePath;
+	string outputPath;
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-d" && i + 1 < argc)
+			resolutions = argv[++i];
+		else if (arg == "-v" && i + 1 < argc)
+			viewSlices = argv[++i];
+		else if (arg == "-a" && i + 1 < argc)
+			antiAliasing = argv[++i];
+		else if (arg == "-n" && i + 1 < argc)
+			frames = atoi(argv[++i]);
+		else if (arg == "-w" && i + 1 < argc)
+			warmup = atoi(argv[++i]);
+		else if (arg == "-s" && i + 1 < argc)
+			seed = (unsigned int)atoll(argv[++i]);
+		else if (arg == "-p")
+			procedural = true;
+		else if (arg == "-r" && i + 1 < argc)
+			replayPath = argv[++i];
+		else if (arg == "-b" && i + 1 < argc)
+			budget = atof(argv[++i]) / 1e3;
+		else if (arg == "-c" && i + 1 < argc)
+			capturePath = argv[++i];
+		else if (arg == "-o" && i + 1 < argc)
+			outputPath = argv[++i];
+		else {
+			cout << "Usage: " << argv[0] << " [-d resolutions] [-v view_slices] [-a anti_aliasing] [-n frames] [-w warmup_frames] [-s seed] [-p] [-r replay_path] [-b budget_ms] [-c capture_path] [-o json_path]" << endl;
+			return 1;
+		}
+	}
+
+	vector<BenchScenario> scenarios;
+	vector<string> sizes = SplitList(resolutions);
+	vector<string> densities = SplitList(viewSlices);
+	vector<string> modes = SplitList(antiAliasing);
+
+	for (unsigned int i = 0; i < sizes.size(); ++i) {
+		for (unsigned int j = 0; j < densities.size(); ++j) {
+			for (unsigned int k = 0; k < modes.size(); ++k) {
+				BenchScenario scenario;
+
+				if (sscanf(sizes[i].c_str(), "%dx%d", &scenario.Width, &scenario.Height) != 2 || scenario.Width <= 0 || scenario.Height <= 0) {
+					cout << "GAME::ERROR: Invalid frame size " << sizes[i] << endl;
+					return 1;
+				}
+
+				if (!SceneTarget::ParseAntiAliasing(modes[k], scenario.AA))
+					return 1;
+
+				scenario.ViewSlices = atoi(densities[j].c_str());
+				scenarios.push_back(scenario);
+			}
+		}
+	}
+
+	// Every scenario plays the same session, long enough for all its frames
+	Replay* session;
+
+	if (!replayPath.empty()) {
+		session = new Replay();
+
+		if (!session->Load(replayPath)) {
+			delete session;
+			return 1;
+		}
+	}
+	else {
+		session = RecordBot(seed, procedural, (long long)((warmup + frames) * BENCH_FRAME_STEP * SIMULATION_TICK_RATE) + 1);
+
+		if (session == NULL)
+			return 1;
+	}
+
+	stringstream results;
+	string renderer;
+	bool failed = false;
+
+	for (unsigned int i = 0; i < scenarios.size(); ++i) {
+		if (i > 0)
+			results << ",\n";
+
+		if (!RunScenario(scenarios[i], *session, warmup, frames, budget, capturePath, results, renderer)) {
+			cout << "GAME::ERROR: Unable to draw offscreen at " << scenarios[i].Width << "x" << scenarios[i].Height << endl;
+			failed = true;
+			break;
+		}
+	}
+
+	unsigned int sessionSeed = session->GetSeed();
+	unsigned long long sessionTicks = session->GetTicksCount();
+	delete session;
+
+	if (failed)
+		return 1;
+
+	ofstream file;
+	if (!outputPath.empty()) {
+		file.open(outputPath.c_str());
+
+		if (!file) {
+			cout << "GAME::ERROR: Unable to write " << outputPath << endl;
+			return 1;
+		}
+	}
+
+	ostream& out = outputPath.empty() ? cout : file;
+
+	out << "{\n"
+		<< "  \"renderer\": \"" << renderer << "\",\n"
+		<< "  \"seed\": " << sessionSeed << ",\n"
+		<< "  \"session_ticks\": " << sessionTicks << ",\n"
+		<< "  \"frame_step_ms\": " << BENCH_FRAME_STEP * 1000.0 << ",\n"
+		<< "  \"warmup_frames\": " << warmup << ",\n"
+		<< "  \"scenarios\": [\n" << results.str() << "\n  ]\n"
+		<< "}" << endl;
+
+	return 0;
+}
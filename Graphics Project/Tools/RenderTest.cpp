@@ -0,0 +1,335 @@
+// STL Includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+// GL Includes
+#include <GL/glew.h>
+#include <SOIL/SOIL.h>
+
+// Other includes
+#include "../Game/GameEngine.h"
+#include "../Game/Game.h"
+#include "../Game/Replay.h"
+#include "../Components/Framebuffer.h"
+#include "../Utils/OffscreenContext.h"
+#include "../Utils/RenderStats.h"
+#include "../Utils/Profiler.h"
+
+// Render test constants
+const double RENDER_TEST_FRAME_STEP = 1.0 / 60.0;		// Game time between two frames
+const double RENDER_TEST_COLOR_THRESHOLD = 0.1;			// Perceived difference, from 0 to 1, above which two pixels differ
+const double RENDER_TEST_MAX_DIFF_RATIO = 0.002;		// Share of differing pixels an image may have and still match its golden image
+const double RENDER_TEST_MAX_YIQ_DELTA = 35215.0;		// Weighted squared YIQ difference between black and white
+const string RENDER_TEST_DIR = "Tests/Render/";
+const string RENDER_TEST_SCENARIOS = RENDER_TEST_DIR + "Scenarios.txt";
+const string RENDER_TEST_REPLAY = RENDER_TEST_DIR + "Run.replay";
+
+
+/*
+	Frame drawn by a render test and the budgets of the frames drawn up to it
+*/
+struct RenderScenario {
+	string Name;
+	int Width;
+	int Height;
+	int ViewSlices;
+	int Frame;						// Frame compared with the golden image, counted from 1
+	long long MaxDrawCalls;			// Budgets of every frame
+	long long MaxTriangles;
+	double MaxCpuTime;				// Budget of the median frame, in milliseconds, only checked with -c
+};
+
+
+/*
+	Measures of a render test
+*/
+struct RenderMeasures {
+	long long DrawCalls;			// Most of any frame
+	long long Triangles;
+	double CpuTime;					// Median frame, in milliseconds
+	vector<unsigned char> Pixels;	// Last frame, RGB rows from the top
+	string Renderer;
+};
+
+
+/* Reads the scenarios of the given file, one per line, returns false on failure */
+static bool ReadScenarios(const string& path, vector<RenderScenario>& scenarios) {
+	ifstream fin(path.c_str());
+	if (!fin.is_open()) {
+		cout << "GAME::ERROR: Could not load file " << path << endl;
+		return false;
+	}
+
+	string line;
+	int lineNumber = 0;
+
+	while (getline(fin, line)) {
+		lineNumber++;
+
+		// Line is empty or a comment
+		if (line.find_first_not_of(" \t\r") == string::npos || line[0] == '#')
+			continue;
+
+		RenderScenario scenario;
+		istringstream fields(line);
+
+		if (!(fields >> scenario.Name >> scenario.Width >> scenario.Height >> scenario.ViewSlices >> scenario.Frame
+			>> scenario.MaxDrawCalls >> scenario.MaxTriangles >> scenario.MaxCpuTime) || scenario.Frame <= 0) {
+			cout << "GAME::ERROR: Invalid scenario at line " << lineNumber << " of " << path << endl;
+			return false;
+		}
+
+		scenarios.push_back(scenario);
+	}
+
+	return true;
+}
+
+/* Returns the time of the given scope in the last profiled frame, in milliseconds */
+static double GetScopeTime(const vector<pair<string, float>>& times, const string& name) {
+	for (unsigned int i = 0; i < times.size(); ++i) {
+		if (times[i].first == name)
+			return times[i].second;
+	}
+
+	return 0;
+}
+
+/* Plays the session through the real renderer up to the scenario's frame and measures the frames, returns false on failure */
+static bool RunScenario(const RenderScenario& scenario, const Replay& session, RenderMeasures& measures) {
+	GameEngine* engine = new GameEngine(scenario.Width, scenario.Height, false, true);
+
+	if (engine->GetTarget() == NULL || !engine->GetTarget()->IsComplete()) {
+		delete engine;
+		return false;
+	}
+
+	Game* game = new Game(engine, "Tunnel Runner");
+	game->SetViewSlices(scenario.ViewSlices);
+	game->StartReplay(new Replay(session));
+
+	measures.Renderer = OffscreenContext::GetRenderer();
+	measures.DrawCalls = 0;
+	measures.Triangles = 0;
+
+	vector<double> cpuTimes;
+	vector<pair<string, float>> times;
+	double time = 0, simulationTime = 0;
+	Profiler::SetEnabled(true);
+
+	for (int frame = 0; frame < scenario.Frame; ++frame) {
+		// Step the game up to the frame's time, as the simulation thread would
+		time += RENDER_TEST_FRAME_STEP;
+
+		while (simulationTime + SIMULATION_TICK_TIME <= time) {
+			game->Update(SIMULATION_TICK_TIME);
+			simulationTime += SIMULATION_TICK_TIME;
+		}
+
+		engine->RenderFrame(time);
+
+		// The frame waits for the GPU instead of swapping, so the CPU time excludes it
+		Profiler::GetLastFrame(times);
+		const RenderCounters& counters = RenderStats::GetLastFrame();
+
+		measures.DrawCalls = max(measures.DrawCalls, counters.DrawCalls);
+		measures.Triangles = max(measures.Triangles, counters.Triangles);
+		cpuTimes.push_back(GetScopeTime(times, "GameEngine::Render") - GetScopeTime(times, "SwapBuffers"));
+	}
+
+	Profiler::SetEnabled(false);
+
+	sort(cpuTimes.begin(), cpuTimes.end());
+	measures.CpuTime = cpuTimes[cpuTimes.size() / 2];
+
+	// Resolve the multisampled frame and read it back, the rows of GL images go from the bottom
+	int rowSize = 3 * scenario.Width;
+	vector<unsigned char> pixels((size_t)rowSize * scenario.Height);
+	Framebuffer* resolved = new Framebuffer(scenario.Width, scenario.Height);
+
+	engine->GetTarget()->BlitTo(resolved->GetID(), scenario.Width, scenario.Height);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, scenario.Width, scenario.Height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+
+	measures.Pixels.resize(pixels.size());
+
+	for (int y = 0; y < scenario.Height; ++y) {
+		memcpy(&measures.Pixels[(size_t)y * rowSize], &pixels[(size_t)(scenario.Height - 1 - y) * rowSize], rowSize);
+	}
+
+	// The game frees its GL resources while the context is still current
+	delete resolved;
+	delete game;
+	delete engine;
+
+	return true;
+}
+
+/* Returns the perceived difference between two RGB colors, weighted in the YIQ color space, from 0 to RENDER_TEST_MAX_YIQ_DELTA */
+static double ColorDelta(const unsigned char* a, const unsigned char* b) {
+	double dr = (double)a[0] - b[0];
+	double dg = (double)a[1] - b[1];
+	double db = (double)a[2] - b[2];
+
+	double y = dr * 0.29889531 + dg * 0.58662247 + db * 0.11448223;
+	double i = dr * 0.59597799 - dg * 0.27417610 - db * 0.32180189;
+	double q = dr * 0.21147017 - dg * 0.52261711 + db * 0.31114694;
+
+	return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+}
+
+/* Counts the pixels of an image perceivably different from the golden image and draws them in red over the faded golden image */
+static long long CompareImages(const unsigned char* image, const unsigned char* golden, int pixelsCount, vector<unsigned char>& diff) {
+	double threshold = RENDER_TEST_MAX_YIQ_DELTA * RENDER_TEST_COLOR_THRESHOLD * RENDER_TEST_COLOR_THRESHOLD;
+	long long different = 0;
+
+	diff.resize((size_t)pixelsCount * 3);
+
+	for (int i = 0; i < pixelsCount; ++i) {
+		const unsigned char* a = &image[i * 3];
+		const unsigned char* b = &golden[i * 3];
+		unsigned char* d = &diff[i * 3];
+
+		if (ColorDelta(a, b) > threshold) {
+			different++;
+			d[0] = 255;
+			d[1] = d[2] = 0;
+		}
+		else {
+			d[0] = d[1] = d[2] = (unsigned char)(191 + (b[0] * 0.299 + b[1] * 0.587 + b[2] * 0.114) / 4);
+		}
+	}
+
+	return different;
+}
+
+/*
+	Render regression test.
+	Plays a fixed replay through the real renderer on an offscreen context, such as llvmpipe on a machine without display,
+	and for each scenario of Tests/Render/Scenarios.txt compares the last frame drawn with its golden image,
+	allowing for small perceived differences, and checks the draw calls and triangles of the frames against the scenario's budgets.
+	The CPU time of the frames is reported, and only checked against its budget when asked, as it depends on the load of the machine.
+	The failing frames are written next to an image of their differences.
+	The golden images are recorded on the reference machine, after checking the frames by eye.
+	Must be run from the game directory, next to its Models, Shaders and Tests.
+
+	Usage: RenderTest [-u] [-c] [-o output_dir]
+		-u	Records the golden images from the frames drawn instead of testing them, and prints the measures to set the budgets from
+		-c	Also fails the scenarios whose median frame is over their CPU time budget, on a quiet machine
+		-o	Directory the failing frames and their differences are written into (default current directory)
+*/
+int main(int argc, char** argv) {
+	bool update = false;
+	bool cpuChecked = false;
+	string outputDir = ".";
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-u")
+			update = true;
+		else if (arg == "-c")
+			cpuChecked = true;
+		else if (arg == "-o" && i + 1 < argc)
+			outputDir = argv[++i];
+		else {
+			cout << "Usage: " << argv[0] << " [-u] [-c] [-o output_dir]" << endl;
+			return 1;
+		}
+	}
+
+	vector<RenderScenario> scenarios;
+	if (!ReadScenarios(RENDER_TEST_SCENARIOS, scenarios))
+		return 1;
+
+	Replay session;
+	if (!session.Load(RENDER_TEST_REPLAY))
+		return 1;
+
+	int failures = 0;
+
+	for (unsigned int i = 0; i < scenarios.size(); ++i) {
+		const RenderScenario& scenario = scenarios[i];
+		string goldenPath = RENDER_TEST_DIR + scenario.Name + ".tga";
+		RenderMeasures measures;
+
+		if (!RunScenario(scenario, session, measures)) {
+			cout << "FAIL " << scenario.Name << ": unable to draw offscreen at " << scenario.Width << "x" << scenario.Height << endl;
+			failures++;
+			continue;
+		}
+
+		cout << scenario.Name << ": " << measures.DrawCalls << " draw calls, " << measures.Triangles << " triangles, "
+			<< measures.CpuTime << " ms CPU (" << measures.Renderer << ")" << endl;
+
+		if (update) {
+			if (!SOIL_save_image(goldenPath.c_str(), SOIL_SAVE_TYPE_TGA, scenario.Width, scenario.Height, 3, &measures.Pixels[0])) {
+				cout << "GAME::ERROR: Could not save file " << goldenPath << endl;
+				failures++;
+			}
+
+			continue;
+		}
+
+		vector<string> errors;
+
+		// Budgets
+		if (measures.DrawCalls > scenario.MaxDrawCalls)
+			errors.push_back("draw calls over the budget of " + to_string(scenario.MaxDrawCalls));
+		if (measures.Triangles > scenario.MaxTriangles)
+			errors.push_back("triangles over the budget of " + to_string(scenario.MaxTriangles));
+		if (cpuChecked && measures.CpuTime > scenario.MaxCpuTime)
+			errors.push_back("CPU time over the budget of " + to_string(scenario.MaxCpuTime) + " ms");
+
+		// Golden image
+		int width, height, channels;
+		unsigned char* golden = SOIL_load_image(goldenPath.c_str(), &width, &height, &channels, SOIL_LOAD_RGB);
+
+		if (golden == NULL) {
+			errors.push_back("no golden image " + goldenPath + ", record it with -u");
+		}
+		else if (width != scenario.Width || height != scenario.Height) {
+			errors.push_back("golden image of " + to_string(width) + "x" + to_string(height));
+		}
+		else {
+			vector<unsigned char> diff;
+			int pixelsCount = width * height;
+			long long different = CompareImages(&measures.Pixels[0], golden, pixelsCount, diff);
+
+			if (different > RENDER_TEST_MAX_DIFF_RATIO * pixelsCount) {
+				errors.push_back(to_string(different) + " pixels different from the golden image");
+
+				string basePath = outputDir + "/" + scenario.Name;
+				SOIL_save_image((basePath + "_actual.tga").c_str(), SOIL_SAVE_TYPE_TGA, width, height, 3, &measures.Pixels[0]);
+				SOIL_save_image((basePath + "_diff.tga").c_str(), SOIL_SAVE_TYPE_TGA, width, height, 3, &diff[0]);
+			}
+		}
+
+		if (golden != NULL)
+			SOIL_free_image_data(golden);
+
+		for (unsigned int e = 0; e < errors.size(); ++e) {
+			cout << "FAIL " << scenario.Name << ": " << errors[e] << endl;
+		}
+
+		if (errors.empty())
+			cout << "PASS " << scenario.Name << endl;
+		else
+			failures++;
+	}
+
+	if (update)
+		cout << "Recorded " << scenarios.size() - failures << " golden images into " << RENDER_TEST_DIR << endl;
+	else
+		cout << scenarios.size() - failures << "/" << scenarios.size() << " scenarios passed" << endl;
+
+	return failures > 0 ? 1 : 0;
+}
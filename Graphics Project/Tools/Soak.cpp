@@ -0,0 +1,129 @@
+// STL Includes
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "../Game/Level.h"
+#include "../Game/GameLogic.h"
+
+
+// Soak constants
+const double SOAK_MAX_VIEW_ERROR = 1e-3;	// Largest single precision error allowed on an item position relative to the camera
+const double SOAK_MAX_COST_GROWTH = 2.0;	// Largest allowed ratio between the cost of a tick in an hour and in the first hour
+
+
+/*
+	Soak test of unbounded-length runs.
+	Simulates a single uninterrupted run of many hours at the fixed tick rate, filling a frame snapshot every tick
+	like the renderer does, and checks every tick that the run is still going, that the grid index follows the camera
+	and that the item positions relative to the camera survive the single precision matrices of the renderer.
+	Prints a line per simulated hour and fails if the precision or the cost of a tick degrades over the run.
+	The default level is an endless open tunnel so the run never ends without pressing any key.
+
+	Usage: Soak [-l level_path] [-h hours] [-v view_slices] [-s seed]
+		-l	Path of the level file (default Levels/Soak.txt)
+		-h	Number of simulated hours (default 24)
+		-v	Number of slices kept ahead of the game (default a block length)
+		-s	Seed of the game (default 0)
+*/
+int main(int argc, char** argv) {
+	string levelPath = "Levels/Soak.txt";
+	int hours = 24;
+	int viewSlices = 0;
+	unsigned int seed = 0;
+
+	// Parse arguments
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+
+		if (arg == "-l" && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (arg == "-h" && i + 1 < argc)
+			hours = atoi(argv[++i]);
+		else if (arg == "-v" && i + 1 < argc)
+			viewSlices = atoi(argv[++i]);
+		else if (arg == "-s" && i + 1 < argc)
+			seed = (unsigned int)atoll(argv[++i]);
+		else {
+			cout << "Usage: " << argv[0] << " [-l level_path] [-h hours] [-v view_slices] [-s seed]" << endl;
+			return 1;
+		}
+	}
+
+	Level level;
+	if (!level.Load(levelPath))
+		return 1;
+
+	GameLogic logic(&level, seed, viewSlices);
+	FrameSnapshot* snapshot = new FrameSnapshot();
+
+	long long ticksPerHour = 3600LL * SIMULATION_TICK_RATE;
+	double firstHourCost = 0;
+	bool failed = false;
+
+	for (int hour = 1; hour <= hours && !failed; ++hour) {
+		double maxViewError = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		for (long long t = 0; t < ticksPerHour; ++t) {
+			logic.Step(0, SIMULATION_TICK_TIME);
+			logic.FillSnapshot(*snapshot);
+
+			if (snapshot->State != RUNNING) {
+				cout << "GAME::ERROR: The run ended after " << hour - 1 << " h " << t * SIMULATION_TICK_TIME << " s" << endl;
+				failed = true;
+				break;
+			}
+
+			// The grid index must be the slice the camera is in
+			if (snapshot->GridIndexZ != (int)abs(snapshot->CameraZ / LANE_DEPTH)) {
+				cout << "GAME::ERROR: Grid index " << snapshot->GridIndexZ << " doesn't match camera position " << snapshot->CameraZ << endl;
+				failed = true;
+				break;
+			}
+
+			// Positions of the items relative to the camera once converted to single precision
+			float cameraZ = (float)snapshot->CameraZ;
+
+			for (int i = 0; i < snapshot->ItemsCount; ++i) {
+				double itemZ = -(snapshot->Items[i].Z + snapshot->GridIndexZ) * LANE_DEPTH;
+				double viewError = abs(((float)itemZ - cameraZ) - (itemZ - snapshot->CameraZ));
+				maxViewError = max(maxViewError, viewError);
+			}
+		}
+
+		if (failed)
+			break;
+
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		double tickCost = elapsed / ticksPerHour * 1e9;
+
+		if (hour == 1)
+			firstHourCost = tickCost;
+
+		cout << "Hour " << hour << ": distance " << logic.GetDistance() << " slices, score " << logic.GetScore()
+			<< ", speed " << logic.GetKinematics().GetMoveSpeed() << ", camera z " << snapshot->CameraZ
+			<< ", view error " << maxViewError << ", " << tickCost << " ns/tick" << endl;
+
+		if (maxViewError > SOAK_MAX_VIEW_ERROR) {
+			cout << "GAME::ERROR: Item positions lost precision in hour " << hour << endl;
+			failed = true;
+		}
+
+		if (tickCost > firstHourCost * SOAK_MAX_COST_GROWTH) {
+			cout << "GAME::ERROR: Tick cost grew from " << firstHourCost << " ns to " << tickCost << " ns in hour " << hour << endl;
+			failed = true;
+		}
+	}
+
+	cout << "State hash: " << hex << logic.GetStateHash() << dec << endl;
+	cout << (failed ? "Soak test failed" : "Soak test passed") << endl;
+
+	delete snapshot;
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// STL Includes
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+/*
+	Bit scanning helpers over 64-bit masks, using the compiler intrinsics
+*/
+
+/* Returns the number of set bits */
+inline int PopCount(uint64_t mask) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(mask);
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
+/* Returns the index of the lowest set bit, the mask must not be zero */
+inline int LowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+/* Returns the index of the highest set bit, or -1 if the mask is zero */
+inline int HighestBit(uint64_t mask) {
+	if (mask == 0)
+		return -1;
+
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, mask);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(mask);
+#endif
+}
@@ -0,0 +1,488 @@
+#include "FrameCapture.h"
+
+// STL Includes
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+// PNG constants
+const unsigned int PNG_STORED_BLOCK_MAX = 65535;		// Largest stored deflate block
+const unsigned int ADLER_MODULO = 65521;
+const unsigned int ADLER_BLOCK = 5552;					// Bytes summed before the sums may overflow
+
+// Nanoseconds a frame in flight is waited for at a time
+const GLuint64 CAPTURE_WAIT_TIMEOUT = 1000000000;
+
+
+/* Appends the given value in big endian order */
+static void AppendBigEndian(vector<unsigned char>& data, uint32_t value) {
+	data.push_back((unsigned char)(value >> 24));
+	data.push_back((unsigned char)(value >> 16));
+	data.push_back((unsigned char)(value >> 8));
+	data.push_back((unsigned char)value);
+}
+
+/* Returns the table of the CRC-32 of each byte */
+static vector<uint32_t> MakeCrcTable() {
+	vector<uint32_t> table(256);
+
+	for (uint32_t i = 0; i < 256; ++i) {
+		uint32_t value = i;
+
+		for (int bit = 0; bit < 8; ++bit) {
+			value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+		}
+
+		table[i] = value;
+	}
+
+	return table;
+}
+
+/* Returns the CRC-32 of the given bytes, continuing the given CRC */
+static uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+	// Built once, whichever encoder thread gets here first
+	static const vector<uint32_t> table = MakeCrcTable();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) {
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+/* Writes a PNG chunk of the given type and data */
+static void WritePngChunk(ofstream& file, const char* type, const vector<unsigned char>& data) {
+	vector<unsigned char> header;
+	AppendBigEndian(header, (uint32_t)data.size());
+	header.insert(header.end(), type, type + 4);
+
+	uint32_t crc = Crc32(&header[4], 4);
+	crc = Crc32(data.data(), data.size(), crc);
+
+	vector<unsigned char> footer;
+	AppendBigEndian(footer, crc);
+
+	file.write((const char*)header.data(), header.size());
+	file.write((const char*)data.data(), data.size());
+	file.write((const char*)footer.data(), footer.size());
+}
+
+
+/*
+	Constructs a capture of frames of the given size, written to the given path as the given format.
+	PNG frames are numbered before the extension unless a single frame is captured,
+	a video is labeled with the given frame rate, whatever the time the frames actually took
+*/
+FrameCapture::FrameCapture(const string& path, CaptureFormat format, int width, int height, int frameRate, long long maxFrames) {
+	this->mOldest = 0;
+	this->mPending = 0;
+	this->mResolve = NULL;
+	this->mWidth = width;
+	this->mHeight = height;
+	this->mMaxFrames = maxFrames;
+	this->mFramesCount = 0;
+	this->mStalls = 0;
+	this->mDropped = 0;
+
+	this->mPath = path;
+	this->mFormat = format;
+	this->mFrameRate = frameRate;
+	this->mStopping = false;
+	this->mWritten = 0;
+	this->mFailed = false;
+
+	// The pixel buffers are only read from by the CPU
+	long long bytes = (long long)width * height * 4;
+
+	for (int i = 0; i < CAPTURE_BUFFERS; ++i) {
+		glGenBuffers(1, &this->mSlots[i].Buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, this->mSlots[i].Buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+		this->mSlots[i].Fence = 0;
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	RenderStats::AddGpuMemory(GPU_MEMORY_TARGETS, CAPTURE_BUFFERS * bytes);
+
+	if (format == CAPTURE_Y4M) {
+		this->mVideo.open(path.c_str(), ios::binary);
+
+		if (!this->mVideo.is_open()) {
+			std::cout << "GAME::ERROR: Unable to write the video " << path << std::endl;
+			this->mFailed = true;
+		}
+		else {
+			this->mVideo << "YUV4MPEG2 W" << width << " H" << height << " F" << frameRate << ":1 Ip A1:1 C420jpeg\n";
+		}
+	}
+
+	this->mEncoder = thread(&FrameCapture::EncoderLoop, this);
+}
+
+/* Waits for the frames in flight to be written and destructs the capture */
+FrameCapture::~FrameCapture() {
+	this->Collect(this->mPending);
+
+	{
+		lock_guard<mutex> lock(this->mMutex);
+		this->mStopping = true;
+	}
+
+	this->mWake.notify_one();
+	this->mEncoder.join();
+
+	for (int i = 0; i < CAPTURE_BUFFERS; ++i) {
+		glDeleteBuffers(1, &this->mSlots[i].Buffer);
+	}
+
+	RenderStats::AddGpuMemory(GPU_MEMORY_TARGETS, -CAPTURE_BUFFERS * (long long)this->mWidth * this->mHeight * 4);
+	delete this->mResolve;
+
+	for (unsigned int i = 0; i < this->mFreeFrames.size(); ++i) {
+		delete this->mFreeFrames[i];
+	}
+
+	if (this->mDropped > 0 || this->mStalls > 0)
+		std::cout << "GAME::WARNING: " << this->mPath << ": " << this->mDropped << " frames dropped by a late encoder, "
+			<< this->mStalls << " frames waited for on the GPU" << std::endl;
+}
+
+/* Reads the frame just drawn into the given target, or into the window if null, and hands the frames the GPU is done with to the encoder */
+void FrameCapture::Capture(const Framebuffer* source) {
+	PROFILE_SCOPE("FrameCapture::Capture");
+
+	// With all of the buffers in flight, the oldest one has to be waited for
+	bool full = this->mPending == CAPTURE_BUFFERS;
+	this->Collect(full && this->IsCapturing() ? 1 : 0);
+
+	if (full && this->mPending < CAPTURE_BUFFERS)
+		this->mStalls++;
+
+	if (!this->IsCapturing() || this->mPending == CAPTURE_BUFFERS)
+		return;
+
+	// Multisampled pixels can't be read, they are resolved first
+	GLuint target = (source != NULL) ? source->GetID() : 0;
+
+	if (source != NULL && source->GetSamples() > 1) {
+		if (this->mResolve == NULL)
+			this->mResolve = new Framebuffer(this->mWidth, this->mHeight);
+
+		source->BlitTo(this->mResolve->GetID(), this->mWidth, this->mHeight);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, this->mResolve->GetID());
+	}
+	else {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+	}
+
+	// The copy into the buffer is queued on the GPU, the call returns at once
+	Slot& slot = this->mSlots[(this->mOldest + this->mPending) % CAPTURE_BUFFERS];
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+	glReadPixels(0, 0, this->mWidth, this->mHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target);
+	RenderStats::CountStateChanges(4);
+
+	this->mPending++;
+	this->mFramesCount++;
+}
+
+/* Returns whether frames are still to be read */
+bool FrameCapture::IsCapturing() const {
+	return this->mMaxFrames < 0 || this->mFramesCount < this->mMaxFrames;
+}
+
+/* Returns whether all the frames to read were read and written */
+bool FrameCapture::IsDone() const {
+	if (this->mFailed)
+		return true;
+
+	return !this->IsCapturing() && this->mPending == 0 && this->mWritten + this->mDropped == this->mFramesCount;
+}
+
+/* Returns the number of frames read so far */
+long long FrameCapture::GetFramesCount() const {
+	return this->mFramesCount;
+}
+
+/* Returns the number of frames not written because the encoder fell behind */
+long long FrameCapture::GetDroppedFrames() const {
+	return this->mDropped;
+}
+
+/* Returns the number of frames the GPU had to be waited for */
+long long FrameCapture::GetStalls() const {
+	return this->mStalls;
+}
+
+/* Returns the format of the given path, a video if it ends with .y4m */
+CaptureFormat FrameCapture::GetFormat(const string& path) {
+	bool video = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+	return video ? CAPTURE_Y4M : CAPTURE_PNG;
+}
+
+/* Maps the frames the GPU is done with, oldest first, and queues them for the encoder.
+   The given number of oldest frames are waited for if the GPU is not done with them yet */
+void FrameCapture::Collect(int waited) {
+	size_t bytes = (size_t)this->mWidth * this->mHeight * 4;
+
+	while (this->mPending > 0) {
+		Slot& slot = this->mSlots[this->mOldest];
+		bool wait = waited > 0;
+		GLenum status = glClientWaitSync(slot.Fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? CAPTURE_WAIT_TIMEOUT : 0);
+
+		if (status == GL_TIMEOUT_EXPIRED) {
+			if (!wait)
+				return;
+
+			continue;
+		}
+
+		glDeleteSync(slot.Fence);
+		slot.Fence = 0;
+		this->mOldest = (this->mOldest + 1) % CAPTURE_BUFFERS;
+		this->mPending--;
+		waited--;
+
+		// Rather drop the frame than wait for the encoder
+		vector<unsigned char>* frame = NULL;
+
+		if (status != GL_WAIT_FAILED) {
+			lock_guard<mutex> lock(this->mMutex);
+
+			if (this->mQueue.size() < CAPTURE_QUEUE_MAX && !this->mFailed) {
+				if (!this->mFreeFrames.empty()) {
+					frame = this->mFreeFrames.back();
+					this->mFreeFrames.pop_back();
+				}
+				else {
+					frame = new vector<unsigned char>();
+				}
+			}
+		}
+
+		if (frame == NULL) {
+			this->mDropped++;
+			continue;
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+		const unsigned char* pixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+
+		if (pixels != NULL) {
+			frame->resize(bytes);
+			memcpy(frame->data(), pixels, bytes);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		{
+			lock_guard<mutex> lock(this->mMutex);
+
+			if (pixels != NULL) {
+				this->mQueue.push_back(frame);
+			}
+			else {
+				this->mFreeFrames.push_back(frame);
+				this->mDropped++;
+			}
+		}
+
+		this->mWake.notify_one();
+	}
+}
+
+/* Writes the queued frames until the capture is destructed */
+void FrameCapture::EncoderLoop() {
+	Profiler::SetThreadName("Capture");
+
+	while (true) {
+		vector<unsigned char>* frame;
+
+		{
+			unique_lock<mutex> lock(this->mMutex);
+			this->mWake.wait(lock, [this]() { return this->mStopping || !this->mQueue.empty(); });
+
+			// The queue is drained before stopping
+			if (this->mQueue.empty())
+				return;
+
+			frame = this->mQueue.front();
+			this->mQueue.pop_front();
+		}
+
+		{
+			PROFILE_SCOPE("FrameCapture::Encode");
+
+			if (!this->mFailed && !this->WriteFrame(*frame))
+				this->mFailed = true;
+		}
+
+		lock_guard<mutex> lock(this->mMutex);
+		this->mFreeFrames.push_back(frame);
+	}
+}
+
+/* Writes the given frame, of RGBA rows from the bottom, as the next one of the capture, returns false on failure */
+bool FrameCapture::WriteFrame(const vector<unsigned char>& pixels) {
+	bool written;
+
+	if (this->mFormat == CAPTURE_Y4M) {
+		written = this->WriteY4m(pixels);
+	}
+	else if (this->mMaxFrames == 1) {
+		written = this->WritePng(pixels, this->mPath);
+	}
+	else {
+		// frame_000042.png for frame.png, so the frames sort in order
+		string base = this->mPath;
+		if (base.size() >= 4 && base.compare(base.size() - 4, 4, ".png") == 0)
+			base.resize(base.size() - 4);
+
+		char index[16];
+		snprintf(index, sizeof(index), "_%06lld", (long long)this->mWritten);
+		written = this->WritePng(pixels, base + index + ".png");
+	}
+
+	if (written)
+		this->mWritten++;
+
+	return written;
+}
+
+/* Writes the given frame as a PNG image */
+bool FrameCapture::WritePng(const vector<unsigned char>& pixels, const string& path) const {
+	ofstream file(path.c_str(), ios::binary);
+
+	if (!file.is_open()) {
+		std::cout << "GAME::ERROR: Unable to write the image " << path << std::endl;
+		return false;
+	}
+
+	// Rows from the top, each starting with its filter type (none), in RGB
+	size_t rowBytes = 1 + (size_t)this->mWidth * 3;
+	vector<unsigned char> raw(rowBytes * this->mHeight);
+
+	for (int y = 0; y < this->mHeight; ++y) {
+		const unsigned char* src = &pixels[(size_t)(this->mHeight - 1 - y) * this->mWidth * 4];
+		unsigned char* dst = &raw[y * rowBytes];
+		*dst++ = 0;
+
+		for (int x = 0; x < this->mWidth; ++x, src += 4) {
+			*dst++ = src[0];
+			*dst++ = src[1];
+			*dst++ = src[2];
+		}
+	}
+
+	// Zlib stream of stored blocks, the encoder keeps up with the frames without a compressor
+	vector<unsigned char> data;
+	data.reserve(raw.size() + raw.size() / PNG_STORED_BLOCK_MAX * 5 + 16);
+	data.push_back(0x78);
+	data.push_back(0x01);
+
+	for (size_t offset = 0; offset < raw.size(); offset += PNG_STORED_BLOCK_MAX) {
+		unsigned int size = (unsigned int)min((size_t)PNG_STORED_BLOCK_MAX, raw.size() - offset);
+		bool last = offset + size == raw.size();
+
+		data.push_back(last ? 1 : 0);
+		data.push_back((unsigned char)size);
+		data.push_back((unsigned char)(size >> 8));
+		data.push_back((unsigned char)~size);
+		data.push_back((unsigned char)(~size >> 8));
+		data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+	}
+
+	uint32_t a = 1, b = 0;
+	for (size_t offset = 0; offset < raw.size(); offset += ADLER_BLOCK) {
+		size_t end = min(raw.size(), offset + ADLER_BLOCK);
+
+		for (size_t i = offset; i < end; ++i) {
+			a += raw[i];
+			b += a;
+		}
+
+		a %= ADLER_MODULO;
+		b %= ADLER_MODULO;
+	}
+
+	AppendBigEndian(data, (b << 16) | a);
+
+	// 8 bits RGB, no interlacing
+	vector<unsigned char> header;
+	AppendBigEndian(header, (uint32_t)this->mWidth);
+	AppendBigEndian(header, (uint32_t)this->mHeight);
+	header.push_back(8);
+	header.push_back(2);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+
+	const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)signature, sizeof(signature));
+	WritePngChunk(file, "IHDR", header);
+	WritePngChunk(file, "IDAT", data);
+	WritePngChunk(file, "IEND", vector<unsigned char>());
+
+	return file.good();
+}
+
+/* Appends the given frame to the video */
+bool FrameCapture::WriteY4m(const vector<unsigned char>& pixels) {
+	int width = this->mWidth, height = this->mHeight;
+	int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+
+	vector<unsigned char> planes((size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight);
+	unsigned char* luma = planes.data();
+	unsigned char* blue = luma + (size_t)width * height;
+	unsigned char* red = blue + (size_t)chromaWidth * chromaHeight;
+
+	// BT.601 studio range, the chroma averaged over blocks of 2x2 pixels
+	for (int y = 0; y < height; ++y) {
+		const unsigned char* row = &pixels[(size_t)(height - 1 - y) * width * 4];
+
+		for (int x = 0; x < width; ++x) {
+			int r = row[4 * x], g = row[4 * x + 1], b = row[4 * x + 2];
+			luma[(size_t)y * width + x] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		}
+	}
+
+	for (int y = 0; y < chromaHeight; ++y) {
+		for (int x = 0; x < chromaWidth; ++x) {
+			int r = 0, g = 0, b = 0, count = 0;
+
+			for (int dy = 0; dy < 2 && 2 * y + dy < height; ++dy) {
+				const unsigned char* row = &pixels[(size_t)(height - 1 - (2 * y + dy)) * width * 4];
+
+				for (int dx = 0; dx < 2 && 2 * x + dx < width; ++dx) {
+					const unsigned char* pixel = row + 4 * (2 * x + dx);
+					r += pixel[0];
+					g += pixel[1];
+					b += pixel[2];
+					count++;
+				}
+			}
+
+			r /= count;
+			g /= count;
+			b /= count;
+			blue[(size_t)y * chromaWidth + x] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			red[(size_t)y * chromaWidth + x] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+
+	this->mVideo << "FRAME\n";
+	this->mVideo.write((const char*)planes.data(), planes.size());
+
+	if (!this->mVideo.good()) {
+		std::cout << "GAME::ERROR: Unable to write the video " << this->mPath << std::endl;
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+using namespace std;
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "../Components/Framebuffer.h"
+
+// Capture constants
+const int CAPTURE_BUFFERS = 3;					// Frames in flight, a frame is mapped once the GPU is done with it, up to this many frames later
+const int CAPTURE_QUEUE_MAX = 8;				// Frames waiting for the encoder, further frames are dropped rather than waited for
+const int CAPTURE_DEFAULT_FRAME_RATE = 60;		// Frame rate a video is labeled with
+
+
+/*
+	Formats the frames are written in
+*/
+enum CaptureFormat {
+	CAPTURE_PNG,			// One PNG image per frame
+	CAPTURE_Y4M				// Raw YUV 4:2:0 video
+};
+
+
+/*
+	Records the frames drawn without stalling the rendering thread.
+	Each frame is read into the next one of a ring of pixel buffers, followed by a fence,
+	and only mapped once the fence says the GPU is done with it, a few frames later.
+	The mapped pixels are copied into a queue and written on a thread of their own,
+	so neither the transfer nor the encoding is waited for while drawing.
+	Must be used from the thread owning the GL context
+*/
+class FrameCapture
+{
+private:
+	/*
+		Pixel buffer a frame is read into
+	*/
+	struct Slot {
+		GLuint Buffer;
+		GLsync Fence;
+	};
+
+	// Reading, on the rendering thread
+	Slot mSlots[CAPTURE_BUFFERS];
+	int mOldest;							// Slot read the longest ago
+	int mPending;							// Slots read and not mapped yet
+	Framebuffer* mResolve;					// Single sampled copy of a multisampled source
+	int mWidth;
+	int mHeight;
+	long long mMaxFrames;					// Frames to read, negative for no limit
+	long long mFramesCount;					// Frames read so far
+	long long mStalls;						// Frames the GPU had to be waited for, all buffers being in flight
+	long long mDropped;						// Frames not written because the encoder fell behind
+
+	// Encoding, on the encoder thread
+	string mPath;
+	CaptureFormat mFormat;
+	int mFrameRate;
+	thread mEncoder;
+	mutex mMutex;
+	condition_variable mWake;
+	deque<vector<unsigned char>*> mQueue;
+	vector<vector<unsigned char>*> mFreeFrames;
+	bool mStopping;
+	atomic<long long> mWritten;
+	ofstream mVideo;
+	atomic<bool> mFailed;					// Nothing more is written once a write failed
+
+public:
+	/*
+		Constructs a capture of frames of the given size, written to the given path as the given format.
+		PNG frames are numbered before the extension unless a single frame is captured,
+		a video is labeled with the given frame rate, whatever the time the frames actually took
+	*/
+	FrameCapture(const string& path, CaptureFormat format, int width, int height, int frameRate = CAPTURE_DEFAULT_FRAME_RATE, long long maxFrames = -1);
+
+	/* Waits for the frames in flight to be written and destructs the capture */
+	~FrameCapture();
+
+	/* Reads the frame just drawn into the given target, or into the window if null, and hands the frames the GPU is done with to the encoder */
+	void Capture(const Framebuffer* source);
+
+	/* Returns whether frames are still to be read */
+	bool IsCapturing() const;
+
+	/* Returns whether all the frames to read were read and written */
+	bool IsDone() const;
+
+	/* Returns the number of frames read so far */
+	long long GetFramesCount() const;
+
+	/* Returns the number of frames not written because the encoder fell behind */
+	long long GetDroppedFrames() const;
+
+	/* Returns the number of frames the GPU had to be waited for */
+	long long GetStalls() const;
+
+	/* Returns the format of the given path, a video if it ends with .y4m */
+	static CaptureFormat GetFormat(const string& path);
+
+private:
+	/* Maps the frames the GPU is done with, oldest first, and queues them for the encoder.
+	   The given number of oldest frames are waited for if the GPU is not done with them yet */
+	void Collect(int waited);
+
+	/* Writes the queued frames until the capture is destructed */
+	void EncoderLoop();
+
+	/* Writes the given frame, of RGBA rows from the bottom, as the next one of the capture, returns false on failure */
+	bool WriteFrame(const vector<unsigned char>& pixels);
+
+	/* Writes the given frame as a PNG image */
+	bool WritePng(const vector<unsigned char>& pixels, const string& path) const;
+
+	/* Appends the given frame to the video */
+	bool WriteY4m(const vector<unsigned char>& pixels);
+};
@@ -0,0 +1,125 @@
+#include "GpuTimer.h"
+
+/* Constructs a new GPU timer, the GL context must be current */
+GpuTimer::GpuTimer() {
+	for (int i = 0; i < GPU_TIMER_FRAMES; ++i) {
+		glGenQueries(2 * GPU_TIMER_MAX_SCOPES, this->mFrames[i].Queries);
+		this->mFrames[i].ScopesCount = 0;
+		this->mFrames[i].ClockOffset = 0;
+		this->mFrames[i].Pending = false;
+	}
+
+	this->mFramesCount = 0;
+	this->mFrame = NULL;
+	this->mDepth = 0;
+	this->mTrack = -1;
+	this->mDropped = 0;
+}
+
+/* Destructs the GPU timer and free its queries */
+GpuTimer::~GpuTimer() {
+	for (int i = 0; i < GPU_TIMER_FRAMES; ++i) {
+		glDeleteQueries(2 * GPU_TIMER_MAX_SCOPES, this->mFrames[i].Queries);
+	}
+}
+
+/* Reads back the timings of an earlier frame and starts timing a new one, does nothing while the profiler is disabled */
+void GpuTimer::BeginFrame() {
+	this->mFrame = NULL;
+
+	if (!Profiler::IsEnabled())
+		return;
+
+	if (this->mTrack < 0)
+		this->mTrack = Profiler::GetTrack("GPU");
+
+	// The frame issued GPU_TIMER_FRAMES frames ago is read before its queries are issued again
+	Frame& frame = this->mFrames[this->mFramesCount % GPU_TIMER_FRAMES];
+
+	if (frame.Pending && !this->ReadFrame(frame))
+		this->mDropped++;
+
+	// Place the GPU clock on the profiler's one, again every frame so the two can't drift apart
+	GLint64 gpuTime;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+
+	frame.ClockOffset = (int64_t)Profiler::Now() - gpuTime;
+	frame.ScopesCount = 0;
+	frame.Pending = false;
+
+	this->mFrame = &frame;
+	this->mDepth = 0;
+
+	// The whole frame is the first scope
+	this->BeginScope("GPU::Frame");
+}
+
+/* Ends timing the current frame */
+void GpuTimer::EndFrame() {
+	if (this->mFrame == NULL)
+		return;
+
+	this->EndScope(0);
+
+	this->mFrame->Pending = true;
+	this->mFrame = NULL;
+	this->mFramesCount++;
+}
+
+/* Starts timing a scope of the current frame, returns its index or -1 if it is not timed */
+int GpuTimer::BeginScope(const char* name) {
+	if (this->mFrame == NULL || this->mFrame->ScopesCount >= GPU_TIMER_MAX_SCOPES)
+		return -1;
+
+	int scope = this->mFrame->ScopesCount++;
+	this->mFrame->Names[scope] = name;
+	this->mFrame->Depths[scope] = this->mDepth++;
+
+	glQueryCounter(this->mFrame->Queries[2 * scope], GL_TIMESTAMP);
+
+	return scope;
+}
+
+/* Ends timing the given scope */
+void GpuTimer::EndScope(int scope) {
+	if (this->mFrame == NULL || scope < 0 || scope >= this->mFrame->ScopesCount)
+		return;
+
+	glQueryCounter(this->mFrame->Queries[2 * scope + 1], GL_TIMESTAMP);
+	this->mDepth = this->mFrame->Depths[scope];
+}
+
+/* Returns the number of frames whose timings were dropped because the GPU had not finished them in time */
+long long GpuTimer::GetDroppedFrames() const {
+	return this->mDropped;
+}
+
+/* Records the timings of the given frame on the profiler, returns false if the GPU is not done with it */
+bool GpuTimer::ReadFrame(Frame& frame) {
+	frame.Pending = false;
+
+	// Never wait for a result, the frame is dropped instead
+	for (int i = 0; i < 2 * frame.ScopesCount; ++i) {
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(frame.Queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available == GL_FALSE)
+			return false;
+	}
+
+	for (int i = 0; i < frame.ScopesCount; ++i) {
+		GLuint64 begin, end;
+		glGetQueryObjectui64v(frame.Queries[2 * i], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.Queries[2 * i + 1], GL_QUERY_RESULT, &end);
+
+		int64_t profilerBegin = (int64_t)begin + frame.ClockOffset;
+		int64_t profilerEnd = (int64_t)end + frame.ClockOffset;
+
+		if (profilerBegin < 0 || profilerEnd < profilerBegin)
+			continue;
+
+		Profiler::Record(this->mTrack, frame.Names[i], (uint64_t)profilerBegin, (uint64_t)profilerEnd, frame.Depths[i]);
+	}
+
+	return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+// STL Includes
+#include <cstdint>
+using namespace std;
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "Profiler.h"
+
+// GPU timer constants
+const int GPU_TIMER_FRAMES = 3;					// Frames in flight, the timings of a frame are read this many frames later
+const int GPU_TIMER_MAX_SCOPES = 16;			// Scopes timed per frame, the later ones are not timed
+
+// Records the GPU time spent by the commands issued in the enclosing scope on the given timer, the name must be a string literal
+#define PROFILE_GPU_SCOPE(timer, name) GpuScope PROFILE_CONCAT(gpuScope, __LINE__)(timer, name)
+
+
+/*
+	Times the GPU with timestamp queries around the scopes of a frame.
+	The queries of a frame are read back GPU_TIMER_FRAMES frames later, when the GPU is done with them,
+	so the rendering thread never waits on the GPU. The timings are recorded on the "GPU" track of the profiler,
+	placed on the profiler's clock, next to the CPU scopes.
+	Must be used from the thread owning the GL context
+*/
+class GpuTimer
+{
+private:
+	/*
+		Queries issued during a frame
+	*/
+	struct Frame {
+		GLuint Queries[2 * GPU_TIMER_MAX_SCOPES];	// Begin and end timestamps of each scope
+		const char* Names[GPU_TIMER_MAX_SCOPES];
+		int Depths[GPU_TIMER_MAX_SCOPES];
+		int ScopesCount;
+		int64_t ClockOffset;						// Profiler time minus GPU time when the frame began
+		bool Pending;								// Issued and not read back yet
+	};
+
+	Frame mFrames[GPU_TIMER_FRAMES];
+	long long mFramesCount;
+	Frame* mFrame;								// Frame being issued, null when not timing
+	int mDepth;
+	int mTrack;
+	long long mDropped;							// Frames whose queries were not ready in time
+
+public:
+	/* Constructs a new GPU timer, the GL context must be current */
+	GpuTimer();
+
+	/* Destructs the GPU timer and free its queries */
+	~GpuTimer();
+
+	/* Reads back the timings of an earlier frame and starts timing a new one, does nothing while the profiler is disabled */
+	void BeginFrame();
+
+	/* Ends timing the current frame */
+	void EndFrame();
+
+	/* Starts timing a scope of the current frame, returns its index or -1 if it is not timed */
+	int BeginScope(const char* name);
+
+	/* Ends timing the given scope */
+	void EndScope(int scope);
+
+	/* Returns the number of frames whose timings were dropped because the GPU had not finished them in time */
+	long long GetDroppedFrames() const;
+
+private:
+	/* Records the timings of the given frame on the profiler, returns false if the GPU is not done with it */
+	bool ReadFrame(Frame& frame);
+};
+
+
+/*
+	Times the GPU commands of the scope it lives in, see PROFILE_GPU_SCOPE
+*/
+class GpuScope
+{
+private:
+	GpuTimer* mTimer;
+	int mScope;
+
+public:
+	/* Starts timing the scope */
+	GpuScope(GpuTimer* timer, const char* name) {
+		this->mTimer = timer;
+		this->mScope = (timer != NULL) ? timer->BeginScope(name) : -1;
+	}
+
+	/* Ends timing the scope */
+	~GpuScope() {
+		if (this->mScope >= 0)
+			this->mTimer->EndScope(this->mScope);
+	}
+};
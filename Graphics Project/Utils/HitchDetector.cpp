@@ -0,0 +1,105 @@
+#include "HitchDetector.h"
+
+/* Constructs a detector of the given task, whose traces are written to path_prefix + name + "_" + index + ".json" */
+HitchDetector::HitchDetector(const string& name, double factor, double minTime, const string& pathPrefix) {
+	this->mName = name;
+	this->mFactor = factor;
+	this->mMinTime = minTime;
+	this->mPathPrefix = pathPrefix;
+
+	this->mSamplesCount = 0;
+	this->mMedian = 0;
+
+	this->mWriting = false;
+	this->mHitchesCount = 0;
+	this->mSkippedCount = 0;
+}
+
+/* Waits for the trace being written and destructs the detector */
+HitchDetector::~HitchDetector() {
+	if (this->mWriter.joinable())
+		this->mWriter.join();
+
+	if (this->mSkippedCount > 0)
+		std::cout << "GAME::WARNING: " << this->mSkippedCount << " " << this->mName << " hitches were not written, they came while the previous one was written" << std::endl;
+}
+
+/* Adds the time taken by a sample of the task, in seconds, returns whether it is a hitch */
+bool HitchDetector::AddSample(double time) {
+	int count = (int)min(this->mSamplesCount, (long long)HITCH_WINDOW);
+
+	// Median of the samples before this one
+	double sorted[HITCH_WINDOW];
+	copy(this->mSamples, this->mSamples + count, sorted);
+	nth_element(sorted, sorted + count / 2, sorted + count);
+	this->mMedian = (count > 0) ? sorted[count / 2] : 0.0;
+
+	this->mSamples[this->mSamplesCount++ % HITCH_WINDOW] = time;
+
+	// Wait for a full window so the first frames, slower while everything warms up, are not hitches
+	bool hitch = count == HITCH_WINDOW && time > this->mMinTime && time > this->mFactor * this->mMedian;
+
+	if (hitch)
+		this->mHitchesCount++;
+
+	return hitch;
+}
+
+/* Returns the median of the samples before the last one, in seconds */
+double HitchDetector::GetMedian() const {
+	return this->mMedian;
+}
+
+/* Writes the trace of the last hitch, of the given time in seconds, with the given state in the background */
+void HitchDetector::Dump(double time, const vector<pair<string, string>>& state) {
+	if (this->mWriting) {
+		this->mSkippedCount++;
+		return;
+	}
+
+	if (this->mWriter.joinable())
+		this->mWriter.join();
+
+	// Copy what is needed now, the profiler keeps recording while the trace is written
+	ProfileCapture* capture = new ProfileCapture();
+	Profiler::CaptureRecent(HITCH_DUMP_FRAMES, *capture);
+
+	// Span of the hitch on a track of its own
+	uint64_t now = Profiler::Now();
+	ProfileEvent event;
+	event.Name = "Hitch";
+	event.Begin = now - min(now, (uint64_t)(time * 1e9));
+	event.End = now;
+	event.Depth = 0;
+
+	capture->Tracks.push_back(this->mName + " hitches");
+	capture->Events.push_back(event);
+	capture->EventTracks.push_back((int)capture->Tracks.size() - 1);
+
+	vector<pair<string, string>>* metadata = new vector<pair<string, string>>();
+	metadata->push_back(make_pair(string("hitch"), this->mName));
+	metadata->push_back(make_pair(string("time_ms"), to_string(time * 1e3)));
+	metadata->push_back(make_pair(string("median_ms"), to_string(this->mMedian * 1e3)));
+	metadata->push_back(make_pair(string("factor"), to_string(this->mFactor)));
+	metadata->insert(metadata->end(), state.begin(), state.end());
+
+	string path = this->mPathPrefix + this->mName + "_" + to_string(this->mHitchesCount) + ".json";
+	double median = this->mMedian;
+
+	this->mWriting = true;
+	this->mWriter = thread([this, capture, metadata, path, time, median]() {
+		if (Profiler::WriteTrace(path, *capture, *metadata)) {
+			std::cout << "GAME::WARNING: " << this->mName << " of " << time * 1e3 << " ms, " << time / median
+				<< " times the median, profile written to " << path << std::endl;
+		}
+
+		delete capture;
+		delete metadata;
+		this->mWriting = false;
+	});
+}
+
+/* Returns the number of hitches detected so far */
+int HitchDetector::GetHitchesCount() const {
+	return this->mHitchesCount;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+// Other includes
+#include "Profiler.h"
+
+// Hitch detector constants
+const int HITCH_WINDOW = 120;				// Samples the rolling median is taken over
+const int HITCH_DUMP_FRAMES = 120;			// Profiled frames written before a hitch
+const double HITCH_DEFAULT_FACTOR = 3.0;	// Multiple of the median a sample must exceed to be a hitch
+
+
+/*
+	Watchdog flagging the samples of a periodic task, such as the frames or the simulation ticks,
+	that take longer than a multiple of the rolling median of the last ones.
+	A hitch is written in the background into a Chrome trace of the profiled frames before it,
+	along with the state given by the caller, so rare stutters can be looked into after the fact.
+	The profiler must be enabled for the trace to hold events
+*/
+class HitchDetector
+{
+private:
+	string mName;
+	double mFactor;
+	double mMinTime;				// Samples below this time are never hitches
+	string mPathPrefix;
+
+	// Last samples in seconds
+	double mSamples[HITCH_WINDOW];
+	long long mSamplesCount;
+	double mMedian;
+
+	// Trace writing
+	thread mWriter;
+	atomic<bool> mWriting;
+	int mHitchesCount;
+	int mSkippedCount;				// Hitches not written because the previous one was still being written
+
+public:
+	/* Constructs a detector of the given task, whose traces are written to path_prefix + name + "_" + index + ".json" */
+	HitchDetector(const string& name, double factor, double minTime, const string& pathPrefix);
+
+	/* Waits for the trace being written and destructs the detector */
+	~HitchDetector();
+
+	/* Adds the time taken by a sample of the task, in seconds, returns whether it is a hitch */
+	bool AddSample(double time);
+
+	/* Returns the median of the samples before the last one, in seconds */
+	double GetMedian() const;
+
+	/* Writes the trace of the last hitch, of the given time in seconds, with the given state in the background */
+	void Dump(double time, const vector<pair<string, string>>& state);
+
+	/* Returns the number of hitches detected so far */
+	int GetHitchesCount() const;
+};
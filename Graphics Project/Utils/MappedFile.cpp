@@ -0,0 +1,113 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Constructs a closed file view */
+MappedFile::MappedFile() {
+	this->mData = NULL;
+	this->mSize = 0;
+
+#ifdef _WIN32
+	this->mFile = INVALID_HANDLE_VALUE;
+	this->mMapping = NULL;
+#else
+	this->mFile = -1;
+#endif
+}
+
+/* Unmaps the file */
+MappedFile::~MappedFile() {
+	this->Close();
+}
+
+/* Maps the whole file at the given path, returns false on failure */
+bool MappedFile::Open(const string& path) {
+	this->Close();
+
+#ifdef _WIN32
+	this->mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (this->mFile == INVALID_HANDLE_VALUE) {
+		std::cout << "GAME::ERROR: Could not open file " << path << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(this->mFile, &size);
+	this->mSize = (size_t)size.QuadPart;
+
+	if (this->mSize > 0) {
+		this->mMapping = CreateFileMappingA(this->mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		this->mData = (this->mMapping != NULL) ? (const unsigned char*)MapViewOfFile(this->mMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	}
+#else
+	this->mFile = open(path.c_str(), O_RDONLY);
+	if (this->mFile < 0) {
+		std::cout << "GAME::ERROR: Could not open file " << path << std::endl;
+		return false;
+	}
+
+	struct stat info;
+	fstat(this->mFile, &info);
+	this->mSize = (size_t)info.st_size;
+
+	if (this->mSize > 0) {
+		void* data = mmap(NULL, this->mSize, PROT_READ, MAP_SHARED, this->mFile, 0);
+		this->mData = (data != MAP_FAILED) ? (const unsigned char*)data : NULL;
+	}
+#endif
+
+	if (this->mData == NULL) {
+		std::cout << "GAME::ERROR: Could not map file " << path << std::endl;
+		this->Close();
+		return false;
+	}
+
+	return true;
+}
+
+/* Unmaps the file */
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (this->mData != NULL)
+		UnmapViewOfFile(this->mData);
+	if (this->mMapping != NULL)
+		CloseHandle(this->mMapping);
+	if (this->mFile != INVALID_HANDLE_VALUE)
+		CloseHandle(this->mFile);
+
+	this->mFile = INVALID_HANDLE_VALUE;
+	this->mMapping = NULL;
+#else
+	if (this->mData != NULL)
+		munmap((void*)this->mData, this->mSize);
+	if (this->mFile >= 0)
+		close(this->mFile);
+
+	this->mFile = -1;
+#endif
+
+	this->mData = NULL;
+	this->mSize = 0;
+}
+
+/* Returns whether a file is mapped */
+bool MappedFile::IsOpen() const {
+	return this->mData != NULL;
+}
+
+/* Returns the mapped bytes */
+const unsigned char* MappedFile::GetData() const {
+	return this->mData;
+}
+
+/* Returns the number of mapped bytes */
+size_t MappedFile::GetSize() const {
+	return this->mSize;
+}
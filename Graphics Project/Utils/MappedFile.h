@@ -0,0 +1,52 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <string>
+#include <cstddef>
+using namespace std;
+
+
+/*
+	Read only view of a whole file mapped into memory.
+	The pages are loaded by the system on first access and shared between the processes mapping the same file
+*/
+class MappedFile
+{
+private:
+	const unsigned char* mData;
+	size_t mSize;
+
+#ifdef _WIN32
+	void* mFile;
+	void* mMapping;
+#else
+	int mFile;
+#endif
+
+public:
+	/* Constructs a closed file view */
+	MappedFile();
+
+	/* Unmaps the file */
+	~MappedFile();
+
+	/* Maps the whole file at the given path, returns false on failure */
+	bool Open(const string& path);
+
+	/* Unmaps the file */
+	void Close();
+
+	/* Returns whether a file is mapped */
+	bool IsOpen() const;
+
+	/* Returns the mapped bytes */
+	const unsigned char* GetData() const;
+
+	/* Returns the number of mapped bytes */
+	size_t GetSize() const;
+
+private:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
@@ -0,0 +1,85 @@
+#include "OffscreenContext.h"
+
+// GL Includes
+#include <GL/glew.h>
+
+/* Constructs an offscreen context, not created yet */
+OffscreenContext::OffscreenContext() {
+#ifdef __linux__
+	this->mDisplay = EGL_NO_DISPLAY;
+	this->mContext = EGL_NO_CONTEXT;
+#endif
+}
+
+/* Destroys the context */
+OffscreenContext::~OffscreenContext() {
+#ifdef __linux__
+	if (this->mDisplay == EGL_NO_DISPLAY)
+		return;
+
+	eglMakeCurrent(this->mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+	if (this->mContext != EGL_NO_CONTEXT)
+		eglDestroyContext(this->mDisplay, this->mContext);
+
+	eglTerminate(this->mDisplay);
+#endif
+}
+
+/* Creates the context and makes it current, returns false on failure */
+bool OffscreenContext::Create() {
+#ifdef __linux__
+	// The surfaceless platform needs no display server
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (getPlatformDisplay != NULL)
+		this->mDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+	if (this->mDisplay == EGL_NO_DISPLAY)
+		this->mDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+
+	if (this->mDisplay == EGL_NO_DISPLAY || !eglInitialize(this->mDisplay, &major, &minor)) {
+		std::cout << "GAME::ERROR: Unable to initialize an EGL display" << std::endl;
+		this->mDisplay = EGL_NO_DISPLAY;
+		return false;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		std::cout << "GAME::ERROR: EGL has no desktop OpenGL" << std::endl;
+		return false;
+	}
+
+	// Same version and profile as the game window, without any config since there is no surface
+	const EGLint attributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	this->mContext = eglCreateContext(this->mDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+
+	if (this->mContext == EGL_NO_CONTEXT || !eglMakeCurrent(this->mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, this->mContext)) {
+		std::cout << "GAME::ERROR: Unable to create a surfaceless OpenGL 3.3 context (EGL error 0x" << hex << eglGetError() << dec << ")" << std::endl;
+		return false;
+	}
+
+	return true;
+#else
+	std::cout << "GAME::ERROR: Offscreen contexts need EGL" << std::endl;
+	return false;
+#endif
+}
+
+/* Returns the name and version of the device rendering the current context */
+string OffscreenContext::GetRenderer() {
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	const GLubyte* version = glGetString(GL_VERSION);
+
+	if (renderer == NULL || version == NULL)
+		return "";
+
+	return string((const char*)renderer) + " (" + (const char*)version + ")";
+}
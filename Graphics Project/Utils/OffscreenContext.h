@@ -0,0 +1,40 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <string>
+using namespace std;
+
+// EGL Includes, offscreen contexts are only supported where EGL is
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+
+/*
+	OpenGL 3.3 core context without any window or surface, made current on the calling thread.
+	Created on a surfaceless EGL display, so it runs on headless machines with a software rasterizer such as llvmpipe.
+	Nothing can be presented, the frames are drawn into framebuffer objects
+*/
+class OffscreenContext
+{
+private:
+#ifdef __linux__
+	EGLDisplay mDisplay;
+	EGLContext mContext;
+#endif
+
+public:
+	/* Constructs an offscreen context, not created yet */
+	OffscreenContext();
+
+	/* Destroys the context */
+	~OffscreenContext();
+
+	/* Creates the context and makes it current, returns false on failure */
+	bool Create();
+
+	/* Returns the name and version of the device rendering the current context */
+	static string GetRenderer();
+};
@@ -0,0 +1,463 @@
+#include "Profiler.h"
+
+// Profiler state
+atomic<bool> Profiler::sEnabled(false);
+chrono::steady_clock::time_point Profiler::sStart = chrono::steady_clock::now();
+thread_local Profiler::EventRing* Profiler::sThreadRing = NULL;
+Profiler::EventRing* Profiler::sRings[PROFILER_MAX_THREADS] = {};
+atomic<int> Profiler::sRingsCount(0);
+mutex Profiler::sRingsMutex;
+unordered_map<const char*, int> Profiler::sScopesByName;
+vector<string> Profiler::sScopeNames;
+vector<int> Profiler::sScopeDepths;
+vector<vector<float>> Profiler::sScopeTimes;
+vector<vector<unsigned short>> Profiler::sScopeCalls;
+vector<float> Profiler::sFrameTimes(PROFILER_STAT_FRAMES, 0.0f);
+long long Profiler::sFramesCount = 0;
+uint64_t Profiler::sLastFrameEnd = 0;
+vector<uint64_t> Profiler::sFrameEnds(PROFILER_STAT_FRAMES, 0);
+bool Profiler::sTraceKept = true;
+vector<ProfileEvent> Profiler::sTraceEvents;
+vector<int> Profiler::sTraceRings;
+vector<ProfileEvent> Profiler::sRecentEvents;
+vector<int> Profiler::sRecentRings;
+long long Profiler::sRecentCount = 0;
+mutex Profiler::sFramesMutex;
+
+/* Writes the given string as a JSON string */
+static void WriteJsonString(ostream& out, const string& value) {
+	out << '"';
+
+	for (size_t i = 0; i < value.size(); ++i) {
+		char c = value[i];
+
+		if (c == '"' || c == '\\')
+			out << '\\' << c;
+		else if ((unsigned char)c < 0x20)
+			out << ' ';
+		else
+			out << c;
+	}
+
+	out << '"';
+}
+
+/* Returns the value of the given sorted values at the given fraction of them */
+static double Percentile(const vector<float>& sorted, double fraction) {
+	return sorted.empty() ? 0.0 : sorted[(size_t)(fraction * (sorted.size() - 1) + 0.5)];
+}
+
+/* Starts or stops recording the scopes */
+void Profiler::SetEnabled(bool enabled) {
+	lock_guard<mutex> lock(sFramesMutex);
+
+	// Frames start over from here
+	if (enabled && !sEnabled)
+		sLastFrameEnd = Now();
+
+	sEnabled = enabled;
+}
+
+/* Returns the current time in nanoseconds since the profiler started */
+uint64_t Profiler::Now() {
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - sStart).count();
+}
+
+/* Names the calling thread in the reports and the trace */
+void Profiler::SetThreadName(const string& name) {
+	EventRing* ring = GetThreadRing();
+
+	if (ring != NULL) {
+		lock_guard<mutex> lock(sRingsMutex);
+		ring->Name = name;
+	}
+}
+
+/* Returns the track of the given name for timings recorded on behalf of another source, creating it the first time */
+int Profiler::GetTrack(const string& name) {
+	{
+		lock_guard<mutex> lock(sRingsMutex);
+
+		for (int i = 0; i < sRingsCount; ++i) {
+			if (sRings[i]->Name == name)
+				return i;
+		}
+	}
+
+	EventRing* ring = CreateRing(name);
+
+	for (int i = 0; ring != NULL && i < sRingsCount; ++i) {
+		if (sRings[i] == ring)
+			return i;
+	}
+
+	return -1;
+}
+
+/* Records a timed event on the given track, from the thread owning that track */
+void Profiler::Record(int track, const char* name, uint64_t begin, uint64_t end, int depth) {
+	if (track < 0 || track >= sRingsCount.load(memory_order_acquire))
+		return;
+
+	EventRing* ring = sRings[track];
+	uint64_t head = ring->Head.load(memory_order_relaxed);
+
+	ProfileEvent& event = ring->Events[head % PROFILER_RING_EVENTS];
+	event.Name = name;
+	event.Begin = begin;
+	event.End = end;
+	event.Depth = depth;
+
+	ring->Head.store(head + 1, memory_order_release);
+}
+
+/* Opens a scope of the calling thread, returns its nesting depth */
+int Profiler::BeginScope() {
+	EventRing* ring = GetThreadRing();
+	return (ring != NULL) ? ring->Depth++ : 0;
+}
+
+/* Closes a scope of the calling thread and records it */
+void Profiler::EndScope(const char* name, uint64_t begin, int depth) {
+	uint64_t end = Now();
+	EventRing* ring = GetThreadRing();
+
+	if (ring == NULL)
+		return;
+
+	ring->Depth = depth;
+
+	uint64_t head = ring->Head.load(memory_order_relaxed);
+
+	ProfileEvent& event = ring->Events[head % PROFILER_RING_EVENTS];
+	event.Name = name;
+	event.Begin = begin;
+	event.End = end;
+	event.Depth = depth;
+
+	ring->Head.store(head + 1, memory_order_release);
+}
+
+/* Ends the current frame, collecting the events recorded by every thread since the previous one */
+void Profiler::EndFrame() {
+	if (!IsEnabled())
+		return;
+
+	lock_guard<mutex> lock(sFramesMutex);
+
+	uint64_t frameEnd = Now();
+	int frame = (int)(sFramesCount % PROFILER_STAT_FRAMES);
+
+	for (size_t s = 0; s < sScopeTimes.size(); ++s) {
+		sScopeTimes[s][frame] = 0.0f;
+		sScopeCalls[s][frame] = 0;
+	}
+
+	int ringsCount = sRingsCount.load(memory_order_acquire);
+
+	if (sRecentEvents.empty()) {
+		sRecentEvents.resize(PROFILER_RECENT_EVENTS);
+		sRecentRings.resize(PROFILER_RECENT_EVENTS);
+	}
+
+	for (int r = 0; r < ringsCount; ++r) {
+		EventRing* ring = sRings[r];
+		uint64_t head = ring->Head.load(memory_order_acquire);
+
+		// The owner wrapped around the ring since the last frame
+		if (head - ring->Tail > PROFILER_RING_EVENTS) {
+			ring->Lost += head - ring->Tail - PROFILER_RING_EVENTS;
+			ring->Tail = head - PROFILER_RING_EVENTS;
+		}
+
+		for (; ring->Tail < head; ++ring->Tail) {
+			ProfileEvent event = ring->Events[ring->Tail % PROFILER_RING_EVENTS];
+
+			// The owner may have written over the event while it was copied
+			if (ring->Head.load(memory_order_acquire) - ring->Tail > PROFILER_RING_EVENTS) {
+				ring->Lost++;
+				continue;
+			}
+
+			int scope = GetScope(event.Name, event.Depth);
+			sScopeTimes[scope][frame] += (float)((event.End - event.Begin) * 1e-6);
+			sScopeCalls[scope][frame]++;
+
+			if (sTraceKept && sTraceEvents.size() < PROFILER_MAX_TRACE_EVENTS) {
+				sTraceEvents.push_back(event);
+				sTraceRings.push_back(r);
+			}
+
+			int recent = (int)(sRecentCount++ % PROFILER_RECENT_EVENTS);
+			sRecentEvents[recent] = event;
+			sRecentRings[recent] = r;
+		}
+	}
+
+	sFrameEnds[frame] = frameEnd;
+	sFrameTimes[frame] = (float)((frameEnd - sLastFrameEnd) * 1e-6);
+	sLastFrameEnd = frameEnd;
+	sFramesCount++;
+}
+
+/* Returns the number of frames ended so far */
+long long Profiler::GetFramesCount() {
+	lock_guard<mutex> lock(sFramesMutex);
+	return sFramesCount;
+}
+
+/* Returns the time of every scope in the last ended frame, in milliseconds */
+void Profiler::GetLastFrame(vector<pair<string, float>>& times) {
+	lock_guard<mutex> lock(sFramesMutex);
+	times.clear();
+
+	if (sFramesCount == 0)
+		return;
+
+	int frame = (int)((sFramesCount - 1) % PROFILER_STAT_FRAMES);
+	times.push_back(make_pair(string("Frame"), sFrameTimes[frame]));
+
+	for (size_t s = 0; s < sScopeNames.size(); ++s) {
+		times.push_back(make_pair(sScopeNames[s], sScopeTimes[s][frame]));
+	}
+}
+
+/* Returns the statistics of the frame and of every scope over the last frames */
+void Profiler::GetStats(vector<ProfileStats>& stats) {
+	lock_guard<mutex> lock(sFramesMutex);
+	stats.clear();
+
+	int framesCount = (int)min(sFramesCount, (long long)PROFILER_STAT_FRAMES);
+
+	for (int s = -1; s < (int)sScopeNames.size(); ++s) {
+		const vector<float>& times = (s < 0) ? sFrameTimes : sScopeTimes[s];
+		vector<float> sorted(times.begin(), times.begin() + framesCount);
+		sort(sorted.begin(), sorted.end());
+
+		ProfileStats stat;
+		stat.Name = (s < 0) ? "Frame" : sScopeNames[s];
+		stat.Depth = (s < 0) ? -1 : sScopeDepths[s];
+		stat.Calls = 0;
+		stat.Mean = 0;
+
+		for (int f = 0; f < framesCount; ++f) {
+			stat.Calls += (s < 0) ? 1 : sScopeCalls[s][f];
+			stat.Mean += sorted[f];
+		}
+
+		if (framesCount > 0) {
+			stat.Calls /= framesCount;
+			stat.Mean /= framesCount;
+		}
+
+		stat.P50 = Percentile(sorted, 0.50);
+		stat.P95 = Percentile(sorted, 0.95);
+		stat.P99 = Percentile(sorted, 0.99);
+		stat.Max = sorted.empty() ? 0.0 : sorted.back();
+		stats.push_back(stat);
+	}
+}
+
+/* Prints the statistics of the frame and of every scope over the last frames */
+void Profiler::WriteReport(ostream& out) {
+	vector<ProfileStats> stats;
+	GetStats(stats);
+
+	out << "Profile of the last " << min(GetFramesCount(), (long long)PROFILER_STAT_FRAMES) << " frames, milliseconds per frame" << endl;
+	out << "  Scope                              Calls     Mean      p50      p95      p99      Max" << endl;
+
+	for (size_t i = 0; i < stats.size(); ++i) {
+		const ProfileStats& stat = stats[i];
+		string name = string(2 * (stat.Depth + 1), ' ') + stat.Name;
+		char line[256];
+
+		snprintf(line, sizeof(line), "  %-32s %7.1f %8.3f %8.3f %8.3f %8.3f %8.3f",
+			name.c_str(), stat.Calls, stat.Mean, stat.P50, stat.P95, stat.P99, stat.Max);
+		out << line << endl;
+	}
+
+	lock_guard<mutex> lock(sRingsMutex);
+
+	for (int r = 0; r < sRingsCount; ++r) {
+		if (sRings[r]->Lost > 0)
+			out << "  " << sRings[r]->Lost << " events of " << sRings[r]->Name << " were lost, end frames more often" << endl;
+	}
+}
+
+/* Keeps every event for the trace export, or only the recent ones for the captures (kept by default) */
+void Profiler::SetTraceKept(bool kept) {
+	lock_guard<mutex> lock(sFramesMutex);
+	sTraceKept = kept;
+}
+
+/* Copies the events of the given number of last frames, and those recorded since the last frame ended */
+void Profiler::CaptureRecent(int frames, ProfileCapture& capture) {
+	capture.Tracks.clear();
+	capture.Events.clear();
+	capture.EventTracks.clear();
+
+	{
+		lock_guard<mutex> lock(sRingsMutex);
+
+		for (int r = 0; r < sRingsCount; ++r) {
+			capture.Tracks.push_back(sRings[r]->Name);
+		}
+	}
+
+	lock_guard<mutex> lock(sFramesMutex);
+	frames = (int)min((long long)frames, min(sFramesCount, (long long)PROFILER_STAT_FRAMES - 1));
+
+	// Events ending after the end of the frame before the first one captured
+	uint64_t since = 0;
+
+	if (frames < sFramesCount)
+		since = sFrameEnds[(sFramesCount - frames - 1) % PROFILER_STAT_FRAMES];
+
+	long long first = max(0LL, sRecentCount - PROFILER_RECENT_EVENTS);
+
+	for (long long i = first; i < sRecentCount; ++i) {
+		const ProfileEvent& event = sRecentEvents[i % PROFILER_RECENT_EVENTS];
+
+		if (event.End > since) {
+			capture.Events.push_back(event);
+			capture.EventTracks.push_back(sRecentRings[i % PROFILER_RECENT_EVENTS]);
+		}
+	}
+
+	// Events not drained yet, such as the ones of a simulation tick that just ended, are read without draining them
+	for (int r = 0; r < (int)capture.Tracks.size(); ++r) {
+		EventRing* ring = sRings[r];
+		uint64_t head = ring->Head.load(memory_order_acquire);
+		uint64_t tail = max(ring->Tail, head - min(head, (uint64_t)PROFILER_RING_EVENTS));
+
+		for (uint64_t i = tail; i < head; ++i) {
+			ProfileEvent event = ring->Events[i % PROFILER_RING_EVENTS];
+
+			// The owner may have written over the event while it was copied
+			if (ring->Head.load(memory_order_acquire) - i > PROFILER_RING_EVENTS)
+				continue;
+
+			if (event.End > since) {
+				capture.Events.push_back(event);
+				capture.EventTracks.push_back(r);
+			}
+		}
+	}
+}
+
+/* Writes every collected event into the given file in the Chrome trace event format, returns false on failure */
+bool Profiler::WriteTrace(const string& path) {
+	ProfileCapture capture;
+
+	{
+		lock_guard<mutex> framesLock(sFramesMutex);
+		lock_guard<mutex> ringsLock(sRingsMutex);
+
+		for (int r = 0; r < sRingsCount; ++r) {
+			capture.Tracks.push_back(sRings[r]->Name);
+		}
+
+		capture.Events = sTraceEvents;
+		capture.EventTracks = sTraceRings;
+	}
+
+	return WriteTrace(path, capture, vector<pair<string, string>>());
+}
+
+/* Writes the given events and metadata into the given file in the Chrome trace event format, returns false on failure */
+bool Profiler::WriteTrace(const string& path, const ProfileCapture& capture, const vector<pair<string, string>>& metadata) {
+	ofstream fout(path.c_str());
+
+	if (!fout.is_open()) {
+		std::cout << "GAME::ERROR: Unable to write profile trace " << path << std::endl;
+		return false;
+	}
+
+	fout << "{\"traceEvents\":[" << endl;
+
+	// Names of the threads and tracks
+	for (size_t r = 0; r < capture.Tracks.size(); ++r) {
+		fout << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r << ",\"args\":{\"name\":";
+		WriteJsonString(fout, capture.Tracks[r]);
+		fout << "}}" << (r + 1 < capture.Tracks.size() || !capture.Events.empty() ? "," : "") << endl;
+	}
+
+	// Complete events in microseconds
+	fout.setf(ios::fixed);
+	fout.precision(3);
+
+	for (size_t i = 0; i < capture.Events.size(); ++i) {
+		const ProfileEvent& event = capture.Events[i];
+		fout << "{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << capture.EventTracks[i]
+			<< ",\"ts\":" << event.Begin * 1e-3 << ",\"dur\":" << (event.End - event.Begin) * 1e-3 << "}"
+			<< (i + 1 < capture.Events.size() ? "," : "") << endl;
+	}
+
+	fout << "],\"displayTimeUnit\":\"ms\"";
+
+	// Free form values shown with the trace
+	if (!metadata.empty()) {
+		fout << ",\"otherData\":{";
+
+		for (size_t i = 0; i < metadata.size(); ++i) {
+			WriteJsonString(fout, metadata[i].first);
+			fout << ":";
+			WriteJsonString(fout, metadata[i].second);
+			fout << (i + 1 < metadata.size() ? "," : "");
+		}
+
+		fout << "}";
+	}
+
+	fout << "}" << endl;
+	return true;
+}
+
+/* Returns the ring of the calling thread, creating it the first time */
+Profiler::EventRing* Profiler::GetThreadRing() {
+	if (sThreadRing == NULL)
+		sThreadRing = CreateRing("Thread " + to_string(sRingsCount.load()));
+
+	return sThreadRing;
+}
+
+/* Creates a new ring of the given name, or returns null if there are too many */
+Profiler::EventRing* Profiler::CreateRing(const string& name) {
+	lock_guard<mutex> lock(sRingsMutex);
+
+	if (sRingsCount >= PROFILER_MAX_THREADS)
+		return NULL;
+
+	EventRing* ring = new EventRing();
+	ring->Name = name;
+	ring->Head = 0;
+	ring->Tail = 0;
+	ring->Lost = 0;
+	ring->Depth = 0;
+
+	// Published once filled, the rings are read without the lock
+	sRings[sRingsCount] = ring;
+	sRingsCount.store(sRingsCount + 1, memory_order_release);
+	return ring;
+}
+
+/* Returns the index of the scope of the given name, adding it the first time */
+int Profiler::GetScope(const char* name, int depth) {
+	unordered_map<const char*, int>::iterator it = sScopesByName.find(name);
+
+	if (it != sScopesByName.end())
+		return it->second;
+
+	// The same name may be another literal in another file
+	int scope = (int)(find(sScopeNames.begin(), sScopeNames.end(), string(name)) - sScopeNames.begin());
+
+	if (scope == (int)sScopeNames.size()) {
+		sScopeNames.push_back(name);
+		sScopeDepths.push_back(depth);
+		sScopeTimes.push_back(vector<float>(PROFILER_STAT_FRAMES, 0.0f));
+		sScopeCalls.push_back(vector<unsigned short>(PROFILER_STAT_FRAMES, 0));
+	}
+
+	sScopesByName[name] = scope;
+	return scope;
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+// STL Includes
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+using namespace std;
+
+
+// Profiler constants
+const int PROFILER_RING_EVENTS = 1 << 14;			// Events a thread can record between two frames before the oldest are lost
+const int PROFILER_MAX_THREADS = 64;				// Threads and tracks that can record events
+const int PROFILER_STAT_FRAMES = 1024;				// Frames the statistics are computed over
+const int PROFILER_MAX_TRACE_EVENTS = 1 << 20;		// Events kept for the trace export, the later ones are dropped
+const int PROFILER_RECENT_EVENTS = 1 << 16;			// Last events kept for the captures of the recent frames
+
+// Records the time spent in the enclosing scope under the given name, which must be a string literal
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+
+
+/*
+	A timed scope recorded by a thread, in nanoseconds since the profiler started
+*/
+struct ProfileEvent {
+	const char* Name;
+	uint64_t Begin;
+	uint64_t End;
+	int Depth;						// Number of scopes of the thread the event is nested in
+};
+
+
+/*
+	Statistics of a named scope over the last PROFILER_STAT_FRAMES frames, the time of a frame is the sum of its calls
+*/
+struct ProfileStats {
+	string Name;
+	int Depth;						// Nesting of the scope's first call, to indent the report
+	double Calls;					// Calls per frame
+	double Mean;					// Milliseconds per frame
+	double P50;
+	double P95;
+	double P99;
+	double Max;
+};
+
+
+/*
+	Events of a span of time copied out of the profiler, to be written without holding it
+*/
+struct ProfileCapture {
+	vector<string> Tracks;			// Names of the threads and tracks
+	vector<ProfileEvent> Events;
+	vector<int> EventTracks;		// Track of each event
+};
+
+
+/*
+	Built-in frame profiler.
+	Scopes are timed by PROFILE_SCOPE and recorded into a ring owned by the recording thread, written by that thread only
+	and drained by EndFrame, so recording takes no lock. Each frame sums the scopes that ended since the previous frame,
+	giving a breakdown per frame, percentiles over the last frames and a Chrome trace of every event (chrome://tracing).
+	Other sources of timings, such as the GPU, record into tracks of their own with Record.
+	Recording costs a single relaxed load while the profiler is disabled
+*/
+class Profiler
+{
+private:
+	/*
+		Ring of the events of a thread or a track, the head is only moved by its owner
+	*/
+	struct EventRing {
+		string Name;
+		ProfileEvent Events[PROFILER_RING_EVENTS];
+		atomic<uint64_t> Head;
+		uint64_t Tail;				// Moved by the thread draining the rings only
+		uint64_t Lost;
+		int Depth;					// Scopes open on the owner thread
+	};
+
+	static atomic<bool> sEnabled;
+	static chrono::steady_clock::time_point sStart;
+
+	// Rings of the threads and the tracks
+	static thread_local EventRing* sThreadRing;
+	static EventRing* sRings[PROFILER_MAX_THREADS];
+	static atomic<int> sRingsCount;
+	static mutex sRingsMutex;
+
+	// Frames drained so far
+	static unordered_map<const char*, int> sScopesByName;
+	static vector<string> sScopeNames;
+	static vector<int> sScopeDepths;
+	static vector<vector<float>> sScopeTimes;		// [scope][frame % PROFILER_STAT_FRAMES] in milliseconds
+	static vector<vector<unsigned short>> sScopeCalls;
+	static vector<float> sFrameTimes;
+	static long long sFramesCount;
+	static uint64_t sLastFrameEnd;
+	static vector<uint64_t> sFrameEnds;
+	static bool sTraceKept;
+	static vector<ProfileEvent> sTraceEvents;
+	static vector<int> sTraceRings;
+	static vector<ProfileEvent> sRecentEvents;				// [event % PROFILER_RECENT_EVENTS]
+	static vector<int> sRecentRings;
+	static long long sRecentCount;
+	static mutex sFramesMutex;
+
+public:
+	/* Starts or stops recording the scopes */
+	static void SetEnabled(bool enabled);
+
+	/* Returns whether the scopes are recorded */
+	static bool IsEnabled() {
+		return sEnabled.load(memory_order_relaxed);
+	}
+
+	/* Returns the current time in nanoseconds since the profiler started */
+	static uint64_t Now();
+
+	/* Names the calling thread in the reports and the trace */
+	static void SetThreadName(const string& name);
+
+	/* Returns the track of the given name for timings recorded on behalf of another source, creating it the first time */
+	static int GetTrack(const string& name);
+
+	/* Records a timed event on the given track, from the thread owning that track */
+	static void Record(int track, const char* name, uint64_t begin, uint64_t end, int depth);
+
+	/* Opens a scope of the calling thread, returns its nesting depth */
+	static int BeginScope();
+
+	/* Closes a scope of the calling thread and records it */
+	static void EndScope(const char* name, uint64_t begin, int depth);
+
+	/* Ends the current frame, collecting the events recorded by every thread since the previous one */
+	static void EndFrame();
+
+	/* Returns the number of frames ended so far */
+	static long long GetFramesCount();
+
+	/* Returns the time of every scope in the last ended frame, in milliseconds */
+	static void GetLastFrame(vector<pair<string, float>>& times);
+
+	/* Returns the statistics of the frame and of every scope over the last frames */
+	static void GetStats(vector<ProfileStats>& stats);
+
+	/* Prints the statistics of the frame and of every scope over the last frames */
+	static void WriteReport(ostream& out);
+
+	/* Keeps every event for the trace export, or only the recent ones for the captures (kept by default) */
+	static void SetTraceKept(bool kept);
+
+	/* Copies the events of the given number of last frames, and those recorded since the last frame ended */
+	static void CaptureRecent(int frames, ProfileCapture& capture);
+
+	/* Writes every collected event into the given file in the Chrome trace event format, returns false on failure */
+	static bool WriteTrace(const string& path);
+
+	/* Writes the given events and metadata into the given file in the Chrome trace event format, returns false on failure */
+	static bool WriteTrace(const string& path, const ProfileCapture& capture, const vector<pair<string, string>>& metadata);
+
+private:
+	/* Returns the ring of the calling thread, creating it the first time */
+	static EventRing* GetThreadRing();
+
+	/* Creates a new ring of the given name, or returns null if there are too many */
+	static EventRing* CreateRing(const string& name);
+
+	/* Returns the index of the scope of the given name, adding it the first time */
+	static int GetScope(const char* name, int depth);
+};
+
+
+/*
+	Times the scope it lives in, see PROFILE_SCOPE
+*/
+class ProfileScope
+{
+private:
+	const char* mName;
+	uint64_t mBegin;
+	int mDepth;
+
+public:
+	/* Starts timing the scope if the profiler is enabled */
+	ProfileScope(const char* name) : mBegin(0), mDepth(0) {
+		this->mName = NULL;
+
+		if (Profiler::IsEnabled()) {
+			this->mName = name;
+			this->mDepth = Profiler::BeginScope();
+			this->mBegin = Profiler::Now();
+		}
+	}
+
+	/* Records the scope */
+	~ProfileScope() {
+		if (this->mName != NULL)
+			Profiler::EndScope(this->mName, this->mBegin, this->mDepth);
+	}
+};
@@ -0,0 +1,31 @@
+#include "Random.h"
+
+/* Constructs the generator with the given seed */
+Random::Random(unsigned int seed) {
+	this->Seed(seed);
+}
+
+/* Restarts the sequence from the given seed */
+void Random::Seed(unsigned int seed) {
+	// Scramble the seed with splitmix64 so that close seeds give unrelated sequences
+	uint64_t z = (uint64_t)seed + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+
+	// The state must never be zero
+	this->mState = (z != 0) ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+/* Returns the next 32-bit random number */
+unsigned int Random::Next() {
+	this->mState ^= this->mState >> 12;
+	this->mState ^= this->mState << 25;
+	this->mState ^= this->mState >> 27;
+	return (unsigned int)((this->mState * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Returns the next random number in the range [0, n) */
+int Random::NextInt(int n) {
+	return (int)(this->Next() % (unsigned int)n);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// STL Includes
+#include <cstdint>
+
+
+/*
+	Small seeded pseudo random number generator (xorshift64*).
+	Unlike rand(), its sequence depends only on the seed,
+	so the same seed reproduces the same game on every platform
+*/
+class Random
+{
+private:
+	uint64_t mState;
+
+public:
+	/* Constructs the generator with the given seed */
+	Random(unsigned int seed = 0);
+
+	/* Restarts the sequence from the given seed */
+	void Seed(unsigned int seed);
+
+	/* Returns the next 32-bit random number */
+	unsigned int Next();
+
+	/* Returns the next random number in the range [0, n) */
+	int NextInt(int n);
+};
@@ -0,0 +1,11 @@
+#include "RenderStats.h"
+
+RenderCounters RenderStats::sCurrent = {};
+RenderCounters RenderStats::sLast = {};
+long long RenderStats::sGpuMemory[GPU_MEMORY_TYPES] = {};
+
+/* Ends the current frame and starts counting the next one */
+void RenderStats::EndFrame() {
+	sLast = sCurrent;
+	sCurrent = RenderCounters();
+}
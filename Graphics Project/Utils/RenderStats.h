@@ -0,0 +1,97 @@
+#pragma once
+
+// STL Includes
+#include <string>
+using namespace std;
+
+
+/*
+	Kinds of GPU resources whose memory is accounted for
+*/
+enum GpuMemoryType {
+	GPU_MEMORY_MESHES,				// Vertex and index buffers of the models
+	GPU_MEMORY_INSTANCES,			// Instance buffers of the chunks
+	GPU_MEMORY_TEXTURES,			// Textures of the models
+	GPU_MEMORY_HUD,					// Glyph atlas, text and overlay buffers
+	GPU_MEMORY_TARGETS,				// Offscreen render targets
+	GPU_MEMORY_TYPES
+};
+
+const string GPU_MEMORY_NAMES[GPU_MEMORY_TYPES] = { "Meshes", "Instances", "Textures", "HUD", "Targets" };
+
+
+/*
+	Rendering counters of a frame
+*/
+struct RenderCounters {
+	long long DrawCalls;
+	long long Triangles;
+	long long StateChanges;			// Programs, vertex arrays, buffers and textures bound
+	long long StreamedBytes;		// Uploaded to the GPU during the frame
+	long long VisibleItems;
+	long long CulledItems;
+	int SceneWidth;					// Resolution the scene was drawn at, before being scaled to the frame
+	int SceneHeight;
+	int SceneAntiAliasing;			// Anti-aliasing mode of the scene
+};
+
+
+/*
+	Counts what the rendering thread sends to the GPU during each frame and the GPU memory it holds.
+	Counting is a plain addition, the counters are only touched by the thread owning the GL context
+*/
+class RenderStats
+{
+private:
+	static RenderCounters sCurrent;
+	static RenderCounters sLast;
+	static long long sGpuMemory[GPU_MEMORY_TYPES];
+
+public:
+	/* Counts a draw call of the given number of triangles */
+	static void CountDraw(long long triangles) {
+		sCurrent.DrawCalls++;
+		sCurrent.Triangles += triangles;
+	}
+
+	/* Counts the given number of state changes */
+	static void CountStateChanges(int count) {
+		sCurrent.StateChanges += count;
+	}
+
+	/* Counts the given number of bytes uploaded to the GPU */
+	static void CountStreamed(long long bytes) {
+		sCurrent.StreamedBytes += bytes;
+	}
+
+	/* Counts the items drawn and the ones skipped as out of view */
+	static void CountItems(long long visible, long long culled) {
+		sCurrent.VisibleItems += visible;
+		sCurrent.CulledItems += culled;
+	}
+
+	/* Records the resolution and the anti-aliasing mode the scene is drawn at */
+	static void SetScene(int width, int height, int antiAliasing) {
+		sCurrent.SceneWidth = width;
+		sCurrent.SceneHeight = height;
+		sCurrent.SceneAntiAliasing = antiAliasing;
+	}
+
+	/* Accounts for the given number of bytes allocated on the GPU, or freed if negative */
+	static void AddGpuMemory(GpuMemoryType type, long long bytes) {
+		sGpuMemory[type] += bytes;
+	}
+
+	/* Returns the GPU memory held by the given kind of resources, in bytes */
+	static long long GetGpuMemory(GpuMemoryType type) {
+		return sGpuMemory[type];
+	}
+
+	/* Returns the counters of the last ended frame */
+	static const RenderCounters& GetLastFrame() {
+		return sLast;
+	}
+
+	/* Ends the current frame and starts counting the next one */
+	static void EndFrame();
+};
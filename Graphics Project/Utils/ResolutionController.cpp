@@ -0,0 +1,46 @@
+#include "ResolutionController.h"
+
+/* Constructs a controller holding the given budget, in seconds, starting at the largest scale */
+ResolutionController::ResolutionController(double budget, double minScale, double maxScale) {
+	this->mBudget = budget;
+	this->mMinScale = minScale;
+	this->mMaxScale = maxScale;
+	this->mScale = maxScale;
+	this->mAverage = 0;
+}
+
+/* Adds the measured cost of a frame, in seconds, drawn at the given scale, and returns the scale to draw the next frames at */
+double ResolutionController::Update(double time, double scale) {
+	if (time <= 0 || scale <= 0)
+		return this->mScale;
+
+	double cost = min(time, RESOLUTION_MAX_COST * this->mBudget) / (scale * scale);
+	this->mAverage = (this->mAverage > 0) ? this->mAverage + RESOLUTION_SMOOTHING * (cost - this->mAverage) : cost;
+
+	// Scale bringing the average cost to the target
+	double target = sqrt(RESOLUTION_TARGET * this->mBudget / this->mAverage);
+
+	if (fabs(target - this->mScale) < RESOLUTION_DEADBAND * this->mScale)
+		return this->mScale;
+
+	target = max(target, this->mScale * (1.0 - RESOLUTION_MAX_DOWN));
+	target = min(target, this->mScale * (1.0 + RESOLUTION_MAX_UP));
+	this->mScale = max(this->mMinScale, min(target, this->mMaxScale));
+
+	return this->mScale;
+}
+
+/* Returns the current scale */
+double ResolutionController::GetScale() const {
+	return this->mScale;
+}
+
+/* Returns the budget, in seconds */
+double ResolutionController::GetBudget() const {
+	return this->mBudget;
+}
+
+/* Returns the average cost of the frames at full scale, in seconds */
+double ResolutionController::GetAverage() const {
+	return this->mAverage;
+}
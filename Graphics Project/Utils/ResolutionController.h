@@ -0,0 +1,48 @@
+#pragma once
+
+// STL Includes
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+// Dynamic resolution constants
+const double RESOLUTION_MIN_SCALE = 0.5;		// Smallest scale of the scene's width and height
+const double RESOLUTION_TARGET = 0.9;			// Fraction of the budget aimed at, leaving room for the frames costing more than the average
+const double RESOLUTION_DEADBAND = 0.05;		// Relative changes of the scale below this one are not made, so the scale settles
+const double RESOLUTION_MAX_DOWN = 0.10;		// Largest relative decrease of the scale per frame
+const double RESOLUTION_MAX_UP = 0.02;			// Largest relative increase of the scale per frame, slower so a recovered budget is not overshot
+const double RESOLUTION_SMOOTHING = 0.1;		// Weight of a new frame in the average cost
+const double RESOLUTION_MAX_COST = 4.0;			// Multiple of the budget a frame's cost is capped at, so a single hitch does not collapse the scale
+
+
+/*
+	Picks the scale of the scene's resolution each frame so that drawing it takes the given time budget.
+	The cost of the scene goes with its pixels, so each measured frame gives a cost per unit of squared scale.
+	Its average gives the scale holding the budget directly, rather than by stepping towards it,
+	which would overshoot since the costs are measured a few frames after the scale they were drawn at
+*/
+class ResolutionController
+{
+private:
+	double mBudget;
+	double mMinScale;
+	double mMaxScale;
+	double mScale;
+	double mAverage;		// Average cost of the frames at full scale, 0 before the first one
+
+public:
+	/* Constructs a controller holding the given budget, in seconds, starting at the largest scale */
+	ResolutionController(double budget, double minScale = RESOLUTION_MIN_SCALE, double maxScale = 1.0);
+
+	/* Adds the measured cost of a frame, in seconds, drawn at the given scale, and returns the scale to draw the next frames at */
+	double Update(double time, double scale);
+
+	/* Returns the current scale */
+	double GetScale() const;
+
+	/* Returns the budget, in seconds */
+	double GetBudget() const;
+
+	/* Returns the average cost of the frames at full scale, in seconds */
+	double GetAverage() const;
+};
@@ -0,0 +1,187 @@
+#include "ThreadPool.h"
+
+/* Packs a range into a single word */
+static uint64_t PackRange(int begin, int end) {
+	return ((uint64_t)(uint32_t)begin << 32) | (uint32_t)end;
+}
+
+/* Unpacks a range from a single word */
+static void UnpackRange(uint64_t range, int& begin, int& end) {
+	begin = (int)(range >> 32);
+	end = (int)(range & 0xFFFFFFFFULL);
+}
+
+/* Constructs the pool with the given number of threads including the calling one, 0 uses all of the cores */
+ThreadPool::ThreadPool(int threadsCount) : mRanges(threadsCount > 0 ? threadsCount : max(1u, thread::hardware_concurrency())) {
+	this->mThreadsCount = (int)this->mRanges.size();
+	this->mTask = NULL;
+	this->mGeneration = 0;
+	this->mGrain = 1;
+	this->mPending = 0;
+	this->mActive = 0;
+	this->mStopping = false;
+
+	for (int i = 0; i < this->mThreadsCount; ++i) {
+		this->mRanges[i].Range = PackRange(0, 0);
+	}
+
+	// The calling thread is the first worker
+	for (int i = 1; i < this->mThreadsCount; ++i) {
+		this->mThreads.push_back(thread(&ThreadPool::WorkerLoop, this, i));
+	}
+}
+
+/* Stops and joins the worker threads */
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> lock(this->mMutex);
+		this->mStopping = true;
+	}
+
+	this->mWake.notify_all();
+
+	for (size_t i = 0; i < this->mThreads.size(); ++i) {
+		this->mThreads[i].join();
+	}
+}
+
+/* Returns the number of threads including the calling one */
+int ThreadPool::GetThreadsCount() const {
+	return this->mThreadsCount;
+}
+
+/* Calls task(begin, end) over the disjoint sub-ranges of [0, count) in parallel, and returns when all of them are done */
+void ThreadPool::ParallelFor(int count, const function<void(int, int)>& task, int grain) {
+	if (count <= 0)
+		return;
+
+	if (grain <= 0)
+		grain = max(1, count / (this->mThreadsCount * 8));
+
+	// Not worth waking the other threads
+	if (this->mThreadsCount == 1 || count <= grain) {
+		task(0, count);
+		return;
+	}
+
+	// Give each thread its own contiguous range
+	for (int i = 0; i < this->mThreadsCount; ++i) {
+		int begin = (int)((long long)count * i / this->mThreadsCount);
+		int end = (int)((long long)count * (i + 1) / this->mThreadsCount);
+		this->mRanges[i].Range = PackRange(begin, end);
+	}
+
+	this->mPending = count;
+
+	{
+		lock_guard<mutex> lock(this->mMutex);
+		this->mTask = &task;
+		this->mGrain = grain;
+		this->mGeneration++;
+	}
+
+	this->mWake.notify_all();
+
+	this->RunRanges(0, task);
+
+	// Wait for the sub-ranges taken by the other threads
+	while (this->mPending.load() > 0) {
+		this_thread::yield();
+	}
+
+	// Make sure no thread still holds the task before it goes out of scope
+	{
+		lock_guard<mutex> lock(this->mMutex);
+		this->mTask = NULL;
+	}
+
+	while (this->mActive.load() > 0) {
+		this_thread::yield();
+	}
+}
+
+/* Waits for loops and works on them until the pool is stopped */
+void ThreadPool::WorkerLoop(int idx) {
+	unsigned long long generation = 0;
+
+	while (true) {
+		const function<void(int, int)>* task;
+
+		{
+			unique_lock<mutex> lock(this->mMutex);
+			this->mWake.wait(lock, [&] { return this->mStopping || (this->mTask != NULL && this->mGeneration != generation); });
+
+			if (this->mStopping)
+				return;
+
+			generation = this->mGeneration;
+			task = this->mTask;
+			this->mActive++;
+		}
+
+		this->RunRanges(idx, *task);
+
+		this->mActive--;
+	}
+}
+
+/* Runs the sub-ranges of the current loop from the given thread's range then from the others' ranges */
+void ThreadPool::RunRanges(int idx, const function<void(int, int)>& task) {
+	int begin, end;
+
+	while (true) {
+		if (this->PopRange(idx, begin, end)) {
+			task(begin, end);
+			this->mPending -= end - begin;
+		}
+		else if (!this->StealRange(idx)) {
+			return;
+		}
+	}
+}
+
+/* Takes the next sub-range from the front of the given thread's range, returns false if it is empty */
+bool ThreadPool::PopRange(int idx, int& begin, int& end) {
+	atomic<uint64_t>& range = this->mRanges[idx].Range;
+	uint64_t current = range.load();
+
+	while (true) {
+		int rangeBegin, rangeEnd;
+		UnpackRange(current, rangeBegin, rangeEnd);
+
+		if (rangeBegin >= rangeEnd)
+			return false;
+
+		begin = rangeBegin;
+		end = min(rangeBegin + this->mGrain, rangeEnd);
+
+		if (range.compare_exchange_weak(current, PackRange(end, rangeEnd)))
+			return true;
+	}
+}
+
+/* Moves the upper half of another thread's range into the given thread's range, returns false if all are empty */
+bool ThreadPool::StealRange(int idx) {
+	for (int i = 1; i < this->mThreadsCount; ++i) {
+		atomic<uint64_t>& victim = this->mRanges[(idx + i) % this->mThreadsCount].Range;
+		uint64_t current = victim.load();
+
+		while (true) {
+			int begin, end;
+			UnpackRange(current, begin, end);
+
+			if (begin >= end)
+				break;
+
+			int mid = begin + (end - begin) / 2;
+
+			if (victim.compare_exchange_weak(current, PackRange(begin, mid))) {
+				// Our own range is empty so no other thread is updating it
+				this->mRanges[idx].Range = PackRange(mid, end);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// STL Includes
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <algorithm>
+using namespace std;
+
+
+/*
+	Fixed pool of worker threads running parallel loops.
+	Each loop splits its index range into one contiguous range per thread,
+	a thread that finishes its own range steals the upper half of another thread's range,
+	so neighbouring indices stay on the same thread while the load is still balanced
+*/
+class ThreadPool
+{
+private:
+	/*
+		Remaining range of a thread, packed as (begin << 32 | end) so it can be updated with a single CAS.
+		Padded to a cache line so threads popping their own ranges don't share lines
+	*/
+	struct WorkerRange {
+		atomic<uint64_t> Range;
+		char Padding[64 - sizeof(atomic<uint64_t>)];
+	};
+
+	// Threads
+	vector<thread> mThreads;
+	vector<WorkerRange> mRanges;
+	int mThreadsCount;
+
+	// Current loop
+	mutex mMutex;
+	condition_variable mWake;
+	const function<void(int, int)>* mTask;
+	unsigned long long mGeneration;
+	int mGrain;
+	atomic<int> mPending;
+	atomic<int> mActive;
+	bool mStopping;
+
+public:
+	/* Constructs the pool with the given number of threads including the calling one, 0 uses all of the cores */
+	ThreadPool(int threadsCount = 0);
+
+	/* Stops and joins the worker threads */
+	~ThreadPool();
+
+	/* Returns the number of threads including the calling one */
+	int GetThreadsCount() const;
+
+	/*
+		Calls task(begin, end) over the disjoint sub-ranges of [0, count) in parallel, and returns when all of them are done.
+		The calling thread works on the first range, grain is the size of the sub-ranges taken at once (0 picks one)
+	*/
+	void ParallelFor(int count, const function<void(int, int)>& task, int grain = 0);
+
+private:
+	/* Waits for loops and works on them until the pool is stopped */
+	void WorkerLoop(int idx);
+
+	/* Runs the sub-ranges of the current loop from the given thread's range then from the others' ranges */
+	void RunRanges(int idx, const function<void(int, int)>& task);
+
+	/* Takes the next sub-range from the front of the given thread's range, returns false if it is empty */
+	bool PopRange(int idx, int& begin, int& end);
+
+	/* Moves the upper half of another thread's range into the given thread's range, returns false if all are empty */
+	bool StealRange(int idx);
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// STL Includes
+#include <atomic>
+using namespace std;
+
+
+/*
+	Lock-free single producer/single consumer triple buffer.
+	The producer always owns a back buffer to write into, the consumer always owns
+	a front buffer to read from, and the middle buffer is swapped atomically between them,
+	so neither side ever waits for the other
+*/
+template<typename T>
+class TripleBuffer
+{
+private:
+	// Flag set on the middle index when it holds data the consumer has not seen yet
+	static const int DIRTY_BIT = 4;
+	static const int INDEX_MASK = 3;
+
+	T mBuffers[3];
+	atomic<int> mMiddle;	// Middle buffer index (shared), ORed with the dirty bit
+	int mBack;				// Back buffer index (producer only)
+	int mFront;				// Front buffer index (consumer only)
+
+public:
+	/* Constructs the triple buffer */
+	TripleBuffer() : mMiddle(1), mBack(0), mFront(2) {
+
+	}
+
+	/* Returns the buffer the producer should fill next */
+	T& GetWriteBuffer() {
+		return this->mBuffers[this->mBack];
+	}
+
+	/* Publishes the filled write buffer to the consumer */
+	void Publish() {
+		this->mBack = this->mMiddle.exchange(this->mBack | DIRTY_BIT, memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	/* Returns whether a newer buffer has been published since the last read */
+	bool HasNewData() const {
+		return (this->mMiddle.load(memory_order_relaxed) & DIRTY_BIT) != 0;
+	}
+
+	/* Returns the most recently published buffer */
+	const T& Read() {
+		if (this->HasNewData()) {
+			this->mFront = this->mMiddle.exchange(this->mFront, memory_order_acq_rel) & INDEX_MASK;
+		}
+
+		return this->mBuffers[this->mFront];
+	}
+};